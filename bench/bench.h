@@ -0,0 +1,88 @@
+/**
+ * @file    bench.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Utilidades comuns aos benchmarks: relógio, gerador de números
+ *          pseudo-aleatórios e repetição de medições.
+ * @details Os benchmarks são executáveis à parte (ver build/CMakeLists.txt),
+ *          compilados sempre com otimizações, exceto quando o objetivo é
+ *          medir a build de Debug. Cada um gera os seus dados com uma semente
+ *          fixa, por isso os resultados são reproduzíveis.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @def BENCH_REPETICOES
+ *          Número de vezes que cada medição é repetida, é mostrada a melhor.
+ */
+#ifndef BENCH_REPETICOES
+#    define BENCH_REPETICOES 5
+#endif
+
+/**
+ * @brief   Tempo atual de um relógio monótono.
+ * @returns O tempo em segundos.
+ */
+static inline double bench_agora() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief   Gerador xorshift64*, determinístico para uma dada semente.
+ * @param s Estado do gerador, diferente de 0.
+ * @returns O próximo número.
+ */
+static inline uint64_t bench_aleatorio(uint64_t* const s) {
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * @brief   Número pseudo-aleatório em [0, n).
+ * @param s Estado do gerador.
+ * @param n Limite, maior que 0.
+ * @returns O número.
+ */
+static inline uint64_t bench_ate(uint64_t* const s, const uint64_t n) { return bench_aleatorio(s) % n; }
+
+/**
+ * @brief   Impede o compilador de descartar um resultado que não é usado.
+ * @param v Resultado.
+ */
+static inline void bench_usar(const uint64_t v) {
+    static volatile uint64_t sumidouro;
+    sumidouro += v;
+}
+
+/**
+ * @def BENCH_MEDIR(MELHOR, CORPO)
+ *          Executa CORPO BENCH_REPETICOES vezes e guarda em MELHOR (double)
+ *          o menor tempo, em segundos.
+ */
+#define BENCH_MEDIR(MELHOR, CORPO)                                                                                     \
+    do {                                                                                                               \
+        (MELHOR) = 1e30;                                                                                               \
+        for (int bench_r = 0; bench_r < BENCH_REPETICOES; bench_r++) {                                                 \
+            const double bench_t0 = bench_agora();                                                                     \
+            CORPO;                                                                                                     \
+            const double bench_t = bench_agora() - bench_t0;                                                           \
+            if (bench_t < (MELHOR)) (MELHOR) = bench_t;                                                                \
+        }                                                                                                              \
+    } while (0)
+
+#endif
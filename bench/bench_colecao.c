@@ -0,0 +1,105 @@
+/**
+ * @file    bench_colecao.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Benchmark de COL_PARA_CADA contra _iterateFW: soma um campo de
+ *          todos os objetos de uma artigocol (COL_SLOTS, com slots livres) e
+ *          de uma encomendacol (COL_SEGMENTOS).
+ * @details Uso: bench_colecao.x86 [objetos] [passagens] (20000 e 2000 por
+ *          omissão). É compilado duas vezes: bench_colecao.x86 com -O2, onde
+ *          COL_PARA_CADA é mais rápido, e bench_colecao_O0.x86 com -O0, como a
+ *          build de Debug, onde é mais lento por as funções auxiliares da
+ *          coleção não serem inlined.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#include "bench.h"
+
+#include "artigo.h"
+#include "encomenda.h"
+
+/**
+ * @def BENCH_LIVRES
+ *          Um em cada BENCH_LIVRES artigos é removido, deixando o slot livre.
+ */
+#define BENCH_LIVRES 10
+
+/**
+ * @brief   Pode ser utilizado como um iterador, soma o stock de um artigo.
+ * @param a Artigo.
+ * @param s Soma, do tipo 'int64_t*'.
+ * @returns 0
+ */
+static int bench_pred_somarStock(artigo* const a, int64_t* const s) {
+    *s += a->stock;
+    return 0;
+}
+
+/**
+ * @brief   Pode ser utilizado como um iterador, soma a data de uma encomenda.
+ * @param e Encomenda.
+ * @param s Soma, do tipo 'int64_t*'.
+ * @returns 0
+ */
+static int bench_pred_somarTempo(encomenda* const e, int64_t* const s) {
+    *s += (int64_t) e->tempo;
+    return 0;
+}
+
+/**
+ * @brief   Mostra os tempos de uma coleção e verifica se as duas somas são
+ *          iguais.
+ * @param nome  Nome da coleção.
+ * @param tFW   Tempo de _iterateFW.
+ * @param tPC   Tempo de COL_PARA_CADA.
+ * @param sFW   Soma obtida com _iterateFW.
+ * @param sPC   Soma obtida com COL_PARA_CADA.
+ * @returns     0 se as somas são diferentes.
+ * @returns     1 caso contrário.
+ */
+static int bench_mostrar(const char* const nome, const double tFW, const double tPC, const int64_t sFW,
+                         const int64_t sPC) {
+    printf("%-14s iterateFW %8.1f ms   COL_PARA_CADA %8.1f ms   %5.2fx\n", nome, tFW * 1e3, tPC * 1e3, tFW / tPC);
+    if (sFW != sPC) fprintf(stderr, "%s: somas diferentes (%" PRId64 " e %" PRId64 ")\n", nome, sFW, sPC);
+    return sFW == sPC;
+}
+
+int main(int argc, char** argv) {
+    const colSize_t n        = (argc > 1) ? (colSize_t) strtoul(argv[1], NULL, 10) : 20000;
+    const int       passagens = (argc > 2) ? atoi(argv[2]) : 2000;
+    uint64_t        s        = 0x9E3779B97F4A7C15ull;
+
+    artigocol    artigos    = artigocol_new();
+    encomendacol encomendas = encomendacol_new();
+    for (colSize_t i = 0; i < n; i++) {
+        artigo a = newArtigo();
+        a.stock  = (int64_t) bench_ate(&s, 1000);
+        if (artigocol_inserir(&artigos, a) == COL_INVAL_INDEX) return 1;
+        encomenda e = newEncomenda();
+        e.tempo     = (time_t) (1577836800 + bench_ate(&s, 1u << 28));
+        if (!encomendacol_push(&encomendas, e)) return 1;
+    }
+    for (colSize_t i = 0; i < n; i += BENCH_LIVRES) artigocol_remover(&artigos, i);
+    printf("%" PRIu32 " objetos (1 em cada %d artigos removido), %d passagens\n", n, BENCH_LIVRES, passagens);
+
+    int     ok = 1;
+    int64_t sFW, sPC;
+    double  tFW, tPC;
+    BENCH_MEDIR(tFW, sFW = 0; for (int p = 0; p < passagens; p++) artigocol_iterateFW(
+                              &artigos, (artigocol_pred_t) &bench_pred_somarStock, &sFW));
+    BENCH_MEDIR(tPC, sPC = 0; for (int p = 0; p < passagens; p++) COL_PARA_CADA(artigocol, &artigos, a) sPC += a->stock);
+    ok = bench_mostrar("artigocol", tFW, tPC, sFW, sPC) && ok;
+
+    BENCH_MEDIR(tFW, sFW = 0; for (int p = 0; p < passagens; p++) encomendacol_iterateFW(
+                              &encomendas, (encomendacol_pred_t) &bench_pred_somarTempo, &sFW));
+    BENCH_MEDIR(tPC, sPC = 0; for (int p = 0; p < passagens; p++)
+                              COL_PARA_CADA(encomendacol, &encomendas, e) sPC += (int64_t) e->tempo);
+    ok = bench_mostrar("encomendacol", tFW, tPC, sFW, sPC) && ok;
+
+    bench_usar((uint64_t) (sFW + sPC));
+    artigocol_free(&artigos);
+    encomendacol_free(&encomendas);
+    return !ok;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file    bench_colecoes.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Implementação das coleções do programa para os benchmarks que usam
+ *          os módulos de src/, no lugar de main.c.
+ * @details Tal como no programa, as funções das coleções ficam numa unidade
+ *          de tradução diferente da dos ciclos que as usam.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#define COL_IMPLEMENTACAO
+#include "artigo.h"
+#include "encomenda.h"
+#include "utilizador.h"
+
+#ifndef utilizadorcol_H
+#    define utilizadorcol_H
+#    define COL_TIPO utilizador
+#    define COL_NOME utilizadorcol
+#    define COL_SLOTS
+#    define COL_DEALOC(X) freeUtilizador(X)
+#    define COL_WRITE(X, F) save_utilizador(F, X)
+#    define COL_READ(X, F) load_utilizador(F, X)
+#    include "colecao.h"
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file    bench_compressao.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Benchmark do compressor de blocos (compressao.h): taxa de
+ *          compressão e velocidade de compressão e descompressão das secções
+ *          de encomendas e de compras de um ficheiro de dados gerado.
+ * @details Uso: bench_compressao.x86 [encomendas] (300000 por omissão). Os
+ *          dados imitam um histórico real: 5000 clientes, 200 artigos, 1 a 8
+ *          compras por encomenda, encomendas por ordem de data e receitas
+ *          quase sempre vazias.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#include "bench.h"
+
+#include <string.h>
+
+#include "compressao.h"
+#include "persistencia.h"
+
+/**
+ * @def BENCH_CLIENTES
+ *          Número de clientes do conjunto de dados.
+ * @def BENCH_ARTIGOS
+ *          Número de artigos do conjunto de dados.
+ */
+#define BENCH_CLIENTES 5000
+#define BENCH_ARTIGOS 200
+
+/**
+ * @brief   Uma secção gerada e os seus blocos comprimidos.
+ */
+typedef struct {
+    const char* nome;        ///< Nome da secção
+    uint8_t*    dados;       ///< Bytes da secção
+    size_t      tam;         ///< Tamanho de 'dados'
+    uint8_t*    comprimidos; ///< Blocos comprimidos
+    size_t      tamComp;     ///< Bytes usados em 'comprimidos'
+    uint8_t*    copia;       ///< Onde descomprimir
+} bench_seccao;
+
+/**
+ * @brief   Comprime uma secção em blocos de COMPRESSAO_BLOCO, como
+ *          persistencia_gravar.
+ * @param s Secção.
+ */
+static void bench_comprimir(bench_seccao* const s) {
+    s->tamComp = 0;
+    for (size_t i = 0; i < s->tam; i += COMPRESSAO_BLOCO) {
+        const size_t n = (s->tam - i < COMPRESSAO_BLOCO) ? s->tam - i : COMPRESSAO_BLOCO;
+        s->tamComp += compressao_comprimirBloco(s->dados + i, n, s->comprimidos + s->tamComp);
+    }
+}
+
+/**
+ * @brief   Gera as secções de encomendas e de compras.
+ * @param e Secção das encomendas.
+ * @param c Secção das compras.
+ * @param n Número de encomendas.
+ */
+static void bench_gerar(bench_seccao* const e, bench_seccao* const c, const size_t n) {
+    uint64_t                      s   = 0x9E3779B97F4A7C15ull;
+    persistencia_encomenda* const enc = malloc(sizeof(persistencia_encomenda) * n);
+    compra* const                 com = malloc(sizeof(compra) * n * 8);
+    int64_t                       precos[BENCH_ARTIGOS];
+    uint8_t                       iva[BENCH_ARTIGOS];
+    if (!enc || !com) exit(1);
+    for (int i = 0; i < BENCH_ARTIGOS; i++) {
+        precos[i] = 50 + (int64_t) bench_ate(&s, 5000);
+        iva[i]    = (uint8_t) bench_ate(&s, 3);
+    }
+    memset(com, 0, sizeof(compra) * n * 8);
+    size_t  m     = 0;
+    int64_t tempo = 1577836800; // 2020-01-01
+    for (size_t i = 0; i < n; i++) {
+        const colSize_t k = 1 + (colSize_t) bench_ate(&s, 8);
+        tempo += (int64_t) bench_ate(&s, 120);
+        enc[i] = (persistencia_encomenda) {.tempo           = tempo,
+                                           .ID_cliente      = (colSize_t) bench_ate(&s, BENCH_CLIENTES),
+                                           .n_compras       = k,
+                                           .primeira_compra = m};
+        for (colSize_t j = 0; j < k; j++, m++) {
+            const colSize_t a = (colSize_t) bench_ate(&s, BENCH_ARTIGOS);
+            com[m].IDartigo   = a;
+            com[m].qtd        = 1 + (int64_t) bench_ate(&s, 4);
+            com[m].preco_cent = precos[a];
+            com[m].iva        = iva[a];
+            if (bench_ate(&s, 10) == 0) memcpy(com[m].receita, "1234567890123456789", sizeof(com[m].receita));
+        }
+    }
+    *e = (bench_seccao) {.nome = "encomendas", .dados = (uint8_t*) enc, .tam = sizeof(persistencia_encomenda) * n};
+    *c = (bench_seccao) {.nome = "compras", .dados = (uint8_t*) com, .tam = sizeof(compra) * m};
+}
+
+int main(int argc, char** argv) {
+    const size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : 300000;
+    bench_seccao seccoes[2];
+    bench_gerar(&seccoes[0], &seccoes[1], n ? n : 1);
+
+    size_t tamTotal = 0, compTotal = 0;
+    double compTempo = 0, descTempo = 0;
+    printf("%zu encomendas, %d clientes, %d artigos\n", n, BENCH_CLIENTES, BENCH_ARTIGOS);
+    for (int i = 0; i < 2; i++) {
+        bench_seccao* const s = &seccoes[i];
+        const size_t        b = (s->tam + COMPRESSAO_BLOCO - 1) / COMPRESSAO_BLOCO;
+        s->comprimidos        = malloc(b * (sizeof(compressao_bloco) + COMPRESSAO_LIMITE(COMPRESSAO_BLOCO)) + 1);
+        s->copia              = malloc(s->tam + 1);
+        if (!s->comprimidos || !s->copia) return 1;
+
+        double tc, td;
+        BENCH_MEDIR(tc, bench_comprimir(s));
+        BENCH_MEDIR(td, if (!compressao_descomprimirBlocos(s->comprimidos, s->tamComp, s->copia, s->tam)) return 1);
+        if (memcmp(s->dados, s->copia, s->tam)) {
+            fprintf(stderr, "secção %s descomprimida não é igual à original\n", s->nome);
+            return 1;
+        }
+        const double mb = (double) s->tam / (1024.0 * 1024.0);
+        printf("%-10s %8.2f MB -> %8.2f MB  taxa %5.2fx  comprimir %7.1f MB/s  descomprimir %7.1f MB/s\n", s->nome,
+               mb, (double) s->tamComp / (1024.0 * 1024.0), (double) s->tam / (double) s->tamComp, mb / tc, mb / td);
+        tamTotal += s->tam;
+        compTotal += s->tamComp;
+        compTempo += tc;
+        descTempo += td;
+        free(s->dados);
+        free(s->comprimidos);
+        free(s->copia);
+    }
+    const double mb = (double) tamTotal / (1024.0 * 1024.0);
+    printf("%-10s %8.2f MB -> %8.2f MB  taxa %5.2fx  comprimir %7.1f MB/s  descomprimir %7.1f MB/s\n", "total", mb,
+           (double) compTotal / (1024.0 * 1024.0), (double) tamTotal / (double) compTotal, mb / compTempo,
+           mb / descTempo);
+    return 0;
+}
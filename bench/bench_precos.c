@@ -0,0 +1,127 @@
+/**
+ * @file    bench_precos.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Benchmark do preço das encomendas: encomenda_CalcPreco chamado
+ *          por cada encomenda contra encomenda_CalcPrecoBatch.
+ * @details Uso: bench_precos.x86 [encomendas] [compras] [sem preço] (200000
+ *          encomendas, 12 compras por encomenda e 50% das compras sem o preço
+ *          registado por omissão). Os artigos incluem slots livres e slots
+ *          reutilizados, e algumas compras são de artigos removidos, por isso
+ *          contam 0. O resultado das duas funções tem que ser igual em todas
+ *          as encomendas.
+ *
+ *          bench_precos_avx2.x86 é o mesmo benchmark compilado com -mavx2 e
+ *          ENCOMENDA_AVX2, para medir as compras somadas de 4 em 4 com AVX2.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#include "bench.h"
+
+#include "artigo.h"
+#include "encomenda.h"
+
+/**
+ * @def BENCH_ARTIGOS
+ *          Número de artigos.
+ * @def BENCH_LIVRES
+ *          Um em cada BENCH_LIVRES artigos é removido, e metade desses slots
+ *          são reutilizados por artigos novos.
+ */
+#define BENCH_ARTIGOS 2000
+#define BENCH_LIVRES 10
+
+/**
+ * @brief   Gera os artigos.
+ * @param av      Artigos.
+ * @param handles Onde guardar BENCH_ARTIGOS handles para as compras: os dos
+ *                artigos que existem e os dos que foram removidos.
+ * @param s       Estado do gerador.
+ */
+static void bench_gerarArtigos(artigocol* const av, colSize_t* const handles, uint64_t* const s) {
+    for (int i = 0; i < BENCH_ARTIGOS; i++) {
+        artigo a     = newArtigo();
+        a.preco_cent = 50 + (int64_t) bench_ate(s, 5000);
+        a.meta       = (uint8_t) bench_ate(s, 3);
+        handles[i]   = artigocol_inserir(av, a);
+        if (handles[i] == COL_INVAL_INDEX) exit(1);
+    }
+    for (int i = 0; i < BENCH_ARTIGOS; i += BENCH_LIVRES) artigocol_remover(av, handles[i]);
+    for (int i = 0; i < BENCH_ARTIGOS; i += 2 * BENCH_LIVRES) {
+        artigo a     = newArtigo();
+        a.preco_cent = 50 + (int64_t) bench_ate(s, 5000);
+        if (artigocol_inserir(av, a) == COL_INVAL_INDEX) exit(1);
+    }
+}
+
+/**
+ * @brief          Gera as encomendas.
+ * @param ev       Encomendas.
+ * @param av       Artigos.
+ * @param handles  Handles dos artigos das compras (ver bench_gerarArtigos).
+ * @param n        Número de encomendas.
+ * @param compras  Número médio de compras por encomenda.
+ * @param semPreco Percentagem das compras sem o preço registado.
+ * @param s        Estado do gerador.
+ */
+static void bench_gerarEncomendas(encomendacol* const ev, const artigocol* const av, const colSize_t* const handles,
+                                  const colSize_t n, const colSize_t compras, const uint64_t semPreco,
+                                  uint64_t* const s) {
+    for (colSize_t i = 0; i < n; i++) {
+        encomenda       e = newEncomenda();
+        const colSize_t k = 1 + (colSize_t) bench_ate(s, 2 * compras - 1);
+        for (colSize_t j = 0; j < k; j++) {
+            compra c   = new_compra();
+            c.IDartigo = handles[bench_ate(s, BENCH_ARTIGOS)];
+            c.qtd      = 1 + (int64_t) bench_ate(s, 4);
+            const artigo* const a = artigocol_obter(av, c.IDartigo);
+            if (a && bench_ate(s, 100) >= semPreco) compra_registarPreco(&c, a);
+            if (!compracol_push(&e.compras, c)) exit(1);
+        }
+        if (!encomendacol_push(ev, e)) exit(1);
+    }
+}
+
+int main(int argc, char** argv) {
+    const colSize_t n        = (argc > 1) ? (colSize_t) strtoul(argv[1], NULL, 10) : 200000;
+    const colSize_t compras  = (argc > 2) ? (colSize_t) strtoul(argv[2], NULL, 10) : 12;
+    const uint64_t  semPreco = (argc > 3) ? strtoull(argv[3], NULL, 10) : 50;
+    uint64_t        s        = 0x9E3779B97F4A7C15ull;
+    colSize_t       handles[BENCH_ARTIGOS];
+
+    artigocol    artigos    = artigocol_new();
+    encomendacol encomendas = encomendacol_new();
+    bench_gerarArtigos(&artigos, handles, &s);
+    bench_gerarEncomendas(&encomendas, &artigos, handles, n ? n : 1, compras ? compras : 1, semPreco, &s);
+
+    uint64_t* const porEncomenda = malloc(sizeof(uint64_t) * encomendas.size);
+    uint64_t* const batch        = malloc(sizeof(uint64_t) * encomendas.size);
+    if (!porEncomenda || !batch) return 1;
+
+    double tE, tB;
+    BENCH_MEDIR(tE, COL_PARA_CADA(encomendacol, &encomendas, e) porEncomenda[e_i] = encomenda_CalcPreco(e, &artigos));
+    BENCH_MEDIR(tB, encomenda_CalcPrecoBatch(&encomendas, &artigos, batch));
+
+    uint64_t total = 0;
+    for (colSize_t i = 0; i < encomendas.size; i++) {
+        if (porEncomenda[i] != batch[i]) {
+            fprintf(stderr, "encomenda %" PRIu32 ": %" PRIu64 " por encomenda, %" PRIu64 " em batch\n", i,
+                    porEncomenda[i], batch[i]);
+            return 1;
+        }
+        total += batch[i];
+    }
+    printf("%" PRIu32 " encomendas, ~%" PRIu32 " compras por encomenda, %" PRIu64 "%% sem preço, %d artigos\n",
+           encomendas.size, compras, semPreco, BENCH_ARTIGOS);
+    printf("encomenda_CalcPreco      %8.1f ms\n", tE * 1e3);
+    printf("encomenda_CalcPrecoBatch %8.1f ms   %5.2fx\n", tB * 1e3, tE / tB);
+    bench_usar(total);
+
+    free(porEncomenda);
+    free(batch);
+    encomendacol_free(&encomendas);
+    artigocol_free(&artigos);
+    return 0;
+}
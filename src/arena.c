@@ -0,0 +1,102 @@
+/**
+ * @file    arena.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Alocador por arena: os objetos são alocados sequencialmente em
+ *          pedaços grandes e só são libertados todos de uma vez.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief   Pedaço de memória de uma arena.
+ */
+struct arena_pedaco {
+    arena_pedaco* anterior; ///< Pedaço alocado antes deste
+    size_t        tam;      ///< Bytes em 'dados'
+    size_t        usado;    ///< Bytes de 'dados' já alocados
+    max_align_t   dados[];  ///< Objetos alocados
+};
+
+/**
+ * @brief   Constroi uma arena vazia (não aloca memória).
+ * @returns Uma arena vazia.
+ */
+arena arena_new() { return (arena) {.pedacos = NULL, .total = 0}; }
+
+/**
+ * @brief     Aloca 'tam' bytes na arena, alinhados para qualquer tipo.
+ * @param a   Arena onde alocar.
+ * @param tam Número de bytes.
+ * @returns   Ponteiro para os bytes alocados.
+ * @returns   NULL se não conseguiu alocar memória.
+ */
+void* arena_alocar(arena* const a, const size_t tam) {
+    // Pelo menos um byte, para que o ponteiro retornado esteja sempre dentro do pedaço
+    const size_t  alinhado = (tam + sizeof(max_align_t) - !!tam) / sizeof(max_align_t) * sizeof(max_align_t);
+    arena_pedaco* p        = a->pedacos;
+    if (!p || alinhado > p->tam - p->usado) {
+        // Novo pedaço, pelo menos do tamanho dos anteriores
+        size_t n = (a->total < ARENA_PEDACO_MIN) ? ARENA_PEDACO_MIN : a->total;
+        if (n > ARENA_PEDACO_MAX) n = ARENA_PEDACO_MAX;
+        if (n < alinhado) n = alinhado;
+        p = malloc(sizeof(arena_pedaco) + n);
+        if (!p) return NULL;
+        p->anterior = a->pedacos;
+        p->tam      = n;
+        p->usado    = 0;
+        a->pedacos  = p;
+        a->total += n;
+    }
+    void* const r = (char*) p->dados + p->usado;
+    p->usado += alinhado;
+    return r;
+}
+
+/**
+ * @brief   Duplica uma string na arena.
+ * @param a Arena onde alocar.
+ * @param s String a duplicar.
+ * @returns Uma cópia da string ou NULL se 's' for NULL ou não conseguiu
+ *          alocar memória.
+ */
+char* arena_strdup(arena* const a, const char* const s) {
+    if (!s) return NULL;
+    const size_t len = strlen(s) + 1;
+    char* const  new = arena_alocar(a, len);
+    if (new) memcpy(new, s, len);
+    return new;
+}
+
+/**
+ * @brief   Verifica se 'p' foi alocado na arena.
+ * @param a Arena.
+ * @param p Ponteiro a verificar.
+ * @returns 1 se 'p' aponta para um pedaço da arena.
+ * @returns 0 caso contrário.
+ */
+int arena_contem(const arena* const a, const void* const p) {
+    for (const arena_pedaco* k = a->pedacos; k; k = k->anterior) {
+        if ((const char*) p >= (const char*) k->dados && (const char*) p < (const char*) k->dados + k->tam) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Liberta todos os objetos da arena, que fica vazia.
+ * @param a Arena a libertar.
+ */
+void arena_free(arena* const a) {
+    while (a->pedacos) {
+        arena_pedaco* const anterior = a->pedacos->anterior;
+        free(a->pedacos);
+        a->pedacos = anterior;
+    }
+    a->total = 0;
+}
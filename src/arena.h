@@ -0,0 +1,47 @@
+/**
+ * @file    arena.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Alocador por arena: os objetos são alocados sequencialmente em
+ *          pedaços grandes e só são libertados todos de uma vez.
+ * @details Cada pedaço tem pelo menos o tamanho de todos os pedaços anteriores
+ *          (entre ARENA_PEDACO_MIN e ARENA_PEDACO_MAX), de modo a que uma
+ *          arena com milhões de objetos tenha apenas algumas dezenas de
+ *          pedaços. Um objeto alocado numa arena nunca pode ser passado a free
+ *          ou a realloc.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/**
+ * @def ARENA_PEDACO_MIN
+ *          Tamanho do primeiro pedaço de uma arena.
+ * @def ARENA_PEDACO_MAX
+ *          Tamanho máximo de um pedaço (exceto para objetos maiores).
+ */
+#define ARENA_PEDACO_MIN (64 * 1024)
+#define ARENA_PEDACO_MAX (64 * 1024 * 1024)
+
+typedef struct arena_pedaco arena_pedaco;
+
+/**
+ * @brief   Arena, deve ser inicializada com arena_new.
+ */
+typedef struct {
+    arena_pedaco* pedacos; ///< Pedaço atual, ligado aos anteriores
+    size_t        total;   ///< Bytes alocados em todos os pedaços
+} arena;
+
+arena arena_new();
+void* arena_alocar(arena* const a, const size_t tam);
+char* arena_strdup(arena* const a, const char* const s);
+int   arena_contem(const arena* const a, const void* const p);
+void  arena_free(arena* const a);
+
+#endif
@@ -11,6 +11,7 @@
 #include "artigo.h"
 
 #include "menu.h"
+#include "persistencia.h"
 #include "utilities.h"
 
 /**
@@ -19,10 +20,10 @@
  */
 artigo newArtigo() {
     return (artigo) {
-        .nome       = strdup("Nome do artigo"), //
-        .meta       = ARTIGO_IVA_NORMAL,        //
-        .preco_cent = 0,                        //
-        .stock      = 0                         //
+        .nome       = nomes_inserir("Nome do artigo"), //
+        .meta       = ARTIGO_IVA_NORMAL,                //
+        .preco_cent = 0,                                //
+        .stock      = 0                                 //
     };
 }
 
@@ -30,7 +31,7 @@ artigo newArtigo() {
  * @brief       Responsavél por libertar a memória do artigo.
  * @param a     Artigo para ser libertado.
  */
-void freeArtigo(artigo* const a) { freeN(a->nome); }
+void freeArtigo(artigo* const a) { a->nome = NOMES_NENHUM; }
 
 /**
  * @brief       Responsável por salvar um artigo num ficheiro.
@@ -41,8 +42,8 @@ void freeArtigo(artigo* const a) { freeN(a->nome); }
  */
 int save_artigo(FILE* const f, const artigo* const data) {
     int written = 0;
-    written += save_str(f, data->nome);
-    if (!data->nome) { menu_printInfo("ao gravar artigo - nome inválido"); }
+    written += save_str(f, nomes_str(data->nome));
+    if (!nomes_str(data->nome)) { menu_printInfo("ao gravar artigo - nome inválido"); }
     written += fwrite(&data->meta, sizeof(uint8_t), 1, f);
     written += fwrite(&data->preco_cent, sizeof(int64_t), 1, f);
     written += fwrite(&data->stock, sizeof(int64_t), 1, f);
@@ -57,14 +58,120 @@ int save_artigo(FILE* const f, const artigo* const data) {
  * @returns     1 se carregou o artigo com sucesso.
  */
 int load_artigo(FILE* const f, artigo* const data) {
-    int written = 0;
-    written += load_str(f, &data->nome);
-    if (!data->nome) {
+    int   written = 0;
+    char* nome;
+    written += load_str(f, &nome);
+    data->nome = nomes_inserir(nome);
+    free(nome);
+    if (data->nome == NOMES_NENHUM) {
         menu_printInfo("ao carregar artigo - nome inválido");
-        data->nome = strdup("Nome");
+        data->nome = nomes_inserir("Nome");
     }
     written += fread(&data->meta, sizeof(uint8_t), 1, f);
     written += fread(&data->preco_cent, sizeof(int64_t), 1, f);
     written += fread(&data->stock, sizeof(int64_t), 1, f);
     return written == 4;
 }
+
+const int64_t artigo_ivaPercentagem[4] = {
+    [ARTIGO_IVA_NORMAL]     = ARTIGO_IVA_NORMAL_PERC,     //
+    [ARTIGO_IVA_INTERMEDIO] = ARTIGO_IVA_INTERMEDIO_PERC, //
+    [ARTIGO_IVA_REDUZIDO]   = ARTIGO_IVA_REDUZIDO_PERC,   //
+    [ARTIGO_IVA]            = 0                           //
+};
+
+/**
+ * @brief       Calcula o preço de um artigo com IVA, em cêntimos.
+ * @details     Só com inteiros: o preço é multiplicado por 100 mais a taxa e
+ *              dividido por 100, por isso o resultado é exato antes de ser
+ *              truncado.
+ * @param a     Artigo.
+ * @returns     O preço com IVA, truncado ao cêntimo.
+ */
+int64_t artigo_precoIVA(const artigo* const a) {
+    return a->preco_cent * (100 + artigo_ivaPercentagem[a->meta & ARTIGO_IVA]) / 100;
+}
+
+uint32_t artigo_versaoPrecos = 1;
+
+/**
+ * @brief       Avança artigo_versaoPrecos, de modo a que os totais das
+ *              encomendas guardados com a versão anterior voltem a ser
+ *              calculados (ver encomenda_total). Tem que ser chamada quando o
+ *              preço ou a taxa de IVA de um artigo muda, ou quando um artigo é
+ *              removido ou carregado.
+ */
+void artigo_mudouPreco() {
+    // A versão 0 marca os totais que nunca foram calculados
+    if (++artigo_versaoPrecos == ARTIGO_VERSAO_FIXA) artigo_versaoPrecos = 1;
+}
+
+/**
+ * @brief       Realoca '*p' para 'tam' bytes, mantendo '*p' se falhar.
+ * @param p     Ponteiro para a memória a realocar.
+ * @param tam   Novo tamanho.
+ * @returns     0 se não conseguiu alocar memória.
+ * @returns     1 se conseguiu.
+ */
+static int artigo_realocar(void** const p, const size_t tam) {
+    void* const novo = realloc(*p, tam);
+    if (!novo) return 0;
+    *p = novo;
+    return 1;
+}
+
+/**
+ * @brief       Preenche as colunas com os artigos de 'av', reutilizando a
+ *              memória já alocada nas colunas.
+ * @param c     Colunas, inicializadas a zero ou por uma chamada anterior.
+ * @param av    Artigos.
+ * @returns     0 se não conseguiu alocar memória.
+ * @returns     1 se carregou os artigos com sucesso.
+ */
+int artigo_colunasCarregar(artigo_colunas* const c, const artigocol* const av) {
+    const colSize_t n = av->size;
+    if (n > c->alocado) {
+        if (!artigo_realocar((void**) &c->meta, sizeof(uint8_t) * n) ||
+            !artigo_realocar((void**) &c->preco_cent, sizeof(int64_t) * n) ||
+            !artigo_realocar((void**) &c->stock, sizeof(int64_t) * n))
+            return 0;
+        c->alocado = n;
+    }
+    c->n = n;
+    for (colSize_t i = 0; i < n; i++) {
+        if (!artigocol_vivo(av, i)) {
+            c->meta[i]       = 0;
+            c->preco_cent[i] = 0;
+            c->stock[i]      = 0;
+        } else {
+            const artigo* const a = &av->data[i];
+            c->meta[i]            = a->meta;
+            c->preco_cent[i]      = a->preco_cent;
+            c->stock[i]           = a->stock;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief       Liberta a memória das colunas, que ficam vazias.
+ * @param c     Colunas.
+ */
+void artigo_colunasLibertar(artigo_colunas* const c) {
+    free(c->meta);
+    free(c->preco_cent);
+    free(c->stock);
+    *c = (artigo_colunas) {0};
+}
+
+/**
+ * @brief       Calcula o valor do stock (preço sem IVA vezes stock) de todos
+ *              os artigos.
+ * @param c     Colunas.
+ * @returns     O valor do stock em cêntimos.
+ */
+int64_t artigo_colunasValorStock(const artigo_colunas* const c) {
+    int64_t total = 0;
+    for (colSize_t i = 0; i < c->n; i++) total += c->preco_cent[i] * c->stock[i];
+    return total;
+}
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "nomes.h"
 
 // META ??????XX (XX é a taxa do iva a ser aplicada)
 // META ?????X?? (X é 1 quando o artigo pretence ao grupo ANIMAL)
@@ -24,28 +25,74 @@
 #define ARTIGO_IVA_NORMAL ((uint8_t) 0)
 #define ARTIGO_IVA_INTERMEDIO ((uint8_t) 1)
 #define ARTIGO_IVA_REDUZIDO ((uint8_t) 2)
-#define ARTIGO_IVA_NORMAL_VAL 1.23
-#define ARTIGO_IVA_INTERMEDIO_VAL 1.13
-#define ARTIGO_IVA_REDUZIDO_VAL 1.06
+#define ARTIGO_IVA_NORMAL_PERC 23
+#define ARTIGO_IVA_INTERMEDIO_PERC 13
+#define ARTIGO_IVA_REDUZIDO_PERC 6
 #define ARTIGO_GRUPO_ANIMAL ((uint8_t) 4)
 #define ARTIGO_NECESSITA_RECEITA ((uint8_t) 8)
 #define ARTIGO_DESATIVADO ((uint8_t) 16)
 
+/**
+ * @def ARTIGO_VERSAO_FIXA
+ *   Valor que artigo_versaoPrecos nunca toma, usado nos totais que não
+ *   dependem dos preços atuais dos artigos (ver encomenda_total).
+ */
+#define ARTIGO_VERSAO_FIXA UINT32_MAX
+
 /**
  * @brief   Um artigo é um objeto com um nome, peso, e informação relativa ao
  *          tipo de medicamento (taxa de IVA e grupo).
  */
 typedef struct {
-    char*   nome;       ///< Nome do artigo
-    uint8_t meta;       ///< Info sobre o artigo
-    int64_t preco_cent; ///< Preçco base do artigo em cêntimos
-    int64_t stock;      ///< Stock do artigo
+    nomes_id nome;       ///< Nome do artigo (ver nomes.h)
+    uint8_t  meta;       ///< Info sobre o artigo
+    int64_t  preco_cent; ///< Preçco base do artigo em cêntimos
+    int64_t  stock;      ///< Stock do artigo
 
 } artigo;
 
-artigo newArtigo();
-void   freeArtigo(artigo* const a);
-int    save_artigo(FILE* const f, const artigo* const data);
-int    load_artigo(FILE* const f, artigo* data);
+artigo  newArtigo();
+void    freeArtigo(artigo* const a);
+int     save_artigo(FILE* const f, const artigo* const data);
+int     load_artigo(FILE* const f, artigo* data);
+int64_t artigo_precoIVA(const artigo* const a);
+void    artigo_mudouPreco();
+
+extern const int64_t artigo_ivaPercentagem[4]; ///< Taxa de IVA em percentagem, indexada por 'meta & ARTIGO_IVA'
+extern uint32_t      artigo_versaoPrecos;      ///< Muda sempre que o preço, o IVA ou a existência de um artigo muda
+
+#ifndef artigocol_H
+#    define artigocol_H
+#    define COL_TIPO artigo
+#    define COL_NOME artigocol
+#    define COL_PARALELO
+#    define COL_SLOTS
+#    define COL_DEALOC(X) freeArtigo(X)
+#    define COL_WRITE(X, F) save_artigo(F, X)
+#    define COL_READ(X, F) load_artigo(F, X)
+#    include "colecao.h"
+#endif
+
+/**
+ * @brief   Cópia dos campos numéricos dos artigos de uma artigocol, guardados
+ *          por colunas (um array por campo, indexado pelo slot do artigo).
+ * @details Os cálculos que percorrem muitos artigos (valor do stock) leem
+ *          apenas arrays densos, sem trazer para a cache os nomes e o padding
+ *          de cada artigo. A artigocol continua a ser a fonte dos dados: as
+ *          colunas são preenchidas por artigo_colunasCarregar e só são
+ *          válidas enquanto os artigos não forem alterados. Os slots livres
+ *          têm preço e stock 0.
+ */
+typedef struct {
+    colSize_t n;          ///< Número de slots em cada coluna
+    colSize_t alocado;    ///< Número de slots alocados em cada coluna
+    uint8_t*  meta;       ///< Info sobre cada artigo
+    int64_t*  preco_cent; ///< Preço base de cada artigo em cêntimos
+    int64_t*  stock;      ///< Stock de cada artigo
+} artigo_colunas;
+
+int     artigo_colunasCarregar(artigo_colunas* const c, const artigocol* const av);
+void    artigo_colunasLibertar(artigo_colunas* const c);
+int64_t artigo_colunasValorStock(const artigo_colunas* const c);
 
 #endif
\ No newline at end of file
@@ -75,6 +75,125 @@
  *                  é do tipo 'COL_TIPO*' e F é do tipo FILE* e corresponde ao
  *                  ficheiro onde gravar o objeto. Caso não esteja definido, a
  *                  função _read não vai ser gerada.
+ * @def COL_POD
+ *                  Se este macro estiver definido, _write e _read gravam e
+ *                  carregam todo o array 'data' com uma única escrita/leitura,
+ *                  em vez de chamar COL_WRITE/COL_READ por cada objeto. A
+ *                  disposição no ficheiro é a disposição de COL_TIPO em memória
+ *                  numa máquina little-endian, por isso COL_TIPO não pode ter
+ *                  ponteiros nem padding implícito (o padding tem que ser
+ *                  declarado e mantido a 0).
+ * @def COL_POD_TROCA(X)
+ *                  Troca a ordem dos bytes dos campos de X, do tipo
+ *                  'COL_TIPO*'. Só é utilizado com COL_POD em máquinas
+ *                  big-endian e pode não ser definido se COL_TIPO for apenas
+ *                  constituído por bytes.
+ * @def COL_COMPRIMIR
+ *                  Com COL_POD, comprime os objetos com compressao_escrever
+ *                  (blocos independentes, ver compressao.h) em vez de os gravar
+ *                  diretamente. É necessário compilar compressao.c.
+ * @def COL_HOST_LE
+ *                  1 se a máquina é little-endian.
+ * @def COL_ALLOC(N)
+ *                  Aloca N bytes para o array 'data'. Por omição é malloc.
+ * @def COL_REALLOC(P, ANTIGO, N)
+ *                  Redimensiona o array P, com ANTIGO bytes, para N bytes (P
+ *                  pode ser NULL). Por omição é realloc, que ignora ANTIGO.
+ * @def COL_FREE(P)
+ *                  Liberta o array P alocado por COL_ALLOC ou COL_REALLOC. Por
+ *                  omição é free. Os três macros têm que ser definidos em
+ *                  conjunto, por exemplo para alocar numa arena (arena.h).
+ * @def COL_INLINE
+ *                  Se definido (com um valor N > 0), os primeiros N objetos são
+ *                  guardados dentro da própria struct e a coleção só aloca
+ *                  memória quando passa a ter mais de N objetos. Os objetos
+ *                  deixam de estar em 'data' e têm que ser acedidos com _data,
+ *                  que também existe nas coleções sem COL_INLINE.
+ * @def COL_SLOTS
+ *                  Se definido, a coleção é um slot map: remover um objeto
+ *                  (_remover) liberta o seu slot em O(1), sem mover os outros
+ *                  objetos, e o slot é reutilizado pelo próximo _inserir. Os
+ *                  objetos são referidos por handles (ver COL_SLOT_HANDLE) que
+ *                  incluem a geração do slot, de modo a que o handle de um
+ *                  objeto removido deixe de ser válido (_obter retorna NULL)
+ *                  mesmo depois de o slot ser reutilizado. 'size' é o número
+ *                  de slots, vivos e livres; _iterateFW só visita os vivos.
+ *                  _pop, _moveBelow, _moveAbove e _write não existem e
+ *                  COL_TIPO tem que ter pelo menos sizeof(colSize_t) bytes,
+ *                  onde um slot livre guarda o próximo slot livre. Não pode
+ *                  ser usado com COL_INLINE.
+ * @def COL_CMP(A, B)
+ *                  Se definido, a coleção pode ser mantida ordenada: compara
+ *                  os objetos A e B, do tipo 'const COL_TIPO*', e retorna um
+ *                  valor negativo, 0 ou positivo se A vem antes, é equivalente
+ *                  ou vem depois de B. Ativa _sort, _insertSorted,
+ *                  _lowerBound, _upperBound, _findEq e _iterateRange, que
+ *                  assumem que a coleção está ordenada (por _sort ou por ter
+ *                  sido construída só com _insertSorted). Não pode ser usado
+ *                  com COL_SLOTS.
+ * @def COL_PARALELO
+ *                  Se definido, ativa _parallelForEach e _parallelReduce, que
+ *                  dividem os objetos da coleção em partes contíguas e as
+ *                  percorrem em threads diferentes (ver paralelo.h). É
+ *                  necessário compilar paralelo.c.
+ * @def COL_SEGMENTOS
+ *                  Se definido, os objetos são guardados em segmentos de
+ *                  COL_SEGMENTO objetos, alocados um a um e encontrados por um
+ *                  diretório ('segmentos'), em vez de um único array. Crescer
+ *                  só aloca um segmento novo (e às vezes realoca o diretório),
+ *                  por isso os objetos nunca são copiados e um ponteiro para
+ *                  um objeto continua válido depois de um _push. Os objetos
+ *                  são acedidos com _at, em O(1), e o index de um ponteiro é
+ *                  obtido com _indice. _data, _borrow, _extend e _insertRange
+ *                  não existem e não pode ser usado com COL_INLINE, COL_SLOTS,
+ *                  COL_CMP nem COL_POD.
+ * @def COL_SEGMENTO_BITS
+ *                  Com COL_SEGMENTOS, cada segmento tem 2^COL_SEGMENTO_BITS
+ *                  objetos. Por omição é 10.
+ * @def COL_SEGMENTO
+ *                  Número de objetos de cada segmento.
+ * @def COL_PARALELO_MIN
+ *                  Número mínimo de objetos percorridos por cada thread de
+ *                  _parallelForEach e _parallelReduce.
+ * @def COL_SLOT_BITS
+ *                  Bits do handle com o index do slot, os restantes 8 guardam
+ *                  a geração.
+ * @def COL_SLOT_MAX
+ *                  Número máximo de slots de uma coleção com COL_SLOTS.
+ * @def COL_SLOT_INDEX(H)
+ *                  Index do slot do handle H.
+ * @def COL_SLOT_GERACAO(H)
+ *                  Geração do handle H.
+ * @def COL_SLOT_HANDLE(I, G)
+ *                  Handle do slot I na geração G. Um slot nasce na geração 0,
+ *                  por isso o handle de um objeto que nunca foi removido é o
+ *                  seu index. A geração é par enquanto o slot está vivo e
+ *                  ímpar enquanto está livre.
+ * @def COL_SLOT_RETIRADO
+ *                  Geração de um slot que já foi reutilizado todas as vezes
+ *                  que a geração permite, que fica livre para sempre em vez
+ *                  de voltar à geração 0.
+ * @def COL_DATA(V)
+ *                  Macro auxiliar, os objetos da coleção V.
+ * @def COL_HEAP(V)
+ *                  Macro auxiliar, o ponteiro para os objetos de V quando estes
+ *                  não estão dentro da coleção.
+ * @def COL_PROPRIO(V)
+ *                  Macro auxiliar, verdade se os objetos de V estão em memória
+ *                  alocada pela coleção.
+ * @def COL_PARA_CADA(NOME, V, P)
+ *                  Percorre os objetos da coleção V, do tipo 'NOME*', do
+ *                  menor ao maior index (só os vivos, com COL_SLOTS). É
+ *                  seguido do corpo do ciclo, onde P é um ponteiro para o
+ *                  objeto atual e P_i o seu index; 'break' e 'continue'
+ *                  funcionam como num 'for'. Ao contrário de _iterateFW, o
+ *                  corpo é compilado no próprio ciclo, sem chamar uma função
+ *                  por cada objeto, por isso pode ser otimizado em conjunto
+ *                  com o ciclo. V é avaliado várias vezes.
+ *                  @code{c}
+ *                  int64_t total = 0;
+ *                  COL_PARA_CADA(artigocol, &artigos, a) total += a->stock;
+ *                  @endcode
  * @def COL_PRE
  *                  Define apenas o preprocessadores.
  */
@@ -96,6 +215,11 @@
 #ifndef COL_READ
 #    define COL_READ(X, F) fread(X, sizeof(int), 1, F)
 #endif
+#ifndef COL_ALLOC
+#    define COL_ALLOC(N) malloc(N)
+#    define COL_REALLOC(P, ANTIGO, N) realloc(P, N)
+#    define COL_FREE(P) free(P)
+#endif
 
 #define COL_PASTER(X, Y) X##Y
 #define COL_EVAL(X, Y) COL_PASTER(X, Y)
@@ -107,50 +231,457 @@
 
 typedef uint32_t colSize_t;
 #define COL_INVAL_INDEX ~((colSize_t) 0)
+#define COL_SLOT_BITS 24
+#define COL_SLOT_MAX ((colSize_t) 1 << COL_SLOT_BITS)
+#define COL_SLOT_INDEX(H) ((colSize_t) (H) & (COL_SLOT_MAX - 1))
+#define COL_SLOT_GERACAO(H) ((uint8_t) ((colSize_t) (H) >> COL_SLOT_BITS))
+#define COL_SLOT_HANDLE(I, G) (((colSize_t) (G) << COL_SLOT_BITS) | (colSize_t) (I))
+#define COL_SLOT_RETIRADO ((uint8_t) 0xFF)
+#define COL_PARALELO_MIN 4096
+#define COL_PARA_CADA(NOME, V, P)                                                                                      \
+    for (colSize_t COL_EVAL(P, _i) = COL_EVAL(NOME, _proximo)(V, 0), COL_EVAL(P, _seguir) = 1;                         \
+         COL_EVAL(P, _seguir) && COL_EVAL(P, _i) < (V)->size;                                                          \
+         COL_EVAL(P, _seguir) = !COL_EVAL(P, _seguir),                                                                 \
+        COL_EVAL(P, _i)      = COL_EVAL(NOME, _proximo)(V, COL_EVAL(P, _i) + 1))                                       \
+        for (COL_EVAL(NOME, _tipo)* const P = COL_EVAL(NOME, _at)(V, COL_EVAL(P, _i)); COL_EVAL(P, _seguir);           \
+             COL_EVAL(P, _seguir) = 0)
+
+#if defined(COL_SLOTS) && defined(COL_INLINE)
+#    error "COL_SLOTS e COL_INLINE não podem ser usados em conjunto"
+#endif
+#if defined(COL_SLOTS) && defined(COL_CMP)
+#    error "COL_SLOTS e COL_CMP não podem ser usados em conjunto"
+#endif
+#if defined(COL_SEGMENTOS) && (defined(COL_INLINE) || defined(COL_SLOTS) || defined(COL_CMP) || defined(COL_POD))
+#    error "COL_SEGMENTOS não pode ser usado com COL_INLINE, COL_SLOTS, COL_CMP nem COL_POD"
+#endif
+#ifndef COL_SEGMENTO_BITS
+#    define COL_SEGMENTO_BITS 10
+#endif
+#define COL_SEGMENTO ((colSize_t) 1 << COL_SEGMENTO_BITS)
+#ifdef COL_PARALELO
+#    include "paralelo.h"
+#endif
+
+#ifndef COL_HOST_LE
+#    if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#        define COL_HOST_LE 0
+#    else
+#        define COL_HOST_LE 1
+#    endif
+#endif
 
 #if (defined(COL_IMPLEMENTACAO) || defined(COL_DECLARACAO))
 /**
  * @struct          COL_NOME
  * @brief           Struct com o nome COL_NOME que contém o tipo de dados
  *                  COL_TIPO e informação sobre o numero de objetos guardados,
- *                  pode guardar [0, COL_INVAL_INDEX[ elemntos.
+ *                  pode guardar [0, COL_INVAL_INDEX[ elemntos. Se 'alocated'
+ *                  for 0 e 'data' não for nulo a coleção empresta os objetos
+ *                  (ver _borrow).
  */
+#    ifdef COL_INLINE
 typedef struct {
-    colSize_t alocated; ///< Tamanho alocado de objetos.
+    colSize_t alocated; ///< COL_INLINE se os objetos estão em 'local', 0 se 'heap' é emprestado.
     colSize_t size;     ///< Tamanho de objetos que foi populado.
-    COL_TIPO* data;     ///< Começa em data[0] e acaba em data[size-1].
+    union {
+        COL_TIPO* heap;              ///< Objetos, se 'alocated' não for COL_INLINE.
+        COL_TIPO  local[COL_INLINE]; ///< Objetos, se 'alocated' for COL_INLINE.
+    };
 } COL_NOME;
+#        define COL_DATA(V) COL_FUN(_data)(V)
+#        define COL_HEAP(V) ((V)->heap)
+#        define COL_PROPRIO(V) ((V)->alocated > COL_INLINE)
+#    elif defined(COL_SEGMENTOS)
+typedef struct {
+    colSize_t  alocated;    ///< Objetos que cabem nos segmentos alocados, múltiplo de COL_SEGMENTO.
+    colSize_t  size;        ///< Tamanho de objetos que foi populado.
+    COL_TIPO** segmentos;   ///< Diretório, o objeto i está no segmento i / COL_SEGMENTO.
+    colSize_t  n_segmentos; ///< Entradas alocadas no diretório.
+} COL_NOME;
+#    else
+typedef struct {
+    colSize_t alocated;   ///< Tamanho alocado de objetos, 0 se 'data' é emprestado.
+    colSize_t size;       ///< Tamanho de objetos que foi populado.
+    COL_TIPO* data;       ///< Começa em data[0] e acaba em data[size-1].
+#        ifdef COL_SLOTS
+    uint8_t*  geracoes;   ///< Geração de cada slot, os slots além de 'n_geracoes' estão na geração 0.
+    colSize_t n_geracoes; ///< Tamanho alocado de 'geracoes'.
+    colSize_t livre;      ///< 1 + o primeiro slot da lista de slots livres, 0 se a lista está vazia.
+#        endif
+} COL_NOME;
+#        define COL_DATA(V) ((V)->data)
+#        define COL_HEAP(V) ((V)->data)
+#        define COL_PROPRIO(V) ((V)->alocated != 0)
+#    endif
 typedef int (*COL_FUN(_pred_t))(COL_TIPO*, void*);
+typedef COL_TIPO COL_FUN(_tipo); ///< Tipo dos objetos, para COL_PARA_CADA
+#    ifdef COL_PARALELO
+/**
+ * @brief           Função de _parallelReduce que acrescenta o objeto ao
+ *                  acumulador da thread que o percorre.
+ */
+typedef void (*COL_FUN(_map_t))(const COL_TIPO*, void* acumulador, void* userData);
+/**
+ * @brief           Função de _parallelReduce que junta o acumulador 'parcial'
+ *                  de uma thread a 'acumulador'.
+ */
+typedef void (*COL_FUN(_combine_t))(void* acumulador, const void* parcial, void* userData);
+#    endif
+
+/**
+ * @brief           Retorna os objetos da coleção, de _data(v)[0] a
+ *                  _data(v)[size-1].
+ * @param v         Coleção.
+ * @returns         Ponteiro para o primeiro objeto (pode ser NULL se a coleção
+ *                  estiver vazia).
+ * @warning         Com COL_INLINE o ponteiro deixa de ser válido se a coleção
+ *                  for movida ou crescer.
+ */
+#    ifndef COL_SEGMENTOS
+static inline COL_TIPO* COL_FUN(_data)(const COL_NOME* const v) {
+#        ifdef COL_INLINE
+    return (v->alocated == COL_INLINE) ? (COL_TIPO*) v->local : v->heap;
+#        else
+    return v->data;
+#        endif
+}
+#    endif
+
+/**
+ * @brief           Retorna o objeto no index 'i' da coleção.
+ * @param v         Coleção.
+ * @param i         Index, menor que 'alocated' (menor que 'size' com
+ *                  COL_INLINE).
+ * @returns         Ponteiro para o objeto.
+ * @note            Com COL_SEGMENTOS o ponteiro continua válido quando a
+ *                  coleção cresce, até o objeto ser movido (_moveBelow,
+ *                  _moveAbove, _removeIf) ou a coleção ser libertada.
+ */
+static inline COL_TIPO* COL_FUN(_at)(const COL_NOME* const v, const colSize_t i) {
+#    ifdef COL_SEGMENTOS
+    return &v->segmentos[i >> COL_SEGMENTO_BITS][i & (COL_SEGMENTO - 1)];
+#    else
+    return &COL_FUN(_data)(v)[i];
+#    endif
+}
+
+#    ifdef COL_SLOTS
+/**
+ * @brief           Retorna a geração do slot 'i'.
+ * @param v         Coleção.
+ * @param i         Slot.
+ * @returns         A geração, par se o slot está vivo e ímpar se está livre.
+ */
+static inline uint8_t COL_FUN(_geracao)(const COL_NOME* const v, const colSize_t i) {
+    return (i < v->n_geracoes) ? v->geracoes[i] : 0;
+}
+
+/**
+ * @brief           Verifica se o slot 'i' tem um objeto.
+ * @param v         Coleção.
+ * @param i         Slot.
+ * @returns         1 se o slot existe e não está livre, 0 caso contrário.
+ */
+static inline int COL_FUN(_vivo)(const COL_NOME* const v, const colSize_t i) {
+    return i < v->size && !(COL_FUN(_geracao)(v, i) & 1);
+}
+
+/**
+ * @brief           Retorna o handle do objeto no slot 'i', que tem que estar
+ *                  vivo.
+ * @param v         Coleção.
+ * @param i         Slot.
+ * @returns         O handle.
+ */
+static inline colSize_t COL_FUN(_handle)(const COL_NOME* const v, const colSize_t i) {
+    return COL_SLOT_HANDLE(i, COL_FUN(_geracao)(v, i));
+}
+
+/**
+ * @brief           Retorna o objeto referido pelo handle 'h'.
+ * @param v         Coleção.
+ * @param h         Handle retornado por _inserir ou _handle.
+ * @returns         O objeto, ou NULL se o objeto foi removido.
+ */
+static inline COL_TIPO* COL_FUN(_obter)(const COL_NOME* const v, const colSize_t h) {
+    const colSize_t i = COL_SLOT_INDEX(h);
+    const uint8_t   g = COL_SLOT_GERACAO(h);
+    if (i >= v->size || (g & 1) || COL_FUN(_geracao)(v, i) != g) return NULL;
+    return &v->data[i];
+}
+#    endif
+
+/**
+ * @brief           Retorna o primeiro index a partir de 'i' com um objeto
+ *                  (com COL_SLOTS, o primeiro slot vivo), ver COL_PARA_CADA.
+ * @param v         Coleção.
+ * @param i         Primeiro index a considerar.
+ * @returns         O index, maior ou igual a 'size' se não existir.
+ */
+static inline colSize_t COL_FUN(_proximo)(const COL_NOME* const v, colSize_t i) {
+#    ifdef COL_SLOTS
+    while (i < v->size && (COL_FUN(_geracao)(v, i) & 1)) i++;
+#    else
+    (void) v;
+#    endif
+    return i;
+}
 #endif
 
 #ifdef COL_IMPLEMENTACAO
+#    ifdef COL_SEGMENTOS
+/**
+ * @brief           Aloca segmentos até a coleção ter espaço para 'space'
+ *                  objetos, sem mover os objetos que já existem.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param space     Numero de objetos.
+ * @returns         0 se não conseguiu alocar memória (os segmentos alocados
+ *                  antes de falhar ficam na coleção).
+ * @returns         1 se conseguiu.
+ */
+static int COL_FUN(_alocarSegmentos)(COL_NOME* const v, const colSize_t space) {
+    if (space > COL_INVAL_INDEX - COL_SEGMENTO) return 0;
+    const colSize_t n = (space + COL_SEGMENTO - 1) >> COL_SEGMENTO_BITS;
+    if (n > v->n_segmentos) {
+        // Só o diretório é realocado, os segmentos ficam no mesmo sítio
+        colSize_t novo = v->n_segmentos ? v->n_segmentos : 8;
+        while (novo < n) novo *= 2;
+        COL_TIPO** const segmentos = COL_REALLOC(v->segmentos, sizeof(COL_TIPO*) * v->n_segmentos,
+                                                 sizeof(COL_TIPO*) * novo);
+        if (segmentos == NULL) return 0;
+        v->segmentos   = segmentos;
+        v->n_segmentos = novo;
+    }
+    for (colSize_t s = v->alocated >> COL_SEGMENTO_BITS; s < n; s++) {
+        v->segmentos[s] = COL_ALLOC(sizeof(COL_TIPO) * COL_SEGMENTO);
+        if (v->segmentos[s] == NULL) return 0;
+        v->alocated += COL_SEGMENTO;
+    }
+    return 1;
+}
+
 int COL_FUN(_addCell)(COL_NOME* const v) {
-    if (v->alocated == 0) {
+    if (v->size < v->alocated) return 2;
+    if (v->size == COL_INVAL_INDEX - 1) return 0;
+    return COL_FUN(_alocarSegmentos)(v, v->size + 1);
+}
+
+COL_NOME COL_FUN(_new)() { return (COL_NOME) {.size = 0, .alocated = 0, .segmentos = NULL, .n_segmentos = 0}; }
+
+int COL_FUN(_push)(COL_NOME* const v, COL_TIPO const newObj) {
+    if (!COL_FUN(_addCell)(v)) return 0;
+    *COL_FUN(_at)(v, v->size) = newObj;
+    ++(v->size);
+    return 1;
+}
+
+void COL_FUN(_moveBelow)(COL_NOME* const v, const colSize_t i) {
+    colSize_t k = i;
+    while (k + 1 < v->size) {
+        // Mover o resto do segmento de uma só vez, e depois o primeiro objeto do segmento seguinte
+        COL_TIPO* const seg = v->segmentos[k >> COL_SEGMENTO_BITS];
+        const colSize_t j   = k & (COL_SEGMENTO - 1);
+        colSize_t       n   = COL_SEGMENTO - 1 - j;
+        if (n > v->size - 1 - k) n = v->size - 1 - k;
+        memmove(&seg[j], &seg[j + 1], n * sizeof(COL_TIPO));
+        k += n;
+        if (k + 1 < v->size) {
+            *COL_FUN(_at)(v, k) = *COL_FUN(_at)(v, k + 1);
+            k++;
+        }
+    }
+    --(v->size);
+}
+
+int COL_FUN(_moveAbove)(COL_NOME* const v, const colSize_t i) {
+    if (!COL_FUN(_addCell)(v)) return 0;
+    colSize_t k = v->size;
+    while (k > i) {
+        COL_TIPO* const seg = v->segmentos[k >> COL_SEGMENTO_BITS];
+        const colSize_t j   = k & (COL_SEGMENTO - 1);
+        if (j == 0) {
+            // Primeiro objeto do segmento, vem do fim do segmento anterior
+            seg[0] = *COL_FUN(_at)(v, k - 1);
+            k--;
+            continue;
+        }
+        const colSize_t n = (j < k - i) ? j : k - i;
+        memmove(&seg[j - n + 1], &seg[j - n], n * sizeof(COL_TIPO));
+        k -= n;
+    }
+    ++(v->size);
+    return 1;
+}
+
+COL_TIPO COL_FUN(_pop)(COL_NOME* const v) {
+    COL_TIPO toReturn = *COL_FUN(_at)(v, v->size - 1);
+    --(v->size);
+    return toReturn;
+}
+
+void COL_FUN(_free)(COL_NOME* const v) {
+#        ifdef COL_DEALOC
+    for (colSize_t i = 0; i < v->size; i++) COL_DEALOC(COL_FUN(_at)(v, i));
+#        endif
+    for (colSize_t s = 0; s < v->alocated >> COL_SEGMENTO_BITS; s++) COL_FREE(v->segmentos[s]);
+    COL_FREE(v->segmentos);
+    *v = COL_FUN(_new)();
+}
+
+int COL_FUN(_adjust)(COL_NOME* const v) {
+    // Libertar os segmentos vazios do fim, os outros não são movidos
+    const colSize_t n = (v->size + COL_SEGMENTO - 1) >> COL_SEGMENTO_BITS;
+    if (n == v->alocated >> COL_SEGMENTO_BITS) return 2;
+    for (colSize_t s = n; s < v->alocated >> COL_SEGMENTO_BITS; s++) COL_FREE(v->segmentos[s]);
+    v->alocated = n << COL_SEGMENTO_BITS;
+    return 1;
+}
+
+colSize_t COL_FUN(_iterateFW)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData) {
+    for (colSize_t inicio = 0; inicio < v->size; inicio += COL_SEGMENTO) {
+        COL_TIPO* const seg = v->segmentos[inicio >> COL_SEGMENTO_BITS];
+        const colSize_t n   = (v->size - inicio < COL_SEGMENTO) ? v->size - inicio : COL_SEGMENTO;
+        for (colSize_t j = 0; j < n; j++) {
+            if (predicate(&seg[j], userData)) return inicio + j;
+        }
+    }
+    return COL_INVAL_INDEX;
+}
+
+int COL_FUN(_reserve)(COL_NOME* const v, colSize_t space) {
+    if (v->alocated >= space) return 2;
+    return COL_FUN(_alocarSegmentos)(v, space);
+}
+
+int COL_FUN(_pushN)(COL_NOME* const v, COL_TIPO const* const objs, const colSize_t n) {
+    if (n == 0) return 1;
+    if (n > COL_INVAL_INDEX - 1 - v->size || !COL_FUN(_reserve)(v, v->size + n)) return 0;
+    // Copiar segmento a segmento
+    for (colSize_t k = 0; k < n;) {
+        const colSize_t j = (v->size + k) & (COL_SEGMENTO - 1);
+        colSize_t       m = COL_SEGMENTO - j;
+        if (m > n - k) m = n - k;
+        memcpy(COL_FUN(_at)(v, v->size + k), &objs[k], m * sizeof(COL_TIPO));
+        k += m;
+    }
+    v->size += n;
+    return 1;
+}
+
+colSize_t COL_FUN(_removeIf)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData) {
+    colSize_t j = 0;
+    for (colSize_t i = 0; i < v->size; i++) {
+        COL_TIPO* const obj = COL_FUN(_at)(v, i);
+        if (predicate(obj, userData)) {
+#        ifdef COL_DEALOC
+            COL_DEALOC(obj);
+#        endif
+        } else {
+            if (i != j) *COL_FUN(_at)(v, j) = *obj;
+            j++;
+        }
+    }
+    const colSize_t removidos = v->size - j;
+    v->size                   = j;
+    return removidos;
+}
+#    else
+/**
+ * @brief           Copia os objetos emprestados da coleção para memória própria.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param space     Numero de células de memória a alocar (nunca menos que o
+ *                  tamanho da coleção).
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 se conseguiu.
+ */
+static int COL_FUN(_unborrow)(COL_NOME* const v, colSize_t space) {
+    if (space < v->size) space = v->size;
+    COL_TIPO* const emprestado = COL_HEAP(v);
+#        ifdef COL_INLINE
+    if (space <= COL_INLINE) {
+        // Cabe dentro da coleção ('local' sobrepõe-se a 'heap', que já foi copiado)
+        memmove(v->local, emprestado, sizeof(COL_TIPO) * v->size);
+        v->alocated = COL_INLINE;
+        return 1;
+    }
+#        endif
+    COL_TIPO* newData = COL_ALLOC(sizeof(COL_TIPO) * space);
+    if (newData == NULL) return 0;
+    memcpy(newData, emprestado, sizeof(COL_TIPO) * v->size);
+    COL_HEAP(v) = newData;
+    v->alocated = space;
+    return 1;
+}
+
+#        ifdef COL_INLINE
+/**
+ * @brief           Passa os objetos guardados dentro da coleção para memória
+ *                  alocada.
+ * @param v         Ponteiro para a coleção, com 'alocated' igual a COL_INLINE.
+ * @param space     Numero de células de memória a alocar (mais que
+ *                  COL_INLINE).
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 se conseguiu.
+ */
+static int COL_FUN(_spill)(COL_NOME* const v, const colSize_t space) {
+    COL_TIPO* newData = COL_ALLOC(sizeof(COL_TIPO) * space);
+    if (newData == NULL) return 0;
+    memcpy(newData, v->local, sizeof(COL_TIPO) * v->size);
+    v->heap     = newData;
+    v->alocated = space;
+    return 1;
+}
+#        endif
+
+int COL_FUN(_addCell)(COL_NOME* const v) {
+#        ifdef COL_SLOTS
+    // O index de um slot tem que caber num handle
+    if (v->size >= COL_SLOT_MAX) return 0;
+#        endif
+    if (v->alocated == 0 && COL_HEAP(v) != NULL) {
+        // coleção emprestada, copiar para memória própria
+#        ifdef COL_INLINE
+        if (v->size < COL_INLINE) return COL_FUN(_unborrow)(v, COL_INLINE);
+#        endif
+        return COL_FUN(_unborrow)(v, v->size < 4 ? 8 : v->size * 2);
+    } else if (v->alocated == 0) {
         // coleção vazia
-        v->data = malloc(sizeof(COL_TIPO) * 8);
+#        ifdef COL_INLINE
+        // Usar o espaço dentro da coleção
+        v->alocated = COL_INLINE;
+        return 1;
+#        else
+        v->data = COL_ALLOC(sizeof(COL_TIPO) * 8);
         if (v->data == NULL) return 0;
         v->alocated = 8;
         return 1;
+#        endif
     } else if (v->size == v->alocated) {
+#        ifdef COL_INLINE
+        // O espaço dentro da coleção está cheio
+        if (v->alocated == COL_INLINE) return COL_FUN(_spill)(v, COL_INLINE < 4 ? 8 : COL_INLINE * 2);
+#        endif
         // A coleção está cheio e necessita de ser redimensionado
-        void* newData = realloc(v->data, sizeof(COL_TIPO) * (v->alocated * 2));
+        void* newData =
+            COL_REALLOC(COL_HEAP(v), sizeof(COL_TIPO) * v->alocated, sizeof(COL_TIPO) * (v->alocated * 2));
         if (newData == NULL) {
             // Foi impossivel realocar memoria sufuciente
             // Tentar realocar apenas mais um espaço
-            newData = realloc(v->data, sizeof(COL_TIPO) * (v->alocated + 1));
+            newData = COL_REALLOC(COL_HEAP(v), sizeof(COL_TIPO) * v->alocated, sizeof(COL_TIPO) * (v->alocated + 1));
             if (newData == NULL) {
                 // Impossivel alocar mais memoria
                 return 0;
             } else {
                 // Memoria alocada, fazer o update da coleção
                 v->alocated += 1;
-                v->data = newData;
+                COL_HEAP(v) = newData;
                 return 1;
             }
         } else {
             // Memoria alocada, fazer o update da coleção
             v->alocated *= 2;
-            v->data = newData;
+            COL_HEAP(v) = newData;
             return 1;
         }
     } else {
@@ -159,102 +690,612 @@ int COL_FUN(_addCell)(COL_NOME* const v) {
     }
 }
 
-COL_NOME COL_FUN(_new)() { return (COL_NOME) {.size = 0, .alocated = 0, .data = NULL}; }
+COL_NOME COL_FUN(_new)() { return (COL_NOME) {.size = 0, .alocated = 0}; }
+
+COL_NOME COL_FUN(_borrow)(COL_TIPO* const data, const colSize_t size) {
+    COL_NOME v   = {.size = size, .alocated = 0};
+    COL_HEAP(&v) = size ? data : NULL;
+#        ifdef COL_INLINE
+    // Poucos objetos são copiados para dentro da coleção
+    if (size && size <= COL_INLINE) COL_FUN(_unborrow)(&v, COL_INLINE);
+#        endif
+    return v;
+}
 
 int COL_FUN(_push)(COL_NOME* const v, COL_TIPO const newObj) {
     if (!COL_FUN(_addCell)(v)) return 0;
     // Aqui está garantido que existe um espaço alocado e livre na coleção
-    v->data[v->size] = newObj;
+    COL_DATA(v)[v->size] = newObj;
     ++(v->size);
     return 1;
 }
 
+#        ifndef COL_SLOTS
 void COL_FUN(_moveBelow)(COL_NOME* const v, const colSize_t i) {
-    memmove(&v->data[i], &v->data[i + 1], (v->size - i - 1) * sizeof(COL_TIPO));
+    COL_TIPO* const data = COL_DATA(v);
+    memmove(&data[i], &data[i + 1], (v->size - i - 1) * sizeof(COL_TIPO));
     --(v->size);
 }
 
 int COL_FUN(_moveAbove)(COL_NOME* const v, const colSize_t i) {
     if (!COL_FUN(_addCell)(v)) return 0;
-    memmove(&v->data[i + 1], &v->data[i], (v->size - i) * sizeof(COL_TIPO));
+    COL_TIPO* const data = COL_DATA(v);
+    memmove(&data[i + 1], &data[i], (v->size - i) * sizeof(COL_TIPO));
     ++(v->size);
     return 1;
 }
 
 COL_TIPO COL_FUN(_pop)(COL_NOME* const v) {
-    COL_TIPO toReturn = v->data[v->size - 1];
+    COL_TIPO toReturn = COL_DATA(v)[v->size - 1];
     --(v->size);
     return toReturn;
 }
+#        else
+_Static_assert(sizeof(COL_TIPO) >= sizeof(colSize_t), "COL_SLOTS: COL_TIPO não tem espaço para a lista de livres");
+
+/**
+ * @brief           Garante que 'geracoes' tem pelo menos 'n' slots.
+ * @param v         Coleção.
+ * @param n         Número de slots.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 caso contrário.
+ */
+static int COL_FUN(_reservarGeracoes)(COL_NOME* const v, const colSize_t n) {
+    if (n <= v->n_geracoes) return 1;
+    colSize_t novo = (v->n_geracoes < 4) ? 8 : v->n_geracoes * 2;
+    if (novo < n) novo = n;
+    uint8_t* const g = COL_REALLOC(v->geracoes, v->n_geracoes, novo);
+    if (g == NULL) return 0;
+    // Os slots novos estão na geração 0
+    memset(g + v->n_geracoes, 0, novo - v->n_geracoes);
+    v->geracoes   = g;
+    v->n_geracoes = novo;
+    return 1;
+}
+
+/**
+ * @brief           Lê o slot que segue o slot livre 'i' na lista de livres.
+ * @returns         1 + o slot seguinte, 0 se 'i' é o último.
+ */
+static colSize_t COL_FUN(_seguinte)(const COL_NOME* const v, const colSize_t i) {
+    colSize_t seguinte;
+    memcpy(&seguinte, &v->data[i], sizeof(seguinte));
+    return seguinte;
+}
+
+/**
+ * @brief           Guarda no slot livre 'i' o slot que o segue na lista de
+ *                  livres (1 + o slot, 0 se 'i' é o último).
+ */
+static void COL_FUN(_ligar)(COL_NOME* const v, const colSize_t i, const colSize_t seguinte) {
+    memcpy(&v->data[i], &seguinte, sizeof(seguinte));
+}
+
+colSize_t COL_FUN(_inserir)(COL_NOME* const v, COL_TIPO const newObj) {
+    if (!v->livre) {
+        // Não há slots livres, acrescentar um novo na geração 0
+        if (!COL_FUN(_push)(v, newObj)) return COL_INVAL_INDEX;
+        return COL_FUN(_handle)(v, v->size - 1);
+    }
+    // Reutilizar o primeiro slot livre, na geração seguinte
+    const colSize_t i = v->livre - 1;
+    v->livre          = COL_FUN(_seguinte)(v, i);
+    ++(v->geracoes[i]);
+    v->data[i] = newObj;
+    return COL_SLOT_HANDLE(i, v->geracoes[i]);
+}
+
+colSize_t COL_FUN(_ocupar)(COL_NOME* const v, const colSize_t i, COL_TIPO const newObj) {
+    if (i == v->size) return COL_FUN(_push)(v, newObj) ? COL_FUN(_handle)(v, i) : COL_INVAL_INDEX;
+    const uint8_t g = COL_FUN(_geracao)(v, i);
+    if (i > v->size || !(g & 1) || g == COL_SLOT_RETIRADO || !v->livre) return COL_INVAL_INDEX;
+    // Retirar 'i' da lista de livres, normalmente é o primeiro
+    if (v->livre == i + 1) {
+        v->livre = COL_FUN(_seguinte)(v, i);
+    } else {
+        colSize_t j = v->livre - 1;
+        colSize_t s;
+        while ((s = COL_FUN(_seguinte)(v, j)) != i + 1) {
+            if (s == 0) return COL_INVAL_INDEX;
+            j = s - 1;
+        }
+        COL_FUN(_ligar)(v, j, COL_FUN(_seguinte)(v, i));
+    }
+    ++(v->geracoes[i]);
+    v->data[i] = newObj;
+    return COL_SLOT_HANDLE(i, v->geracoes[i]);
+}
+
+int COL_FUN(_remover)(COL_NOME* const v, const colSize_t h) {
+    const colSize_t i = COL_SLOT_INDEX(h);
+    if (COL_FUN(_obter)(v, h) == NULL || !COL_FUN(_reservarGeracoes)(v, i + 1)) return 0;
+    ++(v->geracoes[i]);
+    // Um slot que esgotou as gerações nunca mais é reutilizado
+    if (v->geracoes[i] != COL_SLOT_RETIRADO) {
+        COL_FUN(_ligar)(v, i, v->livre);
+        v->livre = i + 1;
+    }
+    return 1;
+}
+
+int COL_FUN(_definirGeracao)(COL_NOME* const v, const colSize_t i, const uint8_t geracao) {
+    if (geracao == 0 && i >= v->n_geracoes) return 1;
+    if (!COL_FUN(_reservarGeracoes)(v, i + 1)) return 0;
+    v->geracoes[i] = geracao;
+    return 1;
+}
+
+void COL_FUN(_refazerLivres)(COL_NOME* const v) {
+    v->livre = 0;
+    // Do último para o primeiro, para que os slots mais baixos sejam reutilizados primeiro
+    for (colSize_t i = (v->n_geracoes < v->size) ? v->n_geracoes : v->size; i-- > 0;) {
+        if ((v->geracoes[i] & 1) && v->geracoes[i] != COL_SLOT_RETIRADO) {
+            COL_FUN(_ligar)(v, i, v->livre);
+            v->livre = i + 1;
+        }
+    }
+}
+#        endif
 
 void COL_FUN(_free)(COL_NOME* const v) {
-#    ifdef COL_DEALOC
-    for (colSize_t i = 0; i < v->size; i++) { COL_DEALOC(&(v->data[i])); }
-#    endif
-    if (v->alocated != 0) free(v->data);
-    v->data     = NULL;
+#        ifdef COL_DEALOC
+    for (colSize_t i = 0; i < v->size; i++) {
+#            ifdef COL_SLOTS
+        if (COL_FUN(_geracao)(v, i) & 1) continue;
+#            endif
+        COL_DEALOC(&(COL_DATA(v)[i]));
+    }
+#        endif
+    if (COL_PROPRIO(v)) COL_FREE(COL_HEAP(v));
+    COL_HEAP(v) = NULL;
     v->size     = 0;
     v->alocated = 0;
+#        ifdef COL_SLOTS
+    COL_FREE(v->geracoes);
+    v->geracoes   = NULL;
+    v->n_geracoes = 0;
+    v->livre      = 0;
+#        endif
 }
 
 int COL_FUN(_adjust)(COL_NOME* const v) {
-    if (v->size == v->alocated) return 2;
-    COL_TIPO* newData = realloc(v->data, v->size * sizeof(COL_TIPO));
+    if (v->size == v->alocated || !COL_PROPRIO(v)) return 2;
+#        ifdef COL_INLINE
+    if (v->size <= COL_INLINE) {
+        // Voltar a guardar os objetos dentro da coleção
+        COL_TIPO* const heap = v->heap;
+        memcpy(v->local, heap, v->size * sizeof(COL_TIPO));
+        COL_FREE(heap);
+        v->alocated = COL_INLINE;
+        return 1;
+    }
+#        endif
+    COL_TIPO* newData = COL_REALLOC(COL_HEAP(v), v->alocated * sizeof(COL_TIPO), v->size * sizeof(COL_TIPO));
     if (newData == NULL) return 0;
-    v->data     = newData;
+    COL_HEAP(v) = newData;
     v->alocated = v->size;
     return 1;
 }
 
 colSize_t COL_FUN(_iterateFW)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData) {
+    COL_TIPO* const data = COL_DATA(v);
     for (colSize_t i = 0; i < v->size; i++) {
-        if (predicate(&(v->data[i]), userData)) return i;
+#        ifdef COL_SLOTS
+        if (COL_FUN(_geracao)(v, i) & 1) continue;
+#        endif
+        if (predicate(&(data[i]), userData)) return i;
     }
     return COL_INVAL_INDEX;
 }
 
 int COL_FUN(_reserve)(COL_NOME* const v, colSize_t space) {
     if (v->alocated >= space) return 2;
-    void* newData = realloc(v->data, sizeof(COL_TIPO) * (space));
+    if (v->alocated == 0 && COL_HEAP(v) != NULL) return COL_FUN(_unborrow)(v, space);
+#        ifdef COL_INLINE
+    if (v->alocated == 0 && space <= COL_INLINE) {
+        v->alocated = COL_INLINE;
+        return 1;
+    }
+    if (v->alocated == COL_INLINE) return COL_FUN(_spill)(v, space);
+#        endif
+    void* newData = COL_REALLOC(COL_HEAP(v), sizeof(COL_TIPO) * v->alocated, sizeof(COL_TIPO) * (space));
     if (newData == NULL) return 0;
     // Memoria alocada, fazer o update da coleção
     v->alocated = space;
-    v->data     = newData;
+    COL_HEAP(v) = newData;
     return 1;
 }
 
+/**
+ * @brief           Garante espaço para mais 'n' objetos, pelo menos dobrando o
+ *                  espaço alocado se tiver que alocar, como _addCell.
+ * @param v         Coleção.
+ * @param n         Número de objetos a acrescentar.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 caso contrário.
+ */
+static int COL_FUN(_crescer)(COL_NOME* const v, const colSize_t n) {
+#        ifdef COL_SLOTS
+    if (n > COL_SLOT_MAX - v->size) return 0;
+#        endif
+    if (n > COL_INVAL_INDEX - 1 - v->size) return 0;
+    const colSize_t space = v->size + n;
+    if (space <= v->alocated) return 1;
+    const colSize_t dobro = (v->alocated < COL_INVAL_INDEX / 2) ? v->alocated * 2 : COL_INVAL_INDEX - 1;
+    return COL_FUN(_reserve)(v, space > dobro ? space : dobro) || COL_FUN(_reserve)(v, space);
+}
+
+int COL_FUN(_pushN)(COL_NOME* const v, COL_TIPO const* const objs, const colSize_t n) {
+    if (n == 0) return 1;
+    if (!COL_FUN(_crescer)(v, n)) return 0;
+    memcpy(&COL_DATA(v)[v->size], objs, n * sizeof(COL_TIPO));
+    v->size += n;
+    return 1;
+}
+
+#        ifndef COL_SLOTS
+int COL_FUN(_extend)(COL_NOME* const v, const COL_NOME* const outra) {
+    return COL_FUN(_pushN)(v, COL_DATA(outra), outra->size);
+}
+
+int COL_FUN(_insertRange)(COL_NOME* const v, const colSize_t i, COL_TIPO const* const objs, const colSize_t n) {
+    if (n == 0) return 1;
+    if (!COL_FUN(_crescer)(v, n)) return 0;
+    COL_TIPO* const data = COL_DATA(v);
+    memmove(&data[i + n], &data[i], (v->size - i) * sizeof(COL_TIPO));
+    memcpy(&data[i], objs, n * sizeof(COL_TIPO));
+    v->size += n;
+    return 1;
+}
+
+colSize_t COL_FUN(_removeIf)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData) {
+    COL_TIPO* const data = COL_DATA(v);
+    colSize_t       j    = 0;
+    for (colSize_t i = 0; i < v->size; i++) {
+        if (predicate(&data[i], userData)) {
+#            ifdef COL_DEALOC
+            COL_DEALOC(&data[i]);
+#            endif
+        } else {
+            if (i != j) data[j] = data[i];
+            j++;
+        }
+    }
+    const colSize_t removidos = v->size - j;
+    v->size                   = j;
+    return removidos;
+}
+#        endif
+#    endif
+
 void COL_FUN(_DEALOC)(COL_TIPO* const X) {
 #    ifdef COL_DEALOC
     COL_DEALOC(X);
 #    endif
 }
 
-#    ifdef COL_WRITE
+colSize_t COL_FUN(_indice)(const COL_NOME* const v, COL_TIPO const* const obj) {
+#    ifdef COL_SEGMENTOS
+    // Procurar o segmento que contém 'obj'
+    for (colSize_t s = 0; s < v->alocated >> COL_SEGMENTO_BITS; s++) {
+        const uintptr_t seg = (uintptr_t) v->segmentos[s];
+        if ((uintptr_t) obj >= seg && (uintptr_t) obj < seg + sizeof(COL_TIPO) * COL_SEGMENTO)
+            return (s << COL_SEGMENTO_BITS) + (colSize_t) (obj - v->segmentos[s]);
+    }
+    return COL_INVAL_INDEX;
+#    else
+    COL_TIPO const* const data = COL_FUN(_data)(v);
+    if (v->size == 0 || (uintptr_t) obj < (uintptr_t) data || (uintptr_t) obj >= (uintptr_t) (data + v->size))
+        return COL_INVAL_INDEX;
+    return (colSize_t) (obj - data);
+#    endif
+}
+
+#    ifdef COL_CMP
+/**
+ * @brief           Troca os objetos 'a' e 'b'.
+ */
+static inline void COL_FUN(_trocar)(COL_TIPO* const a, COL_TIPO* const b) {
+    const COL_TIPO t = *a;
+    *a               = *b;
+    *b               = t;
+}
+
+/**
+ * @brief           Desce o objeto 'i' no heap d[0, n[ até que nenhum filho
+ *                  seja maior.
+ */
+static void COL_FUN(_peneirar)(COL_TIPO* const d, colSize_t i, const colSize_t n) {
+    while (1) {
+        colSize_t maior = i;
+        colSize_t f     = 2 * i + 1;
+        if (f < n && COL_CMP(&d[f], &d[maior]) > 0) maior = f;
+        if (f + 1 < n && COL_CMP(&d[f + 1], &d[maior]) > 0) maior = f + 1;
+        if (maior == i) return;
+        COL_FUN(_trocar)(&d[i], &d[maior]);
+        i = maior;
+    }
+}
+
+/**
+ * @brief           Ordena d[0, n[ por inserção, para partições pequenas.
+ */
+static void COL_FUN(_ordenarInsercao)(COL_TIPO* const d, const colSize_t n) {
+    for (colSize_t i = 1; i < n; i++) {
+        const COL_TIPO x = d[i];
+        colSize_t      j = i;
+        for (; j > 0 && COL_CMP(&x, &d[j - 1]) < 0; j--) d[j] = d[j - 1];
+        d[j] = x;
+    }
+}
+
+/**
+ * @brief           Introsort de d[0, n[: quicksort com a mediana de três como
+ *                  pivô, heapsort se a recursão passar de 'profundidade' e
+ *                  inserção nas partições com 16 objetos ou menos.
+ */
+static void COL_FUN(_introSort)(COL_TIPO* d, colSize_t n, unsigned profundidade) {
+    while (n > 16) {
+        if (profundidade-- == 0) {
+            // Demasiadas partições desequilibradas, heapsort garante O(n log n)
+            for (colSize_t i = n / 2; i-- > 0;) COL_FUN(_peneirar)(d, i, n);
+            for (colSize_t i = n - 1; i > 0; i--) {
+                COL_FUN(_trocar)(&d[0], &d[i]);
+                COL_FUN(_peneirar)(d, 0, i);
+            }
+            return;
+        }
+        // Mediana de três, que também serve de sentinela nas pontas
+        const colSize_t m = n / 2;
+        if (COL_CMP(&d[m], &d[0]) < 0) COL_FUN(_trocar)(&d[m], &d[0]);
+        if (COL_CMP(&d[n - 1], &d[0]) < 0) COL_FUN(_trocar)(&d[n - 1], &d[0]);
+        if (COL_CMP(&d[n - 1], &d[m]) < 0) COL_FUN(_trocar)(&d[n - 1], &d[m]);
+        const COL_TIPO pivo = d[m];
+        // Partição de Hoare: d[0, j] <= pivo <= d[j + 1, n[
+        colSize_t i = 0;
+        colSize_t j = n - 1;
+        while (1) {
+            while (COL_CMP(&d[i], &pivo) < 0) i++;
+            while (COL_CMP(&pivo, &d[j]) < 0) j--;
+            if (i >= j) break;
+            COL_FUN(_trocar)(&d[i], &d[j]);
+            i++;
+            j--;
+        }
+        // Recursão na partição menor, iteração na maior
+        if (j + 1 < n - j - 1) {
+            COL_FUN(_introSort)(d, j + 1, profundidade);
+            d += j + 1;
+            n -= j + 1;
+        } else {
+            COL_FUN(_introSort)(d + j + 1, n - j - 1, profundidade);
+            n = j + 1;
+        }
+    }
+    COL_FUN(_ordenarInsercao)(d, n);
+}
+
+void COL_FUN(_sort)(COL_NOME* const v) {
+    unsigned profundidade = 0;
+    for (colSize_t n = v->size; n > 1; n >>= 1) profundidade += 2;
+    COL_FUN(_introSort)(COL_DATA(v), v->size, profundidade);
+}
+
+colSize_t COL_FUN(_lowerBound)(const COL_NOME* const v, const COL_TIPO* const chave) {
+    const COL_TIPO* const data = COL_DATA(v);
+    colSize_t             de   = 0;
+    colSize_t             n    = v->size;
+    while (n > 0) {
+        const colSize_t metade = n / 2;
+        if (COL_CMP(&data[de + metade], chave) < 0) {
+            de += metade + 1;
+            n -= metade + 1;
+        } else
+            n = metade;
+    }
+    return de;
+}
+
+colSize_t COL_FUN(_upperBound)(const COL_NOME* const v, const COL_TIPO* const chave) {
+    const COL_TIPO* const data = COL_DATA(v);
+    colSize_t             de   = 0;
+    colSize_t             n    = v->size;
+    while (n > 0) {
+        const colSize_t metade = n / 2;
+        if (COL_CMP(chave, &data[de + metade]) >= 0) {
+            de += metade + 1;
+            n -= metade + 1;
+        } else
+            n = metade;
+    }
+    return de;
+}
+
+colSize_t COL_FUN(_findEq)(const COL_NOME* const v, const COL_TIPO* const chave) {
+    const colSize_t i = COL_FUN(_lowerBound)(v, chave);
+    if (i < v->size && COL_CMP(&COL_DATA(v)[i], chave) == 0) return i;
+    return COL_INVAL_INDEX;
+}
+
+colSize_t COL_FUN(_insertSorted)(COL_NOME* const v, COL_TIPO const newObj) {
+    // Depois dos objetos equivalentes, para que a ordem de inserção se mantenha
+    const colSize_t i = COL_FUN(_upperBound)(v, &newObj);
+    if (!COL_FUN(_moveAbove)(v, i)) return COL_INVAL_INDEX;
+    COL_DATA(v)[i] = newObj;
+    return i;
+}
+
+colSize_t COL_FUN(_iterateRange)(COL_NOME* const v, const COL_TIPO* const de, const COL_TIPO* const ate,
+                                 COL_FUN(_pred_t) predicate, void* userData) {
+    COL_TIPO* const data = COL_DATA(v);
+    const colSize_t fim  = ate ? COL_FUN(_lowerBound)(v, ate) : v->size;
+    for (colSize_t i = de ? COL_FUN(_lowerBound)(v, de) : 0; i < fim; i++) {
+        if (predicate(&(data[i]), userData)) return i;
+    }
+    return COL_INVAL_INDEX;
+}
+#    endif
+
+#    ifdef COL_PARALELO
+/**
+ * @brief           Argumentos de _tarefaParaCada e _tarefaReduzir.
+ */
+typedef struct {
+    const COL_NOME*  v;         ///< Coleção percorrida
+    COL_FUN(_pred_t) predicate; ///< Função de _parallelForEach
+    COL_FUN(_map_t)  map;       ///< Função de _parallelReduce
+    void*            userData;  ///< Dados passados a 'predicate' ou 'map'
+    unsigned char*   parciais;  ///< Acumulador de cada parte de _parallelReduce
+    size_t           tamanho;   ///< Bytes de cada acumulador
+    size_t           partes;    ///< Partes em que a coleção foi dividida
+} COL_FUN(_paralelo);
+
+/**
+ * @brief           Chama 'predicate' com os objetos [de, ate[ da coleção.
+ * @param arg       COL_FUN(_paralelo).
+ * @returns         1
+ */
+static int COL_FUN(_tarefaParaCada)(void* const arg, const size_t de, const size_t ate) {
+    const COL_FUN(_paralelo)* const p = arg;
+    for (size_t i = de; i < ate; i++) {
+#        ifdef COL_SLOTS
+        if (COL_FUN(_geracao)(p->v, i) & 1) continue;
+#        endif
+        p->predicate(COL_FUN(_at)(p->v, i), p->userData);
+    }
+    return 1;
+}
+
+/**
+ * @brief           Acumula com 'map' os objetos das partes [de, ate[, cada
+ *                  parte no seu acumulador.
+ * @param arg       COL_FUN(_paralelo).
+ * @returns         1
+ */
+static int COL_FUN(_tarefaReduzir)(void* const arg, const size_t de, const size_t ate) {
+    const COL_FUN(_paralelo)* const p = arg;
+    for (size_t parte = de; parte < ate; parte++) {
+        void* const  acumulador = p->parciais + parte * p->tamanho;
+        const size_t fim        = (size_t) p->v->size * (parte + 1) / p->partes;
+        for (size_t i = (size_t) p->v->size * parte / p->partes; i < fim; i++) {
+#        ifdef COL_SLOTS
+            if (COL_FUN(_geracao)(p->v, i) & 1) continue;
+#        endif
+            p->map(COL_FUN(_at)(p->v, i), acumulador, p->userData);
+        }
+    }
+    return 1;
+}
+
+void COL_FUN(_parallelForEach)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData, int nthreads) {
+    COL_FUN(_paralelo) p = {.v = v, .predicate = predicate, .userData = userData};
+    if (nthreads <= 0) nthreads = paralelo_threads();
+    paralelo_executar(v->size, COL_PARALELO_MIN, nthreads, COL_FUN(_tarefaParaCada), &p);
+}
+
+int COL_FUN(_parallelReduce)(const COL_NOME* const v, COL_FUN(_map_t) map, COL_FUN(_combine_t) combine,
+                             const void* const identidade, const size_t tamanho, void* const resultado,
+                             void* userData, int nthreads) {
+    if (nthreads <= 0) nthreads = paralelo_threads();
+    size_t partes = v->size / COL_PARALELO_MIN;
+    if (partes > (size_t) nthreads) partes = (size_t) nthreads;
+    if (partes > PARALELO_MAX_THREADS) partes = PARALELO_MAX_THREADS;
+    if (partes < 1) partes = 1;
+
+    COL_FUN(_paralelo) p = {.v        = v,
+                            .map      = map,
+                            .userData = userData,
+                            .parciais = malloc(tamanho * partes),
+                            .tamanho  = tamanho,
+                            .partes   = partes};
+    if (p.parciais == NULL && tamanho != 0) return 0;
+    for (size_t i = 0; i < partes && tamanho != 0; i++) memcpy(p.parciais + i * tamanho, identidade, tamanho);
+    // Uma parte por thread
+    paralelo_executar(partes, 1, (int) partes, COL_FUN(_tarefaReduzir), &p);
+    // Juntar os acumuladores pela ordem das partes, para que o resultado não dependa das threads
+    for (size_t i = 0; i < partes; i++) combine(resultado, p.parciais + i * tamanho, userData);
+    free(p.parciais);
+    return 1;
+}
+#    endif
+
+#    if defined(COL_POD) && defined(COL_SLOTS)
+#        error "COL_SLOTS não pode ser usado com COL_POD"
+#    elif defined(COL_POD)
+#        ifdef COL_COMPRIMIR
+#            include "compressao.h"
+#            define COL_POD_ESCREVER(D, N, F) compressao_escrever(F, D, (size_t) (N) * sizeof(COL_TIPO))
+#            define COL_POD_LER(D, N, F) compressao_ler(F, D, (size_t) (N) * sizeof(COL_TIPO))
+#        else
+#            define COL_POD_ESCREVER(D, N, F) (fwrite(D, sizeof(COL_TIPO), N, F) == (N))
+#            define COL_POD_LER(D, N, F) (fread(D, sizeof(COL_TIPO), N, F) == (N))
+#        endif
+int COL_FUN(_write)(const COL_NOME* const v, FILE* f) {
+    // Gravar tamanho da coleção
+    if (!fwrite(&v->size, sizeof(colSize_t), 1, f)) return 0;
+#        if COL_HOST_LE
+    // Guardar objetos de uma só vez
+    return COL_POD_ESCREVER(COL_DATA(v), v->size, f);
+#        else
+    // Guardar objetos em blocos, convertidos para little-endian
+    COL_TIPO  bloco[256];
+    colSize_t n;
+    for (colSize_t i = 0; i < v->size; i += n) {
+        n = (v->size - i < 256) ? v->size - i : 256;
+        memcpy(bloco, &COL_DATA(v)[i], n * sizeof(COL_TIPO));
+#            ifdef COL_POD_TROCA
+        for (colSize_t j = 0; j < n; j++) { COL_POD_TROCA(&bloco[j]); }
+#            endif
+        if (!COL_POD_ESCREVER(bloco, n, f)) return 0;
+    }
+    return 1;
+#        endif
+}
+
+int COL_FUN(_read)(COL_NOME* const v, FILE* f) {
+    // Ler tamanho de coleção em ficheiro
+    colSize_t size = 0;
+    if (!fread(&size, sizeof(colSize_t), 1, f)) return 0;
+    // Reservar espaço para coleção, um tamanho corrompido não pode dar a volta
+    if (size > COL_INVAL_INDEX - 1 - v->size || !COL_FUN(_reserve)(v, v->size + size)) return 0;
+    // Ler objetos do ficheiro de uma só vez
+    if (!COL_POD_LER(&COL_DATA(v)[v->size], size, f)) return 0;
+#        if !COL_HOST_LE && defined(COL_POD_TROCA)
+    for (colSize_t i = v->size; i < v->size + size; i++) { COL_POD_TROCA(&COL_DATA(v)[i]); }
+#        endif
+    v->size += size;
+    return 1;
+}
+#        undef COL_POD_ESCREVER
+#        undef COL_POD_LER
+#    else
+#        if defined(COL_WRITE) && !defined(COL_SLOTS)
 int COL_FUN(_write)(const COL_NOME* const v, FILE* f) {
     // Gravar tamanho da coleção
     if (!fwrite(&v->size, sizeof(colSize_t), 1, f)) return 0;
     // Guardar objetos
     for (colSize_t i = 0; i < v->size; i++) {
-        if (!COL_WRITE(&(v->data[i]), f)) return 0;
+        if (!COL_WRITE(COL_FUN(_at)(v, i), f)) return 0;
     }
     return 1;
 }
-#    endif
+#        endif
 
-#    ifdef COL_READ
+#        ifdef COL_READ
 int COL_FUN(_read)(COL_NOME* const v, FILE* f) {
     // Ler tamanho de coleção em ficheiro
     colSize_t size = 0;
     if (!fread(&size, sizeof(colSize_t), 1, f)) return 0;
-    // Reservar espaço para coleção
-    if (!COL_FUN(_reserve)(v, size)) return 0;
-    // Ler objetos do ficheiro
+    // Reservar espaço para coleção, um tamanho corrompido não pode dar a volta
+    if (size > COL_INVAL_INDEX - 1 - v->size || !COL_FUN(_reserve)(v, v->size + size)) return 0;
+    // Ler objetos do ficheiro, a seguir aos que já existem
     for (colSize_t i = 0; i < size; i++) {
-        if (!COL_READ(&(v->data[i]), f)) return 0;
+        if (!COL_READ(COL_FUN(_at)(v, v->size), f)) return 0;
         v->size++;
     }
     return 1;
 }
+#        endif
 #    endif
 #endif
 
@@ -268,6 +1309,24 @@ int COL_FUN(_read)(COL_NOME* const v, FILE* f) {
  * @return          Uma coleção vazia.
  */
 COL_NOME COL_FUN(_new)();
+#    ifndef COL_SEGMENTOS
+/**
+ * @brief           Constroi uma coleção que empresta 'size' objetos de 'data'.
+ * @details         A coleção não é dona de 'data' ('alocated' fica a 0), os
+ *                  objetos podem ser editados no local mas são copiados para
+ *                  memória própria na primeira vez que a coleção precisar de
+ *                  crescer. _free não liberta 'data'. Com COL_INLINE, se
+ *                  'size' não for maior que COL_INLINE, os objetos são
+ *                  copiados para dentro da coleção.
+ * @param data      Objetos a emprestar.
+ * @param size      Numero de objetos em 'data'.
+ * @return          Uma coleção com os objetos de 'data'.
+ * @warning         'data' tem que continuar válido enquanto a coleção o
+ *                  emprestar.
+ */
+COL_NOME COL_FUN(_borrow)(COL_TIPO* const data, const colSize_t size);
+#    endif
+#    ifndef COL_SLOTS
 /**
  * @brief           Retorna e remove o último objeto da coleção.
  * @details         Retorna o o último objeto da coleção, removendo-o, mas sem o
@@ -278,6 +1337,7 @@ COL_NOME COL_FUN(_new)();
  *                  terá que ser dealocado posteriormente.
  */
 COL_TIPO COL_FUN(_pop)(COL_NOME* const v);
+#    endif
 /**
  * @brief           Apaga e dealoca a coleção.
  * @details         Dealoca todos os elementos da coleção utilizando o macto
@@ -329,6 +1389,18 @@ int COL_FUN(_reserve)(COL_NOME* const v, colSize_t space);
  * @returns         1 se conseguiu inserir o objeto.
  */
 int COL_FUN(_push)(COL_NOME* const v, COL_TIPO const newObj);
+/**
+ * @brief           Adiciona 'n' objetos no final da coleção, alocando memória
+ *                  no máximo uma vez.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param objs      Objetos a copiar para a coleção.
+ * @param n         Número de objetos em 'objs'.
+ * @returns         0 se não conseguiu inserir os objetos (a coleção não é
+ *                  alterada).
+ * @returns         1 se conseguiu inserir os objetos.
+ */
+int COL_FUN(_pushN)(COL_NOME* const v, COL_TIPO const* const objs, const colSize_t n);
+#    ifndef COL_SLOTS
 /**
  * @brief           Move todos os elementos acima de 'i' um espaço para baixo,
  *                  escrevendo sobre 'i'.
@@ -355,6 +1427,101 @@ void COL_FUN(_moveBelow)(COL_NOME* const v, const colSize_t i);
  *                  válido.
  */
 int COL_FUN(_moveAbove)(COL_NOME* const v, const colSize_t i);
+#        ifndef COL_SEGMENTOS
+/**
+ * @brief           Adiciona todos os objetos de 'outra' no final de 'v' (ver
+ *                  _pushN). Os objetos são copiados sem serem duplicados, por
+ *                  isso só um das coleções os pode dealocar.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param outra     Coleção com os objetos a acrescentar, diferente de 'v'.
+ * @returns         0 se não conseguiu inserir os objetos.
+ * @returns         1 se conseguiu inserir os objetos.
+ */
+int COL_FUN(_extend)(COL_NOME* const v, const COL_NOME* const outra);
+/**
+ * @brief           Insere 'n' objetos a partir do index 'i', movendo os
+ *                  objetos seguintes uma só vez.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param i         Index do primeiro objeto inserido, no máximo 'size'.
+ * @param objs      Objetos a copiar para a coleção.
+ * @param n         Número de objetos em 'objs'.
+ * @returns         0 se não conseguiu inserir os objetos (a coleção não é
+ *                  alterada).
+ * @returns         1 se conseguiu inserir os objetos.
+ */
+int COL_FUN(_insertRange)(COL_NOME* const v, const colSize_t i, COL_TIPO const* const objs, const colSize_t n);
+#        endif
+/**
+ * @brief           Remove, numa só passagem, todos os objetos para os quais
+ *                  'predicate' retorna verdade, dealocando-os com 'COL_DEALOC'.
+ * @details         Os objetos que ficam mantêm a sua ordem e são movidos no
+ *                  máximo uma vez, ao contrário de chamar _moveBelow por cada
+ *                  objeto removido.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param predicate Função chamada uma vez com cada objeto, pela ordem da
+ *                  coleção.
+ * @param userData  Dados passados à função 'predicate'.
+ * @returns         O número de objetos removidos.
+ * @warning         Os index dos objetos seguintes a um objeto removido mudam.
+ */
+colSize_t COL_FUN(_removeIf)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData);
+#    else
+/**
+ * @brief           Insere um objeto num slot livre, ou num slot novo no final
+ *                  da coleção se não houver slots livres.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param newObj    Objeto para inserir.
+ * @returns         O handle do objeto, COL_SLOT_INDEX(handle) é o seu slot.
+ * @returns         COL_INVAL_INDEX se não conseguiu inserir o objeto.
+ */
+colSize_t COL_FUN(_inserir)(COL_NOME* const v, COL_TIPO const newObj);
+/**
+ * @brief           Insere um objeto no slot 'i', que tem que estar livre ou
+ *                  ser o slot seguinte ao último (i igual a 'size').
+ * @details         Serve para repetir um _inserir cujo slot é conhecido, por
+ *                  exemplo ao reproduzir o diário. Se 'i' não for o primeiro
+ *                  slot da lista de livres a lista é percorrida até 'i'.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ * @param i         Slot onde inserir.
+ * @param newObj    Objeto para inserir.
+ * @returns         O handle do objeto.
+ * @returns         COL_INVAL_INDEX se o slot não está livre ou se não
+ *                  conseguiu inserir o objeto.
+ */
+colSize_t COL_FUN(_ocupar)(COL_NOME* const v, const colSize_t i, COL_TIPO const newObj);
+/**
+ * @brief           Remove o objeto referido por 'h' em O(1), libertando o seu
+ *                  slot.
+ * @details         Os outros objetos não são movidos, os seus handles
+ *                  continuam válidos. A geração do slot avança, de modo a que
+ *                  'h' (e qualquer cópia de 'h') deixe de ser válido.
+ * @param v         Ponteiro da coleção sob o qual operar.
+ * @param h         Handle do objeto a remover.
+ * @returns         0 se 'h' não é válido ou se não conseguiu alocar memória.
+ * @returns         1 se removeu o objeto.
+ * @warning         O objeto não é dealocado por esta função e o seu slot é
+ *                  escrito por cima, tem que ser dealocado antes.
+ */
+int COL_FUN(_remover)(COL_NOME* const v, const colSize_t h);
+/**
+ * @brief           Define a geração do slot 'i', ao carregar uma coleção que
+ *                  foi gravada com as gerações dos seus slots.
+ * @details         Os slots livres só voltam a ser reutilizados depois de
+ *                  chamar _refazerLivres.
+ * @param v         Ponteiro da coleção sob o qual operar.
+ * @param i         Slot, menor que 'size'.
+ * @param geracao   Geração do slot.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 caso contrário.
+ */
+int COL_FUN(_definirGeracao)(COL_NOME* const v, const colSize_t i, const uint8_t geracao);
+/**
+ * @brief           Reconstrói a lista de slots livres a partir das gerações
+ *                  dos slots. O conteúdo dos slots livres é escrito por cima.
+ * @param v         Ponteiro da coleção sob o qual operar.
+ */
+void COL_FUN(_refazerLivres)(COL_NOME* const v);
+#    endif
 /**
  * @brief           Aplica a função 'predicate' a todos os elementos da coleção
  *                  'v', do menor ao maior index.
@@ -380,12 +1547,133 @@ colSize_t COL_FUN(_iterateFW)(COL_NOME* const v, COL_FUN(_pred_t) predicate, voi
  * @param X         O parametro X do macro 'COL_DEALOC'.
  */
 void COL_FUN(_DEALOC)(COL_TIPO* const X);
-#    ifdef COL_WRITE
+/**
+ * @brief           Retorna o index de um objeto da coleção a partir do seu
+ *                  endereço.
+ * @details         Com COL_SEGMENTOS os segmentos são percorridos até
+ *                  encontrar o que contém 'obj', O(alocated / COL_SEGMENTO).
+ * @param v         Coleção.
+ * @param obj       Ponteiro para um objeto da coleção.
+ * @returns         O index do objeto.
+ * @returns         COL_INVAL_INDEX se 'obj' não é um objeto da coleção.
+ */
+colSize_t COL_FUN(_indice)(const COL_NOME* const v, COL_TIPO const* const obj);
+#    ifdef COL_CMP
+/**
+ * @brief           Ordena a coleção segundo COL_CMP.
+ * @details         Introsort no próprio array: O(n log n) no pior caso, sem
+ *                  memória adicional e com COL_CMP expandido no código (sem
+ *                  chamadas por ponteiro, ao contrário de qsort). A ordem de
+ *                  objetos equivalentes não é mantida.
+ * @param v         Ponteiro para a coleção sob o qual operar.
+ */
+void COL_FUN(_sort)(COL_NOME* const v);
+/**
+ * @brief           Pesquisa binária do primeiro objeto que não vem antes de
+ *                  'chave'.
+ * @param v         Coleção ordenada.
+ * @param chave     Objeto a comparar, só os campos usados por COL_CMP
+ *                  interessam.
+ * @returns         O index do objeto, ou 'size' se todos vêm antes de
+ *                  'chave'.
+ */
+colSize_t COL_FUN(_lowerBound)(const COL_NOME* const v, const COL_TIPO* const chave);
+/**
+ * @brief           Pesquisa binária do primeiro objeto que vem depois de
+ *                  'chave'.
+ * @param v         Coleção ordenada.
+ * @param chave     Objeto a comparar.
+ * @returns         O index do objeto, ou 'size' se nenhum vem depois de
+ *                  'chave'.
+ */
+colSize_t COL_FUN(_upperBound)(const COL_NOME* const v, const COL_TIPO* const chave);
+/**
+ * @brief           Pesquisa binária de um objeto equivalente a 'chave'.
+ * @param v         Coleção ordenada.
+ * @param chave     Objeto a procurar.
+ * @returns         O index do primeiro objeto equivalente a 'chave'.
+ * @returns         COL_INVAL_INDEX se não existe.
+ */
+colSize_t COL_FUN(_findEq)(const COL_NOME* const v, const COL_TIPO* const chave);
+/**
+ * @brief           Insere um objeto na sua posição, depois dos objetos
+ *                  equivalentes, mantendo a coleção ordenada.
+ * @param v         Coleção ordenada.
+ * @param newObj    Objeto a inserir.
+ * @returns         O index onde o objeto foi inserido.
+ * @returns         COL_INVAL_INDEX se não conseguiu alocar memória.
+ * @warning         Os objetos depois do index são movidos (_moveAbove), para
+ *                  inserir muitos objetos é melhor usar _push e _sort.
+ */
+colSize_t COL_FUN(_insertSorted)(COL_NOME* const v, COL_TIPO const newObj);
+/**
+ * @brief           Igual a _iterateFW, mas só para os objetos entre 'de'
+ *                  (inclusive) e 'ate' (exclusive), encontrados por pesquisa
+ *                  binária.
+ * @param v         Coleção ordenada.
+ * @param de        Primeiro objeto a visitar é o primeiro que não vem antes
+ *                  de 'de'. NULL para começar no início.
+ * @param ate       A iteração pára no primeiro objeto que não vem antes de
+ *                  'ate'. NULL para ir até ao fim.
+ * @param predicate Função chamada com cada objeto, ver _iterateFW.
+ * @param userData  Dados passados à função 'predicate'.
+ * @returns         O index do objeto cuja função predicate primeiro retornou
+ *                  verdade.
+ * @returns         COL_INVAL_INDEX caso contrário.
+ */
+colSize_t COL_FUN(_iterateRange)(COL_NOME* const v, const COL_TIPO* const de, const COL_TIPO* const ate,
+                                 COL_FUN(_pred_t) predicate, void* userData);
+#    endif
+#    ifdef COL_PARALELO
+/**
+ * @brief           Chama 'predicate' com cada objeto da coleção, dividindo a
+ *                  coleção em partes contíguas percorridas em threads
+ *                  diferentes.
+ * @details         Ao contrário de _iterateFW, o valor retornado por
+ *                  'predicate' é ignorado e a ordem pela qual os objetos são
+ *                  visitados não é definida. 'predicate' pode ser chamada ao
+ *                  mesmo tempo em várias threads, por isso só pode alterar o
+ *                  objeto que recebe ou dados protegidos por ela.
+ * @param v         Coleção, que não pode ser alterada durante a chamada.
+ * @param predicate Função chamada com cada objeto.
+ * @param userData  Dados passados à função 'predicate'.
+ * @param nthreads  Número máximo de threads, 0 para o número definido por
+ *                  paralelo_definirThreads.
+ */
+void COL_FUN(_parallelForEach)(COL_NOME* const v, COL_FUN(_pred_t) predicate, void* userData, int nthreads);
+/**
+ * @brief           Reduz a coleção a um valor, dividindo-a em partes contíguas
+ *                  percorridas em threads diferentes.
+ * @details         Cada parte começa com uma cópia de 'identidade', a que 'map'
+ *                  acrescenta cada objeto da parte. No fim, os acumuladores
+ *                  das partes são juntos a 'resultado' com 'combine', pela
+ *                  ordem das partes e na thread que chamou. 'resultado' não é
+ *                  inicializado, o que permite acumular várias reduções no
+ *                  mesmo resultado.
+ * @param v         Coleção, que não pode ser alterada durante a chamada.
+ * @param map       Acrescenta um objeto a um acumulador.
+ * @param combine   Junta um acumulador parcial a outro.
+ * @param identidade
+ *                  Acumulador vazio, com 'tamanho' bytes.
+ * @param tamanho   Bytes de um acumulador.
+ * @param resultado Acumulador onde juntar o resultado.
+ * @param userData  Dados passados a 'map' e a 'combine'.
+ * @param nthreads  Número máximo de threads, 0 para o número definido por
+ *                  paralelo_definirThreads.
+ * @returns         0 se não conseguiu alocar os acumuladores.
+ * @returns         1 caso contrário.
+ */
+int COL_FUN(_parallelReduce)(const COL_NOME* const v, COL_FUN(_map_t) map, COL_FUN(_combine_t) combine,
+                             const void* const identidade, const size_t tamanho, void* const resultado,
+                             void* userData, int nthreads);
+#    endif
+#    if defined(COL_WRITE) && !defined(COL_SLOTS)
 /**
  * @brief           Escreve num ficheiro utilizando o macro 'COL_WRITE'.
  * @details         Escreve um número de 64 bits a indicar o tamanho da coleção
  *                  e de seguida escreve, um a um, utilizando o macro
- *                  'COL_WRITE' os objetos da coleção.
+ *                  'COL_WRITE' os objetos da coleção. Com COL_POD os objetos
+ *                  são escritos todos de uma vez.
  * @param v         Ponteiro para a coleção sob o qual queremos operar.
  * @param f         Ficheiro onde escrever os conteudos da coleção.
  * @returns         1 se escreveu a coleção com sucesso.
@@ -398,7 +1686,9 @@ int COL_FUN(_write)(const COL_NOME* const v, FILE* f);
  * @brief           Lê de num ficheiro utilizando o macro 'COL_READ'.
  * @details         Lê um número de 64 bits a indicar o tamanho da coleção e
  *                  de seguida lê, um a um, utilizando o macro 'COL_READ' os
- *                  objetos da coleção. Aloca espaço, se necessário.
+ *                  objetos da coleção, que são acrescentados aos que já
+ *                  existem. Aloca espaço, se necessário. Com COL_POD os
+ *                  objetos são lidos todos de uma vez.
  * @param v         Ponteiro para a coleção sob o qual queremos operar.
  * @param f         Ficheiro onde ler os conteudos da coleção.
  * @returns         1 se leu a coleção com sucesso.
@@ -413,4 +1703,19 @@ int COL_FUN(_read)(COL_NOME* const v, FILE* f);
 #undef COL_DEALOC
 #undef COL_READ
 #undef COL_WRITE
-#undef COL_PRE
\ No newline at end of file
+#undef COL_POD
+#undef COL_POD_TROCA
+#undef COL_COMPRIMIR
+#undef COL_PRE
+#undef COL_ALLOC
+#undef COL_REALLOC
+#undef COL_FREE
+#undef COL_INLINE
+#undef COL_SLOTS
+#undef COL_CMP
+#undef COL_PARALELO
+#undef COL_SEGMENTOS
+#undef COL_SEGMENTO_BITS
+#undef COL_DATA
+#undef COL_HEAP
+#undef COL_PROPRIO
\ No newline at end of file
@@ -14,7 +14,7 @@
  * @brief   Inicializador para compras.
  * @returns Uma compra válida.
  */
-compra new_compra() { return (compra) {.IDartigo = 0}; }
+compra new_compra() { return (compra) {.IDartigo = 0, .iva = COMPRA_SEM_PRECO}; }
 
 /**
  * @brief      Salva compra em ficheiro.
@@ -43,5 +43,57 @@ int load_compra(FILE* const f, compra* const data) {
     written += fread(&data->IDartigo, sizeof(colSize_t), 1, f);
     written += fread(&data->qtd, sizeof(int64_t), 1, f);
     written += fread(&data->receita, 19, 1, f);
+    // O formato antigo não tem o preço de venda
+    data->preco_cent = 0;
+    data->iva        = COMPRA_SEM_PRECO;
     return written == 3;
 }
+
+/**
+ * @brief   Troca a ordem dos bytes de um inteiro de 64 bits.
+ * @param q Inteiro a converter.
+ * @returns O inteiro com os bytes pela ordem inversa.
+ */
+static uint64_t compra_trocar64(const uint64_t q) {
+    return ((q & 0x00000000000000FFull) << 56) | ((q & 0x000000000000FF00ull) << 40) |
+        ((q & 0x0000000000FF0000ull) << 24) | ((q & 0x00000000FF000000ull) << 8) | ((q & 0x000000FF00000000ull) >> 8) |
+        ((q & 0x0000FF0000000000ull) >> 24) | ((q & 0x00FF000000000000ull) >> 40) | ((q & 0xFF00000000000000ull) >> 56);
+}
+
+/**
+ * @brief   Troca a ordem dos bytes dos inteiros de uma compra, para converter
+ *          de e para a disposição little-endian em ficheiro.
+ * @param c Compra a converter.
+ */
+void compra_trocarBytes(compra* const c) {
+    const uint32_t a = c->IDartigo;
+    c->IDartigo   = ((a & 0x000000FFu) << 24) | ((a & 0x0000FF00u) << 8) | ((a & 0x00FF0000u) >> 8) |
+        ((a & 0xFF000000u) >> 24);
+    c->qtd        = (int64_t) compra_trocar64((uint64_t) c->qtd);
+    c->preco_cent = (int64_t) compra_trocar64((uint64_t) c->preco_cent);
+}
+
+/**
+ * @brief   Regista na compra o preço e a taxa de IVA atuais do artigo, tem
+ *          que ser chamada quando a compra é vendida.
+ * @param c Compra.
+ * @param a Artigo vendido na compra.
+ */
+void compra_registarPreco(compra* const c, const artigo* const a) {
+    c->preco_cent = a->preco_cent;
+    c->iva        = a->meta & ARTIGO_IVA;
+}
+
+/**
+ * @brief   Calcula o preço unitário com IVA de uma compra, com o preço do
+ *          momento da venda se foi registado ou, se não foi, com o preço
+ *          atual do artigo.
+ * @param c Compra.
+ * @param a Artigo atual da compra, ou NULL se foi removido.
+ * @returns O preço com IVA, 0 se o preço não foi registado e o artigo foi
+ *          removido.
+ */
+int64_t compra_precoUnitario(const compra* const c, const artigo* const a) {
+    if (compra_temPreco(c)) return compra_precoIVA(c);
+    return a ? artigo_precoIVA(a) : 0;
+}
@@ -13,22 +13,64 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include "artigo.h"
 #include "utilities.h"
 #define COL_PRE
 #include "colecao.h"
 
+/**
+ * @def COMPRA_SEM_PRECO
+ *          Valor de 'iva' numa compra cujo preço de venda não foi registado
+ *          (compras gravadas antes de o preço ser registado), que é então
+ *          calculado com o preço atual do artigo.
+ */
+#define COMPRA_SEM_PRECO ((uint8_t) 0xFF)
+
 // https://www.infarmed.pt/documents/15786/17838/Normas_Prescri%C3%A7%C3%A3o/bcd0b378-3b00-4ee0-9104-28d0db0b7872
 /**
- * @brief Uma compra representa um conjunto do mesmo artigo a ser vendido.
+ * @brief   Uma compra representa um conjunto do mesmo artigo a ser vendido.
+ * @details A disposição em memória é também a disposição em ficheiro (ver
+ *          COL_POD em colecao.h): 40 bytes, sem padding implícito, com os
+ *          inteiros em little-endian. O preço e a taxa de IVA são os do
+ *          artigo no momento da venda, por isso o preço da compra não depende
+ *          do artigo atual.
  */
 typedef struct {
-    colSize_t IDartigo;    //< ID do artigo
     int64_t   qtd;         //< Quantidade de artigos encomendados
+    int64_t   preco_cent;  //< Preço base do artigo em cêntimos, no momento da venda
+    colSize_t IDartigo;    //< Handle do artigo (COL_SLOT_HANDLE)
     char      receita[19]; //< Receita do artigo
+    uint8_t   iva;         //< 'meta & ARTIGO_IVA' do artigo no momento da venda, ou COMPRA_SEM_PRECO
 } compra;
 
-int    save_compra(FILE* const f, const compra* const data);
-int    load_compra(FILE* const f, compra* const data);
-compra new_compra();
+_Static_assert(sizeof(compra) == 40, "compra deve ter 40 bytes sem padding implícito");
+
+int     save_compra(FILE* const f, const compra* const data);
+int     load_compra(FILE* const f, compra* const data);
+compra  new_compra();
+void    compra_trocarBytes(compra* const c);
+void    compra_registarPreco(compra* const c, const artigo* const a);
+int64_t compra_precoUnitario(const compra* const c, const artigo* const a);
+
+/**
+ * @brief   Verifica se o preço de venda da compra foi registado.
+ * @param c Compra.
+ * @returns 1 se a compra tem o preço e a taxa de IVA do momento da venda, 0
+ *          caso contrário.
+ */
+static inline int compra_temPreco(const compra* const c) { return c->iva != COMPRA_SEM_PRECO; }
+
+/**
+ * @brief   Calcula o preço unitário com IVA de uma compra, com o preço do
+ *          momento da venda.
+ * @details Numa compra sem o preço registado a taxa é 0 (COMPRA_SEM_PRECO &
+ *          ARTIGO_IVA), por isso pode ser calculado sem verificar primeiro
+ *          compra_temPreco.
+ * @param c Compra com o preço registado (compra_temPreco).
+ * @returns O preço com IVA, truncado ao cêntimo (ver artigo_precoIVA).
+ */
+static inline int64_t compra_precoIVA(const compra* const c) {
+    return c->preco_cent * (100 + artigo_ivaPercentagem[c->iva & ARTIGO_IVA]) / 100;
+}
 
 #endif
\ No newline at end of file
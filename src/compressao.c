@@ -0,0 +1,299 @@
+/**
+ * @file    compressao.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Compressor por blocos independentes, do tipo LZ77, sem dependências
+ *          externas.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#include "compressao.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @def COMPRESSAO_HASH_BITS
+ *          Número de bits do hash usado para procurar cópias.
+ */
+#define COMPRESSAO_HASH_BITS 12
+
+static uint8_t compressao_buf[sizeof(compressao_bloco) + COMPRESSAO_LIMITE(COMPRESSAO_BLOCO)]; ///< Bloco atual
+
+
+
+
+// Blocos
+// *********************************************************************************************************************
+/**
+ * @brief     Escreve um tamanho em bytes de 255 seguidos do resto.
+ * @param dst Onde escrever.
+ * @param o   Posição em 'dst'.
+ * @param n   Tamanho a escrever.
+ * @returns   A posição em 'dst' depois do tamanho.
+ */
+static size_t compressao_escreverTam(uint8_t* const dst, size_t o, size_t n) {
+    while (n >= 255) {
+        dst[o++] = 255;
+        n -= 255;
+    }
+    dst[o++] = (uint8_t) n;
+    return o;
+}
+
+/**
+ * @brief     Lê um tamanho escrito por compressao_escreverTam.
+ * @param src Bloco comprimido.
+ * @param tam Tamanho de 'src'.
+ * @param i   Posição em 'src', é atualizada.
+ * @param n   Tamanho a que somar o tamanho lido.
+ * @returns   0 se o bloco acabou antes do tamanho.
+ * @returns   1 caso contrário.
+ */
+static int compressao_lerTam(const uint8_t* const src, const size_t tam, size_t* const i, size_t* const n) {
+    uint8_t b;
+    do {
+        if (*i >= tam) return 0;
+        b = src[(*i)++];
+        *n += b;
+    } while (b == 255);
+    return 1;
+}
+
+/**
+ * @brief       Escreve uma sequência (literais e, opcionalmente, uma cópia).
+ * @param dst   Onde escrever.
+ * @param o     Posição em 'dst'.
+ * @param lit   Literais.
+ * @param n_lit Número de literais.
+ * @param dist  Distância da cópia, 0 se a sequência não tem cópia.
+ * @param len   Tamanho da cópia.
+ * @returns     A posição em 'dst' depois da sequência.
+ */
+static size_t compressao_sequencia(uint8_t* const dst, size_t o, const uint8_t* const lit, const size_t n_lit,
+                                   const size_t dist, const size_t len) {
+    const size_t t = o++;
+    dst[t]         = (uint8_t) ((n_lit >= 15 ? 15 : n_lit) << 4);
+    if (n_lit >= 15) o = compressao_escreverTam(dst, o, n_lit - 15);
+    memcpy(dst + o, lit, n_lit);
+    o += n_lit;
+    if (!dist) return o;
+    dst[o++]       = (uint8_t) (dist & 0xFF);
+    dst[o++]       = (uint8_t) (dist >> 8);
+    const size_t m = len - COMPRESSAO_MIN;
+    dst[t] |= (uint8_t) (m >= 15 ? 15 : m);
+    if (m >= 15) o = compressao_escreverTam(dst, o, m - 15);
+    return o;
+}
+
+/**
+ * @brief     Comprime um bloco.
+ * @param src Bytes a comprimir.
+ * @param tam Número de bytes, no máximo COMPRESSAO_BLOCO.
+ * @param dst Onde escrever o bloco comprimido, com pelo menos
+ *            COMPRESSAO_LIMITE(tam) bytes.
+ * @returns   O tamanho do bloco comprimido.
+ */
+size_t compressao_comprimir(const uint8_t* const src, const size_t tam, uint8_t* const dst) {
+    int32_t tabela[1 << COMPRESSAO_HASH_BITS];
+    memset(tabela, 0xFF, sizeof(tabela));
+
+    size_t i = 0, ancora = 0, o = 0;
+    while (i + COMPRESSAO_MIN <= tam) {
+        uint32_t v;
+        memcpy(&v, src + i, sizeof(v));
+        const uint32_t h    = (v * 2654435761u) >> (32 - COMPRESSAO_HASH_BITS);
+        const int32_t  cand = tabela[h];
+        tabela[h]           = (int32_t) i;
+        if (cand < 0 || i - cand > 0xFFFF || memcmp(src + cand, src + i, COMPRESSAO_MIN)) {
+            i++;
+            continue;
+        }
+        size_t len = COMPRESSAO_MIN;
+        while (i + len < tam && src[cand + len] == src[i + len]) len++;
+        o = compressao_sequencia(dst, o, src + ancora, i - ancora, i - cand, len);
+        i += len;
+        ancora = i;
+    }
+    return compressao_sequencia(dst, o, src + ancora, tam - ancora, 0, 0);
+}
+
+/**
+ * @brief         Descomprime um bloco.
+ * @param src     Bloco comprimido.
+ * @param tam     Tamanho de 'src'.
+ * @param dst     Onde escrever os bytes descomprimidos.
+ * @param tam_dst Número de bytes que o bloco deve ter depois de descomprimido.
+ * @returns       0 se o bloco é inválido.
+ * @returns       1 caso contrário.
+ */
+int compressao_descomprimir(const uint8_t* const src, const size_t tam, uint8_t* const dst, const size_t tam_dst) {
+    size_t i = 0, o = 0;
+    while (i < tam) {
+        const uint8_t token = src[i++];
+        size_t        n_lit = token >> 4;
+        if (n_lit == 15 && !compressao_lerTam(src, tam, &i, &n_lit)) return 0;
+        if (n_lit > tam - i || n_lit > tam_dst - o) return 0;
+        memcpy(dst + o, src + i, n_lit);
+        i += n_lit;
+        o += n_lit;
+
+        // A última sequência não tem cópia
+        if (i == tam) break;
+        if (tam - i < 2) return 0;
+        const size_t dist = src[i] | (size_t) src[i + 1] << 8;
+        size_t       len  = token & 15;
+        i += 2;
+        if (len == 15 && !compressao_lerTam(src, tam, &i, &len)) return 0;
+        len += COMPRESSAO_MIN;
+        if (dist == 0 || dist > o || len > tam_dst - o) return 0;
+        const uint8_t* m = dst + o - dist;
+        if (dist >= len) {
+            memcpy(dst + o, m, len);
+            o += len;
+        } else {
+            // A cópia sobrepõe-se aos bytes que está a escrever
+            for (size_t k = 0; k < len; k++) dst[o++] = m[k];
+        }
+    }
+    return o == tam_dst;
+}
+
+/**
+ * @brief     Escreve um inteiro de 32 bits em little-endian.
+ * @param dst Onde escrever.
+ * @param v   Valor a escrever.
+ */
+static void compressao_escreverU32(uint8_t* const dst, const uint32_t v) {
+    dst[0] = (uint8_t) v;
+    dst[1] = (uint8_t) (v >> 8);
+    dst[2] = (uint8_t) (v >> 16);
+    dst[3] = (uint8_t) (v >> 24);
+}
+
+/**
+ * @brief     Lê um inteiro de 32 bits em little-endian.
+ * @param src Onde ler.
+ * @returns   O valor lido.
+ */
+static uint32_t compressao_lerU32(const uint8_t* const src) {
+    return src[0] | (uint32_t) src[1] << 8 | (uint32_t) src[2] << 16 | (uint32_t) src[3] << 24;
+}
+
+/**
+ * @brief     Lê o cabeçalho do bloco no início de 'src'.
+ * @param src Blocos.
+ * @param tam Tamanho de 'src'.
+ * @param b   Onde escrever o cabeçalho.
+ * @returns   0 se 'src' não tem o cabeçalho e o bloco completos.
+ * @returns   1 caso contrário.
+ */
+int compressao_lerCabecalho(const uint8_t* const src, const size_t tam, compressao_bloco* const b) {
+    if (tam < sizeof(compressao_bloco)) return 0;
+    b->tam            = compressao_lerU32(src + offsetof(compressao_bloco, tam));
+    b->tam_comprimido = compressao_lerU32(src + offsetof(compressao_bloco, tam_comprimido));
+    return b->tam <= COMPRESSAO_BLOCO && b->tam_comprimido <= b->tam &&
+           b->tam_comprimido <= tam - sizeof(compressao_bloco);
+}
+
+/**
+ * @brief     Comprime um bloco e escreve-o precedido do seu cabeçalho. Se a
+ *            compressão não reduzir o tamanho, o bloco é copiado sem
+ *            compressão.
+ * @param src Bytes a comprimir.
+ * @param tam Número de bytes, no máximo COMPRESSAO_BLOCO.
+ * @param dst Onde escrever, com pelo menos sizeof(compressao_bloco) +
+ *            COMPRESSAO_LIMITE(tam) bytes.
+ * @returns   O número de bytes escritos em 'dst'.
+ */
+size_t compressao_comprimirBloco(const uint8_t* const src, const size_t tam, uint8_t* const dst) {
+    uint8_t* const corpo = dst + sizeof(compressao_bloco);
+    size_t         n     = compressao_comprimir(src, tam, corpo);
+    if (n >= tam) {
+        memcpy(corpo, src, tam);
+        n = tam;
+    }
+    compressao_escreverU32(dst + offsetof(compressao_bloco, tam), (uint32_t) tam);
+    compressao_escreverU32(dst + offsetof(compressao_bloco, tam_comprimido), (uint32_t) n);
+    return sizeof(compressao_bloco) + n;
+}
+
+/**
+ * @brief         Descomprime uma sequência de blocos escritos por
+ *                compressao_comprimirBloco.
+ * @param src     Blocos, cada um precedido do seu cabeçalho.
+ * @param tam     Tamanho de 'src'.
+ * @param dst     Onde escrever os bytes descomprimidos.
+ * @param tam_dst Número total de bytes depois de descomprimidos.
+ * @returns       0 se algum bloco é inválido.
+ * @returns       1 caso contrário.
+ */
+int compressao_descomprimirBlocos(const uint8_t* const src, const size_t tam, uint8_t* const dst,
+                                  const size_t tam_dst) {
+    size_t i = 0, o = 0;
+    while (i < tam) {
+        if (tam - i < sizeof(compressao_bloco)) return 0;
+        const uint32_t b_tam  = compressao_lerU32(src + i + offsetof(compressao_bloco, tam));
+        const uint32_t b_comp = compressao_lerU32(src + i + offsetof(compressao_bloco, tam_comprimido));
+        i += sizeof(compressao_bloco);
+        if (b_tam > COMPRESSAO_BLOCO || b_tam > tam_dst - o || b_comp > b_tam || b_comp > tam - i) return 0;
+        if (b_comp == b_tam) {
+            memcpy(dst + o, src + i, b_tam);
+        } else if (!compressao_descomprimir(src + i, b_comp, dst + o, b_tam))
+            return 0;
+        i += b_comp;
+        o += b_tam;
+    }
+    return o == tam_dst;
+}
+
+
+
+
+// Ficheiros
+// *********************************************************************************************************************
+/**
+ * @brief      Comprime 'tam' bytes e escreve-os em blocos num ficheiro.
+ * @param f    Ficheiro onde escrever.
+ * @param data Bytes a escrever.
+ * @param tam  Número de bytes.
+ * @returns    0 se falhou a escrever.
+ * @returns    1 caso contrário.
+ */
+int compressao_escrever(FILE* const f, const void* const data, const size_t tam) {
+    const uint8_t* const src = data;
+    for (size_t i = 0; i < tam; i += COMPRESSAO_BLOCO) {
+        const size_t n = (tam - i < COMPRESSAO_BLOCO) ? tam - i : COMPRESSAO_BLOCO;
+        const size_t b = compressao_comprimirBloco(src + i, n, compressao_buf);
+        if (!fwrite(compressao_buf, b, 1, f)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief      Lê de um ficheiro os blocos necessários para obter 'tam' bytes
+ *             descomprimidos.
+ * @param f    Ficheiro onde ler.
+ * @param data Onde escrever os bytes descomprimidos.
+ * @param tam  Número de bytes.
+ * @returns    0 se falhou a ler ou algum bloco é inválido.
+ * @returns    1 caso contrário.
+ */
+int compressao_ler(FILE* const f, void* const data, const size_t tam) {
+    uint8_t* const dst = data;
+    size_t         o   = 0;
+    while (o < tam) {
+        if (!fread(compressao_buf, sizeof(compressao_bloco), 1, f)) return 0;
+        const uint32_t b_comp = compressao_lerU32(compressao_buf + offsetof(compressao_bloco, tam_comprimido));
+        if (b_comp > COMPRESSAO_BLOCO) return 0;
+        if (b_comp && !fread(compressao_buf + sizeof(compressao_bloco), b_comp, 1, f)) return 0;
+        const uint32_t b_tam = compressao_lerU32(compressao_buf + offsetof(compressao_bloco, tam));
+        if (b_tam > tam - o) return 0;
+        if (!compressao_descomprimirBlocos(compressao_buf, sizeof(compressao_bloco) + b_comp, dst + o, b_tam))
+            return 0;
+        o += b_tam;
+    }
+    return 1;
+}
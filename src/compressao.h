@@ -0,0 +1,63 @@
+/**
+ * @file    compressao.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Compressor por blocos independentes, do tipo LZ77, sem dependências
+ *          externas.
+ * @details Os dados são divididos em blocos de até COMPRESSAO_BLOCO bytes e
+ *          cada bloco é gravado como um compressao_bloco seguido do bloco
+ *          comprimido. Como nenhum bloco depende dos anteriores, os blocos
+ *          podem ser descomprimidos em paralelo ou à medida que são lidos.
+ *
+ *          Os cabeçalhos dos blocos são gravados em little-endian.
+ *
+ *          Um bloco comprimido é uma sequência de:
+ *          - um byte 'token', com o número de literais nos 4 bits mais altos e
+ *            o tamanho da cópia menos COMPRESSAO_MIN nos 4 bits mais baixos
+ *            (15 indica que o tamanho continua em bytes seguintes, somados até
+ *            um byte diferente de 255);
+ *          - os literais;
+ *          - a distância da cópia (2 bytes little-endian), omitida na última
+ *            sequência do bloco.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef COMPRESSAO_H
+#define COMPRESSAO_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @def COMPRESSAO_BLOCO
+ *          Tamanho máximo de um bloco antes de ser comprimido.
+ * @def COMPRESSAO_MIN
+ *          Tamanho mínimo de uma cópia.
+ * @def COMPRESSAO_LIMITE(N)
+ *          Tamanho máximo de um bloco de N bytes depois de comprimido.
+ */
+#define COMPRESSAO_BLOCO (64 * 1024)
+#define COMPRESSAO_MIN 4
+#define COMPRESSAO_LIMITE(N) ((N) + (N) / 255 + 16)
+
+/**
+ * @brief   Cabeçalho de um bloco. Se 'tam_comprimido' for igual a 'tam' o
+ *          bloco está gravado sem compressão.
+ */
+typedef struct {
+    uint32_t tam;            ///< Tamanho do bloco descomprimido
+    uint32_t tam_comprimido; ///< Bytes que seguem o cabeçalho
+} compressao_bloco;
+
+size_t compressao_comprimir(const uint8_t* const src, const size_t tam, uint8_t* const dst);
+int    compressao_descomprimir(const uint8_t* const src, const size_t tam, uint8_t* const dst, const size_t tam_dst);
+size_t compressao_comprimirBloco(const uint8_t* const src, const size_t tam, uint8_t* const dst);
+int    compressao_lerCabecalho(const uint8_t* const src, const size_t tam, compressao_bloco* const b);
+int    compressao_descomprimirBlocos(const uint8_t* const src, const size_t tam, uint8_t* const dst,
+                                     const size_t tam_dst);
+int    compressao_escrever(FILE* const f, const void* const data, const size_t tam);
+int    compressao_ler(FILE* const f, void* const data, const size_t tam);
+
+#endif
@@ -0,0 +1,598 @@
+/**
+ * @file    diario.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Diário onde cada alteração às coleções é acrescentada como um
+ *          registo binário, de modo a que gravar custe o tamanho da alteração
+ *          e não o tamanho de todos os dados.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "diario.h"
+
+#ifdef _WIN32
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif
+
+#include "menu.h"
+#include "utilities.h"
+
+static FILE*    diario_ficheiro     = NULL; ///< Diário aberto para acrescentar registos
+static uint64_t diario_geracaoAtual = 0;    ///< Geração sobre a qual o diário é aplicado
+static uint64_t diario_tam          = 0;    ///< Tamanho do diário em bytes
+static unsigned diario_adiados      = 0;    ///< Secções com registos ainda por aplicar (bit 1 << tipo)
+static int      diario_encomendas   = 0;    ///< Se diario_reproduzir encontrou alterações a encomendas
+static int      diario_artigos      = 0;    ///< Se diario_reproduzir encontrou alterações a artigos
+
+static uint8_t* diario_buf      = NULL; ///< Objeto do registo atual
+static size_t   diario_bufTam   = 0;    ///< Bytes usados em diario_buf
+static size_t   diario_bufAloc  = 0;    ///< Bytes alocados em diario_buf
+static size_t   diario_bufLidos = 0;    ///< Bytes já lidos de diario_buf
+
+
+
+
+// Objetos
+// *********************************************************************************************************************
+/**
+ * @brief      Acrescenta 'size' bytes ao objeto do registo atual.
+ * @param data Bytes a acrescentar.
+ * @param size Número de bytes.
+ */
+static void diario_escrever(const void* const data, const size_t size) {
+    if (diario_bufTam + size > diario_bufAloc) {
+        size_t novo = diario_bufAloc ? diario_bufAloc : 64;
+        while (novo < diario_bufTam + size) novo *= 2;
+        protectVarFcnCall(diario_buf, realloc(diario_buf, novo), "alocação de memória recusada");
+        diario_bufAloc = novo;
+    }
+    memcpy(diario_buf + diario_bufTam, data, size);
+    diario_bufTam += size;
+}
+
+/**
+ * @brief   Acrescenta uma string ao objeto do registo atual, no mesmo formato
+ *          que save_str.
+ * @param s String a acrescentar.
+ */
+static void diario_escreverStr(const char* const s) {
+    const uint32_t size = s ? strlen(s) : 0;
+    diario_escrever(&size, sizeof(size));
+    if (size) diario_escrever(s, size);
+}
+
+/**
+ * @brief      Lê 'size' bytes do objeto do registo atual.
+ * @param data Onde guardar os bytes lidos.
+ * @param size Número de bytes.
+ * @returns    0 se o objeto não tinha bytes suficientes.
+ * @returns    1 caso contrário.
+ */
+static int diario_ler(void* const data, const size_t size) {
+    if (size > diario_bufTam - diario_bufLidos) return 0;
+    memcpy(data, diario_buf + diario_bufLidos, size);
+    diario_bufLidos += size;
+    return 1;
+}
+
+/**
+ * @brief    Lê uma string do objeto do registo atual e insere-a na tabela de
+ *           nomes.
+ * @param id Onde guardar o id do nome lido (NOMES_NENHUM se a string era nula).
+ * @returns  0 se o objeto não tinha bytes suficientes.
+ * @returns  1 caso contrário.
+ */
+static int diario_lerNome(nomes_id* const id) {
+    uint32_t size = 0;
+    *id           = NOMES_NENHUM;
+    if (!diario_ler(&size, sizeof(size))) return 0;
+    if (size == 0) return 1;
+    if (size > diario_bufTam - diario_bufLidos) return 0;
+    *id = nomes_inserirTam((const char*) diario_buf + diario_bufLidos, size);
+    diario_bufLidos += size;
+    return 1;
+}
+
+
+
+
+// Escrever
+// *********************************************************************************************************************
+/**
+ * @brief         Acrescenta um registo com o objeto atual ao diário.
+ * @param op      DIARIO_ALTERAR ou DIARIO_REMOVER.
+ * @param colecao Coleção a que o registo diz respeito.
+ * @param i       Index do objeto.
+ * @param j       Index da compra, se 'colecao' for DIARIO_COMPRAS.
+ */
+static void diario_acrescentar(const uint8_t op, const uint8_t colecao, const colSize_t i, const colSize_t j) {
+    if (!diario_ficheiro) return;
+    diario_registo r = {.tam = diario_bufTam, .checksum = 0, .op = op, .colecao = colecao, ._pad = 0, .i = i, .j = j};
+    r.checksum       = fnv1a(diario_buf, diario_bufTam, fnv1a(&r, sizeof(r), FNV1A_INICIO));
+    protectFcnCall(fwrite(&r, sizeof(r), 1, diario_ficheiro), "impossível escrever no diário");
+    if (diario_bufTam) {
+        protectFcnCall(fwrite(diario_buf, diario_bufTam, 1, diario_ficheiro), "impossível escrever no diário");
+    }
+    protectFcnCall(!fflush(diario_ficheiro), "impossível escrever no diário");
+#ifndef _WIN32
+    fsync(fileno(diario_ficheiro));
+#endif
+    diario_tam += sizeof(r) + diario_bufTam;
+}
+
+/**
+ * @brief   Regista a alteração do artigo 'i'.
+ * @param i Slot do artigo.
+ * @param a O artigo depois da alteração, ou NULL se foi removido.
+ */
+void diario_artigo(const colSize_t i, const artigo* const a) {
+    diario_bufTam = 0;
+    if (a) {
+        diario_escreverStr(nomes_str(a->nome));
+        diario_escrever(&a->meta, sizeof(a->meta));
+        diario_escrever(&a->preco_cent, sizeof(a->preco_cent));
+        diario_escrever(&a->stock, sizeof(a->stock));
+    }
+    diario_acrescentar(a ? DIARIO_ALTERAR : DIARIO_REMOVER, DIARIO_ARTIGOS, i, 0);
+}
+
+/**
+ * @brief   Regista a alteração do cliente 'i'.
+ * @param i Slot do cliente.
+ * @param u O cliente depois da alteração, ou NULL se foi removido.
+ */
+void diario_cliente(const colSize_t i, const utilizador* const u) {
+    diario_bufTam = 0;
+    if (u) {
+        diario_escreverStr(nomes_str(u->nome));
+        diario_escrever(u->NIF, sizeof(u->NIF));
+        diario_escrever(u->CC, sizeof(u->CC));
+    }
+    diario_acrescentar(u ? DIARIO_ALTERAR : DIARIO_REMOVER, DIARIO_CLIENTES, i, 0);
+}
+
+/**
+ * @brief   Regista a alteração da encomenda 'i', sem as suas compras (que são
+ *          registadas com diario_compra).
+ * @param i Index da encomenda.
+ * @param e A encomenda depois da alteração, ou NULL se foi removida.
+ */
+void diario_encomenda(const colSize_t i, const encomenda* const e) {
+    diario_bufTam = 0;
+    if (e) {
+        const int64_t tempo = e->tempo;
+        diario_escrever(&e->ID_cliente, sizeof(e->ID_cliente));
+        diario_escrever(&tempo, sizeof(tempo));
+    }
+    diario_acrescentar(e ? DIARIO_ALTERAR : DIARIO_REMOVER, DIARIO_ENCOMENDAS, i, 0);
+}
+
+/**
+ * @brief     Regista que as encomendas dos meses entre 'de' e 'fim' foram
+ *            gravadas no arquivo e retiradas da coleção
+ *            (persistencia_retirarArquivadas).
+ * @param de  Primeiro mês aberto antes de arquivar.
+ * @param fim Primeiro mês que não foi arquivado.
+ */
+void diario_arquivar(const uint32_t de, const uint32_t fim) {
+    diario_bufTam = 0;
+    diario_acrescentar(DIARIO_ARQUIVAR, DIARIO_ENCOMENDAS, de, fim);
+}
+
+/**
+ * @brief   Regista a alteração da compra 'j' da encomenda 'i'.
+ * @param i Index da encomenda.
+ * @param j Index da compra.
+ * @param c A compra depois da alteração, ou NULL se foi removida.
+ */
+void diario_compra(const colSize_t i, const colSize_t j, const compra* const c) {
+    diario_bufTam = 0;
+    if (c) {
+        diario_escrever(&c->IDartigo, sizeof(c->IDartigo));
+        diario_escrever(&c->qtd, sizeof(c->qtd));
+        diario_escrever(c->receita, sizeof(c->receita));
+        diario_escrever(&c->preco_cent, sizeof(c->preco_cent));
+        diario_escrever(&c->iva, sizeof(c->iva));
+    }
+    diario_acrescentar(c ? DIARIO_ALTERAR : DIARIO_REMOVER, DIARIO_COMPRAS, i, j);
+}
+
+
+
+
+// Reproduzir
+// *********************************************************************************************************************
+/**
+ * @brief   Aplica o registo 'r', cujo objeto está em diario_buf, às coleções.
+ * @returns 0 se o registo não é consistente com as coleções.
+ * @returns 1 caso contrário.
+ */
+static int diario_aplicar(const diario_registo* const r, artigocol* const av, encomendacol* const ev,
+                          utilizadorcol* const uv) {
+    diario_bufLidos = 0;
+    switch (r->colecao) {
+        case DIARIO_ARTIGOS: {
+            artigo_mudouPreco();
+            if (r->i > av->size || (r->i == av->size && r->op == DIARIO_REMOVER)) return 0;
+            if (r->op == DIARIO_REMOVER) {
+                if (!artigocol_vivo(av, r->i)) return 0;
+                freeArtigo(&av->data[r->i]);
+                return artigocol_remover(av, artigocol_handle(av, r->i));
+            }
+            artigo a;
+            if (!diario_lerNome(&a.nome)) return 0;
+            if (!diario_ler(&a.meta, sizeof(a.meta)) || !diario_ler(&a.preco_cent, sizeof(a.preco_cent)) ||
+                !diario_ler(&a.stock, sizeof(a.stock))) {
+                freeArtigo(&a);
+                return 0;
+            }
+            if (!artigocol_vivo(av, r->i)) {
+                // Slot novo ou reutilizado por _inserir
+                if (artigocol_ocupar(av, r->i, a) != COL_INVAL_INDEX) return 1;
+                freeArtigo(&a);
+                return 0;
+            }
+            freeArtigo(&av->data[r->i]);
+            av->data[r->i] = a;
+            return 1;
+        }
+        case DIARIO_CLIENTES: {
+            if (r->i > uv->size || (r->i == uv->size && r->op == DIARIO_REMOVER)) return 0;
+            if (r->op == DIARIO_REMOVER) {
+                if (!utilizadorcol_vivo(uv, r->i)) return 0;
+                freeUtilizador(&uv->data[r->i]);
+                return utilizadorcol_remover(uv, utilizadorcol_handle(uv, r->i));
+            }
+            utilizador u;
+            if (!diario_lerNome(&u.nome)) return 0;
+            if (!diario_ler(u.NIF, sizeof(u.NIF)) || !diario_ler(u.CC, sizeof(u.CC))) {
+                freeUtilizador(&u);
+                return 0;
+            }
+            if (!utilizadorcol_vivo(uv, r->i)) {
+                // Slot novo ou reutilizado por _inserir
+                if (utilizadorcol_ocupar(uv, r->i, u) != COL_INVAL_INDEX) return 1;
+                freeUtilizador(&u);
+                return 0;
+            }
+            freeUtilizador(&uv->data[r->i]);
+            uv->data[r->i] = u;
+            return 1;
+        }
+        case DIARIO_ENCOMENDAS: {
+            if (r->op == DIARIO_ARQUIVAR) {
+                if (r->i > r->j) return 0;
+                persistencia_retirarArquivadas(ev, r->i, r->j);
+                return 1;
+            }
+            if (r->i > ev->size || (r->i == ev->size && r->op == DIARIO_REMOVER)) return 0;
+            if (r->op == DIARIO_REMOVER) {
+                freeEncomenda(encomendacol_at(ev, r->i));
+                encomendacol_moveBelow(ev, r->i);
+                return 1;
+            }
+            colSize_t ID_cliente;
+            int64_t   tempo;
+            if (!diario_ler(&ID_cliente, sizeof(ID_cliente)) || !diario_ler(&tempo, sizeof(tempo))) return 0;
+            if (r->i == ev->size && !encomendacol_push(ev, newEncomenda())) return 0;
+            encomenda* const e = encomendacol_at(ev, r->i);
+            e->ID_cliente      = ID_cliente;
+            e->tempo           = tempo;
+            return 1;
+        }
+        case DIARIO_COMPRAS: {
+            if (r->i >= ev->size) return 0;
+            encomenda_invalidarTotal(encomendacol_at(ev, r->i));
+            compracol* const cv = &encomendacol_at(ev, r->i)->compras;
+            if (r->j > cv->size || (r->j == cv->size && r->op == DIARIO_REMOVER)) return 0;
+            if (r->op == DIARIO_REMOVER) {
+                compracol_moveBelow(cv, r->j);
+                return 1;
+            }
+            compra c = new_compra();
+            if (!diario_ler(&c.IDartigo, sizeof(c.IDartigo)) || !diario_ler(&c.qtd, sizeof(c.qtd)) ||
+                !diario_ler(c.receita, sizeof(c.receita)))
+                return 0;
+            // Os registos anteriores ao preço de venda acabam na receita
+            if (diario_bufLidos < diario_bufTam &&
+                (!diario_ler(&c.preco_cent, sizeof(c.preco_cent)) || !diario_ler(&c.iva, sizeof(c.iva))))
+                return 0;
+            if (r->j == cv->size) return compracol_push(cv, c);
+            compracol_data(cv)[r->j] = c;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief         Cria um diário vazio para a geração 'geracao', substituindo
+ *                o diário que exista em 'caminho'.
+ * @param caminho Ficheiro do diário.
+ * @param geracao Geração do ficheiro sobre o qual o diário vai ser aplicado.
+ * @returns       0 se falhou a criar o diário.
+ * @returns       1 caso contrário.
+ */
+int diario_iniciar(const char* const caminho, const uint64_t geracao) {
+    diario_fechar();
+    diario_ficheiro = fopen(caminho, "w+b");
+    if (!diario_ficheiro) return 0;
+    const diario_cabecalho cab = {.magia = DIARIO_MAGIA, .versao = DIARIO_VERSAO, .geracao = geracao};
+    if (!fwrite(&cab, sizeof(cab), 1, diario_ficheiro) || fflush(diario_ficheiro)) {
+        diario_fechar();
+        return 0;
+    }
+#ifndef _WIN32
+    fsync(fileno(diario_ficheiro));
+#endif
+    diario_geracaoAtual = geracao;
+    diario_tam          = sizeof(cab);
+    diario_adiados      = 0;
+    return 1;
+}
+
+/**
+ * @brief         Secção do ficheiro gravado a que os registos de uma coleção
+ *                do diário dizem respeito.
+ * @param colecao diario_colecao do registo.
+ * @returns       A secção que tem que estar carregada para aplicar o registo.
+ */
+static enum persistencia_tipo diario_seccao(const uint8_t colecao) {
+    switch (colecao) {
+        case DIARIO_ARTIGOS: return PERSISTENCIA_ARTIGOS;
+        case DIARIO_CLIENTES: return PERSISTENCIA_CLIENTES;
+        default: return PERSISTENCIA_ENCOMENDAS;
+    }
+}
+
+/**
+ * @brief         Lê os registos de 'f', a partir da posição atual, e aplica
+ *                às coleções os que dizem respeito às secções em 'seccoes'.
+ * @details       A leitura pára no primeiro registo incompleto ou inválido, ou
+ *                no primeiro registo que não é consistente com as coleções.
+ * @param f       Diário posicionado no primeiro registo.
+ * @param seccoes Secções cujos registos devem ser aplicados (bit 1 << tipo).
+ * @param n       Onde guardar o número de registos aplicados.
+ * @returns       A posição no diário a seguir ao último registo válido.
+ */
+static uint64_t diario_lerRegistos(FILE* const f, const unsigned seccoes, uint64_t* const n, artigocol* const av,
+                                   encomendacol* const ev, utilizadorcol* const uv) {
+    uint64_t       valido = (uint64_t) ftell(f);
+    diario_registo r;
+    *n = 0;
+    while (fread(&r, sizeof(r), 1, f)) {
+        const uint32_t checksum = r.checksum;
+        r.checksum              = 0;
+        diario_bufTam           = 0;
+        if (r.tam > DIARIO_LIMITE) break;
+        if (r.tam) {
+            if (diario_bufAloc < r.tam) {
+                protectVarFcnCall(diario_buf, realloc(diario_buf, r.tam), "alocação de memória recusada");
+                diario_bufAloc = r.tam;
+            }
+            if (!fread(diario_buf, r.tam, 1, f)) break;
+            diario_bufTam = r.tam;
+        }
+        if (fnv1a(diario_buf, diario_bufTam, fnv1a(&r, sizeof(r), FNV1A_INICIO)) != checksum) break;
+        if (r.op != DIARIO_ARQUIVAR && (r.colecao == DIARIO_ENCOMENDAS || r.colecao == DIARIO_COMPRAS))
+            diario_encomendas = 1;
+        if (r.colecao == DIARIO_ARTIGOS) diario_artigos = 1;
+        if ((seccoes >> diario_seccao(r.colecao)) & 1) {
+            if (!diario_aplicar(&r, av, ev, uv)) {
+                menu_printError("registo %lu do diário não é consistente com os dados", *n);
+                break;
+            }
+            (*n)++;
+        } else
+            diario_adiados |= 1u << diario_seccao(r.colecao);
+        valido += sizeof(r) + r.tam;
+    }
+    return valido;
+}
+
+/**
+ * @brief         Aplica os registos do diário em 'caminho' às coleções e deixa
+ *                o diário aberto para acrescentar novos registos.
+ * @details       Se o diário não existir ou for de outra geração é criado um
+ *                diário vazio. Se o diário for da geração anterior, o ficheiro
+ *                foi gravado em segundo plano e os primeiros 'inicio' bytes do
+ *                diário já estão incluídos no ficheiro; os restantes registos
+ *                são aplicados e passam para um diário da geração 'geracao'.
+ *                A leitura pára no primeiro registo incompleto ou inválido
+ *                (uma escrita interrompida) e o diário é truncado nesse ponto.
+ *                Os registos de coleções cuja secção ainda está pendente (ver
+ *                persistencia_pendente) não são aplicados, ficam para
+ *                diario_reproduzirSeccao.
+ * @param caminho Ficheiro do diário.
+ * @param geracao Geração do ficheiro de onde as coleções foram carregadas.
+ * @param inicio  Bytes do diário da geração anterior incluídos no ficheiro.
+ * @param av      Artigos carregados.
+ * @param ev      Encomendas carregadas.
+ * @param uv      Clientes carregados.
+ * @returns       0 se falhou a abrir o diário.
+ * @returns       1 caso contrário.
+ */
+int diario_reproduzir(const char* const caminho, const uint64_t geracao, const uint64_t inicio,
+                      artigocol* const av, encomendacol* const ev, utilizadorcol* const uv) {
+    diario_fechar();
+    diario_encomendas = 0;
+    diario_artigos    = 0;
+    FILE* f = fopen(caminho, "r+b");
+    if (!f) return diario_iniciar(caminho, geracao);
+
+    diario_cabecalho cab;
+    const int        valido = fread(&cab, sizeof(cab), 1, f) && !memcmp(cab.magia, DIARIO_MAGIA, sizeof(cab.magia)) &&
+                       cab.versao == DIARIO_VERSAO;
+    const int anterior = valido && cab.geracao + 1 == geracao && inicio >= sizeof(cab);
+    if (!valido || (cab.geracao != geracao && !anterior) || (anterior && fseek(f, inicio, SEEK_SET))) {
+        fclose(f);
+        menu_printInfo("diário de outra geração ignorado");
+        return diario_iniciar(caminho, geracao);
+    }
+
+    unsigned seccoes = 0;
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if (!persistencia_pendente(t)) seccoes |= 1u << t;
+    }
+    uint64_t       n   = 0;
+    diario_adiados = 0;
+    persistencia_comecarCarga();
+    const uint64_t fim = diario_lerRegistos(f, seccoes, &n, av, ev, uv);
+    persistencia_acabarCarga();
+
+    // Descartar um registo interrompido e continuar a partir do último válido
+    fflush(f);
+#ifdef _WIN32
+    _chsize(_fileno(f), fim);
+#else
+    if (ftruncate(fileno(f), fim)) menu_printError("impossível truncar o diário");
+#endif
+    fseek(f, 0, SEEK_END);
+    diario_ficheiro     = f;
+    diario_geracaoAtual = cab.geracao;
+    diario_tam          = fim;
+    if (n) menu_printInfo("%lu alterações recuperadas do diário", n);
+    return !anterior || diario_rodar(caminho, geracao, inicio);
+}
+
+/**
+ * @brief         Substitui o diário aberto por um diário da geração
+ *                'geracao' só com os registos a partir de 'inicio', depois de
+ *                os registos anteriores terem sido incluídos num ficheiro
+ *                gravado dessa geração.
+ * @details       O novo diário é escrito num ficheiro temporário que depois
+ *                substitui 'caminho', por isso uma interrupção deixa sempre um
+ *                dos dois diários completo.
+ * @param caminho Ficheiro do diário.
+ * @param geracao Geração do ficheiro gravado.
+ * @param inicio  Tamanho do diário quando as coleções foram gravadas.
+ * @returns       0 se falhou a criar o novo diário.
+ * @returns       1 caso contrário.
+ */
+int diario_rodar(const char* const caminho, const uint64_t geracao, const uint64_t inicio) {
+    if (!diario_ficheiro || inicio < sizeof(diario_cabecalho) || inicio > diario_tam) {
+        return diario_iniciar(caminho, geracao);
+    }
+    char* tmp;
+    protectVarFcnCall(tmp, malloc(strlen(caminho) + 5), "alocação de memória recusada");
+    strcpy(tmp, caminho);
+    strcat(tmp, ".tmp");
+
+    FILE* f = fopen(tmp, "w+b");
+    if (!f) {
+        free(tmp);
+        return 0;
+    }
+    const diario_cabecalho cab = {.magia = DIARIO_MAGIA, .versao = DIARIO_VERSAO, .geracao = geracao};
+    int                    ok  = fwrite(&cab, sizeof(cab), 1, f) && !fseek(diario_ficheiro, inicio, SEEK_SET);
+    char                   buf[4096];
+    for (uint64_t falta = diario_tam - inicio; ok && falta;) {
+        const size_t n = falta < sizeof(buf) ? falta : sizeof(buf);
+        ok             = fread(buf, n, 1, diario_ficheiro) && fwrite(buf, n, 1, f);
+        falta -= n;
+    }
+    ok = ok && !fflush(f);
+#ifndef _WIN32
+    ok = ok && !fsync(fileno(f));
+#else
+    diario_fechar();
+    if (ok) remove(caminho);
+#endif
+    ok = ok && !rename(tmp, caminho);
+    if (!ok) {
+        fclose(f);
+        remove(tmp);
+        free(tmp);
+        if (diario_ficheiro) fseek(diario_ficheiro, 0, SEEK_END);
+        return 0;
+    }
+    free(tmp);
+    fseek(f, 0, SEEK_END);
+    diario_tam = sizeof(cab) + (diario_tam - inicio);
+    diario_fechar();
+    diario_ficheiro     = f;
+    diario_geracaoAtual = geracao;
+    return 1;
+}
+
+/**
+ * @brief    Aplica os registos do diário aberto que dizem respeito à secção
+ *           't', acabada de carregar com persistencia_carregarSeccao.
+ * @param t  Secção carregada.
+ * @param av Artigos.
+ * @param ev Encomendas.
+ * @param uv Clientes.
+ * @returns  0 se um registo não é consistente com a secção carregada.
+ * @returns  1 caso contrário.
+ */
+int diario_reproduzirSeccao(const enum persistencia_tipo t, artigocol* const av, encomendacol* const ev,
+                            utilizadorcol* const uv) {
+    if (!diario_ficheiro) return 1;
+    uint64_t n = 0;
+    fseek(diario_ficheiro, sizeof(diario_cabecalho), SEEK_SET);
+    persistencia_comecarCarga();
+    const uint64_t valido = diario_lerRegistos(diario_ficheiro, 1u << t, &n, av, ev, uv);
+    persistencia_acabarCarga();
+    fseek(diario_ficheiro, 0, SEEK_END);
+    diario_adiados &= ~(1u << t);
+    return valido == diario_tam;
+}
+
+/**
+ * @brief   Verifica se o diário tem registos da secção 't' que ainda não
+ *          foram aplicados por a secção estar pendente.
+ * @param t Secção a verificar.
+ * @returns 1 se a secção no ficheiro não corresponde ao estado atual.
+ * @returns 0 caso contrário.
+ */
+int diario_adiado(const enum persistencia_tipo t) { return (diario_adiados >> t) & 1; }
+
+/**
+ * @brief   Verifica se o último diario_reproduzir encontrou registos que
+ *          alteram encomendas ou compras (aplicados ou adiados), ou seja, se
+ *          as encomendas são diferentes das do ficheiro gravado.
+ * @returns 1 se encontrou, 0 caso contrário.
+ */
+int diario_alterouEncomendas() { return diario_encomendas; }
+
+/**
+ * @brief   Verifica se o último diario_reproduzir encontrou registos que
+ *          alteram artigos (aplicados ou adiados).
+ * @returns 1 se encontrou, 0 caso contrário.
+ */
+int diario_alterouArtigos() { return diario_artigos; }
+
+/**
+ * @brief Fecha o diário, nenhum registo é acrescentado até o diário ser
+ *        reaberto.
+ */
+void diario_fechar() {
+    if (diario_ficheiro) fclose(diario_ficheiro);
+    diario_ficheiro = NULL;
+}
+
+/**
+ * @brief   Retorna a geração sobre a qual o diário é aplicado.
+ * @returns A geração do último ficheiro carregado ou gravado.
+ */
+uint64_t diario_geracao() { return diario_geracaoAtual; }
+
+/**
+ * @brief   Retorna o tamanho atual do diário, a passar a diario_rodar depois
+ *          de gravar as coleções tal como estão agora.
+ * @returns O tamanho do diário em bytes.
+ */
+uint64_t diario_tamanho() { return diario_tam; }
+
+/**
+ * @brief   Verifica se o diário já é grande o suficiente para justificar um
+ *          checkpoint.
+ * @returns 1 se os dados devem ser gravados para recomeçar o diário.
+ * @returns 0 caso contrário.
+ */
+int diario_precisaCompactar() { return diario_ficheiro && diario_tam > DIARIO_LIMITE; }
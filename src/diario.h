@@ -0,0 +1,110 @@
+/**
+ * @file    diario.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Diário onde cada alteração às coleções é acrescentada como um
+ *          registo binário, de modo a que gravar custe o tamanho da alteração
+ *          e não o tamanho de todos os dados.
+ * @details O estado do programa é o último ficheiro gravado por
+ *          persistencia_gravar mais os registos do diário. Cada ficheiro
+ *          gravado tem uma geração e o diário guarda a geração sobre a qual os
+ *          seus registos devem ser aplicados; um diário de outra geração é
+ *          ignorado. Gravar os dados (um checkpoint) cria um ficheiro de uma
+ *          nova geração e recomeça o diário com os registos acrescentados
+ *          depois de as coleções terem sido copiadas para gravar
+ *          (diario_rodar). Até lá, o ficheiro gravado guarda quantos bytes do
+ *          diário da geração anterior já inclui. Os registos de uma coleção que
+ *          ainda não foi carregada do ficheiro são aplicados quando a coleção
+ *          é carregada (diario_reproduzirSeccao).
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef DIARIO_H
+#define DIARIO_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "persistencia.h"
+
+/**
+ * @def DIARIO_MAGIA
+ *          Primeiros 4 bytes do diário.
+ * @def DIARIO_VERSAO
+ *          Versão do formato do diário.
+ * @def DIARIO_LIMITE
+ *          Tamanho do diário, em bytes, a partir do qual deve ser feito um
+ *          checkpoint.
+ * @def DIARIO_ALTERAR
+ *          Operação que substitui o objeto 'i' (ou o acrescenta se 'i' for o
+ *          tamanho da coleção). Nos artigos e clientes, se o slot 'i' estiver
+ *          livre o objeto é inserido nesse slot (_ocupar).
+ * @def DIARIO_REMOVER
+ *          Operação que remove o objeto 'i' (_moveBelow, ou _remover nos
+ *          artigos e clientes).
+ * @def DIARIO_ARQUIVAR
+ *          Operação que retira as encomendas dos meses entre 'i' e 'j' depois
+ *          de arquivadas (só para DIARIO_ENCOMENDAS).
+ */
+#define DIARIO_MAGIA "LP1D"
+#define DIARIO_VERSAO ((uint32_t) 1)
+#define DIARIO_LIMITE (4 * 1024 * 1024)
+#define DIARIO_ALTERAR ((uint8_t) 0)
+#define DIARIO_REMOVER ((uint8_t) 1)
+#define DIARIO_ARQUIVAR ((uint8_t) 2)
+
+/**
+ * @brief Coleção a que um registo diz respeito.
+ */
+enum diario_colecao {
+    DIARIO_ARTIGOS    = 0, ///< 'i' é o slot em artigocol
+    DIARIO_ENCOMENDAS = 1, ///< 'i' é o index em encomendacol
+    DIARIO_CLIENTES   = 2, ///< 'i' é o slot em utilizadorcol
+    DIARIO_COMPRAS    = 3  ///< 'i' é o index da encomenda e 'j' da compra
+};
+
+/**
+ * @brief   Cabeçalho do diário.
+ */
+typedef struct {
+    char     magia[4]; ///< DIARIO_MAGIA
+    uint32_t versao;   ///< DIARIO_VERSAO
+    uint64_t geracao;  ///< Geração do ficheiro sobre o qual o diário é aplicado
+} diario_cabecalho;
+
+/**
+ * @brief   Cabeçalho de um registo, seguido de 'tam' bytes com o objeto
+ *          (apenas para DIARIO_ALTERAR).
+ */
+typedef struct {
+    uint32_t  tam;      ///< Tamanho do objeto que segue o registo
+    uint32_t  checksum; ///< fnv1a do registo (com checksum a 0) e do objeto
+    uint8_t   op;       ///< DIARIO_ALTERAR, DIARIO_REMOVER ou DIARIO_ARQUIVAR
+    uint8_t   colecao;  ///< diario_colecao
+    uint16_t  _pad;     ///< Sempre 0
+    colSize_t i;        ///< Index do objeto (ou da encomenda)
+    colSize_t j;        ///< Index da compra
+} diario_registo;
+
+int      diario_reproduzir(const char* const caminho, const uint64_t geracao, const uint64_t inicio,
+                           artigocol* const av, encomendacol* const ev, utilizadorcol* const uv);
+int      diario_reproduzirSeccao(const enum persistencia_tipo t, artigocol* const av, encomendacol* const ev,
+                                 utilizadorcol* const uv);
+int      diario_adiado(const enum persistencia_tipo t);
+int      diario_alterouEncomendas();
+int      diario_alterouArtigos();
+int      diario_iniciar(const char* const caminho, const uint64_t geracao);
+int      diario_rodar(const char* const caminho, const uint64_t geracao, const uint64_t inicio);
+void     diario_fechar();
+uint64_t diario_geracao();
+uint64_t diario_tamanho();
+int      diario_precisaCompactar();
+void     diario_artigo(const colSize_t i, const artigo* const a);
+void     diario_cliente(const colSize_t i, const utilizador* const u);
+void     diario_encomenda(const colSize_t i, const encomenda* const e);
+void     diario_compra(const colSize_t i, const colSize_t j, const compra* const c);
+void     diario_arquivar(const uint32_t de, const uint32_t fim);
+
+#endif
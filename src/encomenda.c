@@ -11,6 +11,11 @@
 
 #include "encomenda.h"
 
+#include <stddef.h>
+#ifdef ENCOMENDA_AVX2
+#    include <immintrin.h>
+#endif
+
 #include "menu.h"
 #include "utilities.h"
 
@@ -20,9 +25,11 @@
  */
 encomenda newEncomenda() {
     return (encomenda) {
-        .compras    = compracol_new(), //
-        .ID_cliente = 0,               //
-        .tempo      = time(NULL)       //
+        .compras      = compracol_new(), //
+        .ID_cliente   = 0,               //
+        .versao_total = 0,               //
+        .tempo        = time(NULL),      //
+        .total        = 0                //
     };
 }
 
@@ -34,26 +41,263 @@ void freeEncomenda(encomenda* const e) { compracol_free(&e->compras); }
 
 /**
  * @brief           Calcula o preço de uma encomenda, em cêntimos.
+ * @details         Cada compra conta com o preço do momento da venda. Só as
+ *                  compras sem o preço registado (ver compra_temPreco) são
+ *                  procuradas nos artigos, e as de artigos que foram
+ *                  removidos não contam para o preço.
  * @param e         Encomenda cujo preço será calculado.
+ * @param av        Artigos.
  * @returns         O preço da encomenda em cêntimos.
  */
 uint64_t encomenda_CalcPreco(const encomenda* const e, const artigocol* const av) {
-    int64_t precoFinal = 0;
-    int64_t precoPreTax;
-    artigo* artAtual;
+    int64_t             precoFinal = 0;
+    const artigo*       artAtual;
+    const compra* const compras    = compracol_data(&e->compras);
     for (int64_t i = 0; i < e->compras.size; i++) {
-        artAtual    = &(av->data[e->compras.data[i].IDartigo]);
-        precoPreTax = artAtual->preco_cent;
-        switch (artAtual->meta & ARTIGO_IVA) {
-            case ARTIGO_IVA_NORMAL: precoPreTax *= ARTIGO_IVA_NORMAL_VAL; break;
-            case ARTIGO_IVA_INTERMEDIO: precoPreTax *= ARTIGO_IVA_INTERMEDIO_VAL; break;
-            case ARTIGO_IVA_REDUZIDO: precoPreTax *= ARTIGO_IVA_REDUZIDO_VAL; break;
+        if (compra_temPreco(&compras[i])) {
+            precoFinal += compra_precoIVA(&compras[i]) * (compras[i].qtd);
+            continue;
         }
-        precoFinal += precoPreTax * (e->compras.data[i].qtd);
+        artAtual = artigocol_obter(av, compras[i].IDartigo);
+        if (!artAtual) continue;
+        precoFinal += artigo_precoIVA(artAtual) * (compras[i].qtd);
     }
     return precoFinal;
 }
 
+/**
+ * @brief           Preços com IVA de todos os slots de uma artigocol, para as
+ *                  compras sem o preço registado em encomenda_CalcPrecoBatch.
+ * @details         Os arrays têm n + 1 entradas: a última é uma sentinela,
+ *                  usada pelas compras cujo slot não existe, com um handle
+ *                  que nenhuma compra tem (COL_INVAL_INDEX tem uma geração
+ *                  ímpar). Um slot livre também tem uma geração ímpar, por
+ *                  isso só as compras de artigos que existem encontram o seu
+ *                  handle. Se todas as compras têm o preço registado a tabela
+ *                  não é preenchida e tem só a sentinela.
+ */
+typedef struct {
+    colSize_t  n;       ///< Número de slots
+    colSize_t* handles; ///< Handle atual de cada slot
+    int64_t*   precos;  ///< Preço com IVA de cada slot, 0 se o slot está livre
+} encomenda_precos;
+
+static colSize_t encomenda_semHandles[1] = {COL_INVAL_INDEX}; ///< Sentinela da tabela de preços vazia
+static int64_t   encomenda_semPrecos[1]  = {0};               ///< Sentinela da tabela de preços vazia
+
+/**
+ * @brief           Preenche a tabela de preços com os artigos de 'av'.
+ * @param p         Tabela, libertada com encomenda_libertarPrecos. Fica vazia
+ *                  se não conseguiu alocar memória.
+ * @param av        Artigos.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 se conseguiu.
+ */
+static int encomenda_carregarPrecos(encomenda_precos* const p, const artigocol* const av) {
+    colSize_t* const h = malloc(sizeof(colSize_t) * ((size_t) av->size + 1));
+    int64_t* const   v = malloc(sizeof(int64_t) * ((size_t) av->size + 1));
+    if (!h || !v) {
+        free(h);
+        free(v);
+        return 0;
+    }
+    for (colSize_t i = 0; i < av->size; i++) {
+        h[i] = artigocol_handle(av, i);
+        v[i] = artigocol_vivo(av, i) ? artigo_precoIVA(&av->data[i]) : 0;
+    }
+    h[av->size] = COL_INVAL_INDEX;
+    v[av->size] = 0;
+    p->n        = av->size;
+    p->handles  = h;
+    p->precos   = v;
+    return 1;
+}
+
+/**
+ * @brief           Liberta a tabela de preços.
+ * @param p         Tabela.
+ */
+static void encomenda_libertarPrecos(encomenda_precos* const p) {
+    if (p->handles == encomenda_semHandles) return;
+    free(p->handles);
+    free(p->precos);
+}
+
+/**
+ * @brief   Verifica se o preço da encomenda depende dos preços atuais dos
+ *          artigos, isto é, se tem alguma compra sem o preço registado.
+ * @param e Encomenda.
+ * @returns 1 se alguma compra não tem preço registado, 0 caso contrário.
+ */
+static int encomenda_dependeArtigos(const encomenda* const e) {
+    const compra* const c = compracol_data(&e->compras);
+    for (colSize_t j = 0; j < e->compras.size; j++) {
+        if (!compra_temPreco(&c[j])) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief           Verifica se alguma compra das encomendas de 'ev' não tem o
+ *                  preço registado.
+ * @param ev        Encomendas.
+ * @returns         1 se alguma compra precisa da tabela de preços, 0 caso
+ *                  contrário.
+ */
+static int encomenda_temSemPreco(const encomendacol* const ev) {
+    COL_PARA_CADA(encomendacol, ev, e) {
+        if (encomenda_dependeArtigos(e)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief           Calcula o preço unitário com IVA de uma compra sem saltos.
+ * @details         São calculados o preço registado e o preço atual do artigo
+ *                  na tabela, e escolhido um deles: o slot é limitado à
+ *                  sentinela e as compras de artigos removidos são anuladas
+ *                  por comparação do handle.
+ * @param c         Compra.
+ * @param p         Tabela de preços.
+ * @returns         O preço com IVA, igual ao de encomenda_CalcPreco.
+ */
+static inline int64_t encomenda_precoCompra(const compra* const c, const encomenda_precos* const p) {
+    const colSize_t h     = c->IDartigo;
+    const colSize_t slot  = (COL_SLOT_INDEX(h) < p->n) ? COL_SLOT_INDEX(h) : p->n;
+    const int64_t   atual = (p->handles[slot] == h) ? p->precos[slot] : 0;
+    return compra_temPreco(c) ? compra_precoIVA(c) : atual;
+}
+
+#ifdef ENCOMENDA_AVX2
+/**
+ * @brief           Soma as compras de 4 em 4 com AVX2, ver
+ *                  encomenda_somarCompras.
+ * @details         Os campos de 4 compras seguidas, a 'sizeof(compra)' bytes
+ *                  umas das outras, são lidos com gathers, tal como os preços
+ *                  da tabela. O preço registado com IVA é dividido por 100
+ *                  com uma multiplicação de 32 bits ((x * 0x51EB851F) >> 37),
+ *                  por isso as 4 compras são somadas por
+ *                  encomenda_precoCompra se algum preço vezes a taxa não
+ *                  couber em 32 bits.
+ * @param c         Compras.
+ * @param n         Número de compras.
+ * @param p         Tabela de preços.
+ * @param j         Onde guardar o index da primeira compra que não foi somada.
+ * @returns         A soma das compras antes de '*j', em cêntimos.
+ */
+static int64_t encomenda_somarComprasAVX2(const compra* const c, const colSize_t n, const encomenda_precos* const p,
+                                          colSize_t* const j) {
+    const __m128i passo    = _mm_setr_epi32(0, sizeof(compra), 2 * sizeof(compra), 3 * sizeof(compra));
+    const __m128i mascara  = _mm_set1_epi32(COL_SLOT_MAX - 1);
+    const __m128i limite   = _mm_set1_epi32((int) p->n);
+    const __m256i semPreco = _mm256_set1_epi64x(COMPRA_SEM_PRECO);
+    const __m256i cem      = _mm256_set1_epi64x(100);
+    const __m256i magia    = _mm256_set1_epi64x(0x51EB851F);
+    __m256i       soma     = _mm256_setzero_si256();
+    int64_t       total    = 0;
+    colSize_t     i        = 0;
+    for (; i + 4 <= n; i += 4) {
+        const char* const g    = (const char*) &c[i];
+        const __m128i     h    = _mm_i32gather_epi32((const int*) (g + offsetof(compra, IDartigo)), passo, 1);
+        const __m256i     qtd  = _mm256_i32gather_epi64((const long long*) (g + offsetof(compra, qtd)), passo, 1);
+        const __m256i     base = _mm256_i32gather_epi64((const long long*) (g + offsetof(compra, preco_cent)), passo, 1);
+        // 'iva' é o último byte de cada compra, lido com os 3 bytes anteriores
+        const __m128i iva32 =
+            _mm_srli_epi32(_mm_i32gather_epi32((const int*) (g + offsetof(compra, iva) - 3), passo, 1), 24);
+        const __m256i iva  = _mm256_cvtepu32_epi64(iva32);
+        const __m256i taxa = _mm256_add_epi64(
+            cem, _mm256_i32gather_epi64((const long long*) artigo_ivaPercentagem,
+                                        _mm_and_si128(iva32, _mm_set1_epi32(ARTIGO_IVA)), 8));
+        const __m256i produto = _mm256_mul_epu32(base, taxa);
+        const __m256i grande  = _mm256_or_si256(_mm256_srli_epi64(base, 32), _mm256_srli_epi64(produto, 32));
+        if (!_mm256_testz_si256(grande, grande)) {
+            for (colSize_t k = i; k < i + 4; k++) total += encomenda_precoCompra(&c[k], p) * c[k].qtd;
+            continue;
+        }
+        const __m256i registado = _mm256_srli_epi64(_mm256_mul_epu32(produto, magia), 37);
+        // Preço atual do artigo, para as compras sem o preço registado
+        const __m128i slot   = _mm_min_epu32(_mm_and_si128(h, mascara), limite);
+        const __m128i vivo   = _mm_cmpeq_epi32(_mm_i32gather_epi32((const int*) p->handles, slot, 4), h);
+        const __m256i precos = _mm256_i32gather_epi64((const long long*) p->precos, slot, 8);
+        const __m256i atual  = _mm256_and_si256(precos, _mm256_cvtepi32_epi64(vivo));
+        const __m256i preco  = _mm256_blendv_epi8(registado, atual, _mm256_cmpeq_epi64(iva, semPreco));
+        // Produto de 64 bits com multiplicações de 32 bits: lo*lo + ((lo*hi + hi*lo) << 32)
+        const __m256i cruzado = _mm256_add_epi64(_mm256_mul_epu32(preco, _mm256_srli_epi64(qtd, 32)),
+                                                 _mm256_mul_epu32(_mm256_srli_epi64(preco, 32), qtd));
+        soma = _mm256_add_epi64(soma, _mm256_add_epi64(_mm256_mul_epu32(preco, qtd), _mm256_slli_epi64(cruzado, 32)));
+    }
+    int64_t parcial[4];
+    _mm256_storeu_si256((__m256i*) parcial, soma);
+    *j = i;
+    return total + parcial[0] + parcial[1] + parcial[2] + parcial[3];
+}
+#endif
+
+/**
+ * @brief           Soma os preços das compras de uma encomenda.
+ * @details         O ciclo não tem saltos (ver encomenda_precoCompra), o que
+ *                  permite ao compilador vetorizá-lo. Com ENCOMENDA_AVX2 as
+ *                  compras são somadas de 4 em 4 explicitamente.
+ * @param e         Encomenda.
+ * @param p         Tabela de preços.
+ * @returns         O preço da encomenda em cêntimos.
+ */
+static uint64_t encomenda_somarCompras(const encomenda* const e, const encomenda_precos* const p) {
+    const compra* const c     = compracol_data(&e->compras);
+    const colSize_t     n     = e->compras.size;
+    int64_t             total = 0;
+    colSize_t           j     = 0;
+#ifdef ENCOMENDA_AVX2
+    total = encomenda_somarComprasAVX2(c, n, p, &j);
+#endif
+    for (; j < n; j++) total += encomenda_precoCompra(&c[j], p) * c[j].qtd;
+    return total;
+}
+
+/**
+ * @brief           Calcula o preço de todas as encomendas de 'ev' numa só
+ *                  passagem, em cêntimos.
+ * @details         As compras com o preço registado não leem os artigos. Os
+ *                  preços com IVA dos artigos, para as restantes, são
+ *                  calculados uma só vez, antes de percorrer as encomendas,
+ *                  para uma tabela indexada pelo slot de cada artigo, e só se
+ *                  alguma compra não tiver o preço registado. O resultado de
+ *                  cada encomenda é igual ao de encomenda_CalcPreco.
+ * @param ev        Encomendas.
+ * @param av        Artigos.
+ * @param out       Onde guardar o preço de cada encomenda, com 'ev->size'
+ *                  posições.
+ */
+void encomenda_CalcPrecoBatch(const encomendacol* const ev, const artigocol* const av, uint64_t* const out) {
+    encomenda_precos p = {.n = 0, .handles = encomenda_semHandles, .precos = encomenda_semPrecos};
+    if (encomenda_temSemPreco(ev) && !encomenda_carregarPrecos(&p, av)) {
+        // Sem memória para a tabela, cada encomenda procura os seus artigos
+        COL_PARA_CADA(encomendacol, ev, e) out[e_i] = encomenda_CalcPreco(e, av);
+        return;
+    }
+    COL_PARA_CADA(encomendacol, ev, e) out[e_i] = encomenda_somarCompras(e, &p);
+    encomenda_libertarPrecos(&p);
+}
+
+/**
+ * @brief           Retorna o preço de uma encomenda, em cêntimos, calculando-o
+ *                  apenas se as compras ou os preços dos artigos mudaram desde
+ *                  a última vez que foi calculado. O total de uma encomenda
+ *                  em que todas as compras têm o preço registado não volta a
+ *                  ser calculado quando os preços dos artigos mudam.
+ * @param e         Encomenda, onde o total é guardado.
+ * @param av        Artigos.
+ * @returns         O preço da encomenda em cêntimos (ver encomenda_CalcPreco).
+ */
+uint64_t encomenda_total(encomenda* const e, const artigocol* const av) {
+    if (!encomenda_totalValido(e)) {
+        // Sem compras sem preço o total não muda com os preços dos artigos
+        e->total        = encomenda_CalcPreco(e, av);
+        e->versao_total = encomenda_dependeArtigos(e) ? artigo_versaoPrecos : ARTIGO_VERSAO_FIXA;
+    }
+    return e->total;
+}
+
 /**
  * @brief           Responsável por salvar uma encomenda num ficheiro.
  * @param f         Ficheiro onde salvar a encomenda.
@@ -80,6 +324,7 @@ int save_encomenda(FILE* const f, const encomenda* const data) {
 int load_encomenda(FILE* const f, encomenda* const data) {
     // Carregar artigos
     data->compras = compracol_new();
+    encomenda_invalidarTotal(data);
     if (!compracol_read(&(data->compras), f)) {
         menu_printError("ao carregar encomenda - compracol_read falhou");
         return 0;
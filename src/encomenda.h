@@ -23,18 +23,40 @@
 #    define artigocol_H
 #    define COL_TIPO artigo
 #    define COL_NOME artigocol
+#    define COL_PARALELO
+#    define COL_SLOTS
 #    define COL_DEALOC(X) freeArtigo(X)
 #    define COL_WRITE(X, F) save_artigo(F, X)
 #    define COL_READ(X, F) load_artigo(F, X)
 #    include "colecao.h"
 #endif
 
+// As compras criadas ao carregar ficam na arena de persistencia.c (ver persistencia.h)
+void* persistencia_alocar(const size_t tam);
+void* persistencia_realocar(void* const p, const size_t antigo, const size_t tam);
+void  persistencia_libertar(void* const p);
+
+/**
+ * @def ENCOMENDA_AVX2
+ *          Se definido, encomenda_CalcPrecoBatch soma as compras de 4 em 4
+ *          com instruções AVX2 (é preciso compilar com -mavx2). Por omição o
+ *          ciclo é escalar, sem saltos, e vetorizado pelo compilador.
+ * @def ENCOMENDA_COMPRAS_INLINE
+ *          Se definido com um valor N, as primeiras N compras de cada
+ *          encomenda são guardadas dentro da própria encomenda (COL_INLINE).
+ */
 #ifndef compracol_H
 #    define compracol_H
 #    define COL_TIPO compra
 #    define COL_NOME compracol
-#    define COL_WRITE(X, F) save_compra(F, X)
-#    define COL_READ(X, F) load_compra(F, X)
+#    ifdef ENCOMENDA_COMPRAS_INLINE
+#        define COL_INLINE ENCOMENDA_COMPRAS_INLINE
+#    endif
+#    define COL_POD
+#    define COL_POD_TROCA(X) compra_trocarBytes(X)
+#    define COL_ALLOC(N) persistencia_alocar(N)
+#    define COL_REALLOC(P, ANTIGO, N) persistencia_realocar(P, ANTIGO, N)
+#    define COL_FREE(P) persistencia_libertar(P)
 #    include "colecao.h"
 #endif
 
@@ -43,9 +65,11 @@
  *          certa data.
  */
 typedef struct {
-    compracol compras;    ///< Compras que fazem parte da encomenda.
-    colSize_t ID_cliente; ///< ID do cliente que formalizou a encomenda.
-    time_t    tempo;      ///< Data de criação da encomenda
+    compracol compras;      ///< Compras que fazem parte da encomenda.
+    colSize_t ID_cliente;   ///< Handle do cliente que formalizou a encomenda (COL_SLOT_HANDLE).
+    uint32_t  versao_total; ///< artigo_versaoPrecos quando 'total' foi calculado, ARTIGO_VERSAO_FIXA se não depende dos artigos, 0 se não foi calculado.
+    time_t    tempo;        ///< Data de criação da encomenda
+    uint64_t  total;        ///< Preço da encomenda em cêntimos, calculado por encomenda_total.
 } encomenda;
 
 encomenda newEncomenda();
@@ -53,5 +77,37 @@ void      freeEncomenda(encomenda* const e);
 int       save_encomenda(FILE* const f, const encomenda* const data);
 int       load_encomenda(FILE* const f, encomenda* const data);
 uint64_t  encomenda_CalcPreco(const encomenda* const e, const artigocol* const av);
+uint64_t  encomenda_total(encomenda* const e, const artigocol* const av);
+
+#ifndef encomendacol_H
+#    define encomendacol_H
+#    define COL_TIPO encomenda
+#    define COL_NOME encomendacol
+#    define COL_PARALELO
+#    define COL_SEGMENTOS
+#    define COL_DEALOC(X) freeEncomenda(X)
+#    define COL_WRITE(X, F) save_encomenda(F, X)
+#    define COL_READ(X, F) load_encomenda(F, X)
+#    include "colecao.h"
+#endif
+
+void encomenda_CalcPrecoBatch(const encomendacol* const ev, const artigocol* const av, uint64_t* const out);
+
+/**
+ * @brief   Verifica se o total guardado na encomenda ainda é válido.
+ * @param e Encomenda.
+ * @returns 1 se 'total' foi calculado depois da última mudança de preços ou
+ *          não depende dos preços dos artigos, 0 caso contrário.
+ */
+static inline int encomenda_totalValido(const encomenda* const e) {
+    return e->versao_total == artigo_versaoPrecos || e->versao_total == ARTIGO_VERSAO_FIXA;
+}
+
+/**
+ * @brief   Marca o total da encomenda para ser calculado outra vez, tem que
+ *          ser chamada quando as compras da encomenda mudam.
+ * @param e Encomenda.
+ */
+static inline void encomenda_invalidarTotal(encomenda* const e) { e->versao_total = 0; }
 
 #endif
\ No newline at end of file
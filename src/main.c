@@ -29,11 +29,18 @@
 #include "encomenda.h"
 #include "utilizador.h"
 #include "menu.h"
+#include "persistencia.h"
+#include "diario.h"
+#include "nomes.h"
+#include "paralelo.h"
+#include "resumo.h"
 
 #ifndef artigocol_H
 #    define artigocol_H
 #    define COL_TIPO artigo
 #    define COL_NOME artigocol
+#    define COL_PARALELO
+#    define COL_SLOTS
 #    define COL_DEALOC(X) freeArtigo(X)
 #    define COL_WRITE(X, F) save_artigo(F, X)
 #    define COL_READ(X, F) load_artigo(F, X)
@@ -44,6 +51,8 @@
 #    define encomendacol_H
 #    define COL_TIPO encomenda
 #    define COL_NOME encomendacol
+#    define COL_PARALELO
+#    define COL_SEGMENTOS
 #    define COL_DEALOC(X) freeEncomenda(X)
 #    define COL_WRITE(X, F) save_encomenda(F, X)
 #    define COL_READ(X, F) load_encomenda(F, X)
@@ -54,72 +63,399 @@
 #    define utilizadorcol_H
 #    define COL_TIPO utilizador
 #    define COL_NOME utilizadorcol
+#    define COL_SLOTS
 #    define COL_DEALOC(X) freeUtilizador(X)
 #    define COL_WRITE(X, F) save_utilizador(F, X)
 #    define COL_READ(X, F) load_utilizador(F, X)
 #    include "colecao.h"
 #endif
 
-artigocol     artigos;    ///< Artigos da seção atual
-encomendacol  encomendas; ///< Encomendas
-utilizadorcol clientes;   ///< Utilizadores existentes no registo
+#ifndef niftab_H
+#    define niftab_H
+#    define TAB_TIPO utilizador_chaveNIF
+#    define TAB_NOME niftab
+#    define TAB_HASH(K) fnv1a((K)->NIF, sizeof((K)->NIF), FNV1A_INICIO)
+#    define TAB_IGUAL(A, B) (memcmp((A)->NIF, (B)->NIF, sizeof((A)->NIF)) == 0)
+#    include "tabela.h"
+#endif
+
+#ifndef cctab_H
+#    define cctab_H
+#    define TAB_TIPO utilizador_chaveCC
+#    define TAB_NOME cctab
+#    define TAB_HASH(K) fnv1a((K)->CC, sizeof((K)->CC), FNV1A_INICIO)
+#    define TAB_IGUAL(A, B) (memcmp((A)->CC, (B)->CC, sizeof((A)->CC)) == 0)
+#    include "tabela.h"
+#endif
+
+artigocol     artigos;            ///< Artigos da seção atual
+encomendacol  encomendas;         ///< Encomendas
+utilizadorcol clientes;           ///< Utilizadores existentes no registo
+niftab        clientes_NIF;       ///< Slot de cada cliente pelo NIF (ver funcional_exigirIndices)
+cctab         clientes_CC;        ///< Slot de cada cliente pelo CC (ver funcional_exigirIndices)
+int           clientes_indexados; ///< Se 'clientes_NIF' e 'clientes_CC' correspondem a 'clientes'
+
+/**
+ * @def FICHEIRO_DADOS
+ *          Ficheiro onde o estado é gravado.
+ * @def FICHEIRO_DIARIO
+ *          Diário com as alterações feitas desde a última gravação.
+ * @def FICHEIRO_RESUMOS
+ *          Resumos mensais das encomendas, gravados com FICHEIRO_DADOS.
+ * @def FICHEIRO_COMPRIMIR
+ *          1 para gravar FICHEIRO_DADOS em blocos comprimidos.
+ * @def FICHEIRO_THREADS
+ *          Threads usadas para carregar FICHEIRO_DADOS e pelas listagens, 0
+ *          para usar todos os processadores.
+ */
+#define FICHEIRO_DADOS "saved_data.bin"
+#define FICHEIRO_DIARIO "saved_data.jrn"
+#define FICHEIRO_RESUMOS "saved_data.res"
+#ifndef FICHEIRO_COMPRIMIR
+#    define FICHEIRO_COMPRIMIR 0
+#endif
+#ifndef FICHEIRO_THREADS
+#    define FICHEIRO_THREADS 0
+#endif
 
 #include "outrasListagens.h"
 
 
 
 
+// Carregar a pedido
+// *********************************************************************************************************************
+/**
+ * @brief         Garante que várias coleções foram carregadas de ficheiro,
+ *                carregando as que faltam ao mesmo tempo e aplicando-lhes as
+ *                alterações do diário na primeira vez que são necessárias.
+ * @param seccoes Coleções a carregar (bit 1 << PERSISTENCIA_ARTIGOS,
+ *                PERSISTENCIA_ENCOMENDAS ou PERSISTENCIA_CLIENTES).
+ */
+static void funcional_exigirSeccoes(const unsigned seccoes) {
+    unsigned pendentes = 0;
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if (((seccoes >> t) & 1) && persistencia_pendente((enum persistencia_tipo) t)) pendentes |= 1u << t;
+    }
+    if (!pendentes) return;
+    protectFcnCall(persistencia_carregarSeccoes(pendentes), "impossível carregar dados de ficheiro");
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if (!((pendentes >> t) & 1)) continue;
+        protectFcnCall(diario_reproduzirSeccao((enum persistencia_tipo) t, &artigos, &encomendas, &clientes),
+                       "diário não é consistente com os dados");
+    }
+}
+
+/**
+ * @brief   Garante que uma coleção foi carregada de ficheiro, carregando-a e
+ *          aplicando-lhe as alterações do diário na primeira vez que é
+ *          necessária.
+ * @param t PERSISTENCIA_ARTIGOS, PERSISTENCIA_ENCOMENDAS ou
+ *          PERSISTENCIA_CLIENTES.
+ */
+void funcional_exigir(const enum persistencia_tipo t) { funcional_exigirSeccoes(1u << t); }
+
+/**
+ * @brief Garante que todas as coleções foram carregadas de ficheiro.
+ */
+void funcional_exigirTudo() {
+    funcional_exigirSeccoes(1u << PERSISTENCIA_ARTIGOS | 1u << PERSISTENCIA_ENCOMENDAS | 1u << PERSISTENCIA_CLIENTES);
+}
+
+
+
+
+// Índices de clientes
+// *********************************************************************************************************************
+/**
+ * @brief   Acrescenta o cliente 'u', no slot 'i', aos índices de clientes, se
+ *          estes já foram construídos. Um NIF ou CC que já esteja num índice
+ *          continua a referir o cliente que lá estava.
+ * @param i Slot do cliente.
+ * @param u Cliente.
+ */
+static void funcional_indexarCliente(const colSize_t i, const utilizador* const u) {
+    if (!clientes_indexados) return;
+    utilizador_chaveNIF nif;
+    utilizador_chaveCC  cc;
+    memcpy(nif.NIF, u->NIF, sizeof(nif.NIF));
+    memcpy(cc.CC, u->CC, sizeof(cc.CC));
+    protectFcnCall(niftab_inserir(&clientes_NIF, &nif, i), "niftab_inserir falhou");
+    protectFcnCall(cctab_inserir(&clientes_CC, &cc, i), "cctab_inserir falhou");
+}
+
+/**
+ * @brief   Chaves retiradas por funcional_desindexarCliente que podem ter
+ *          ficado sem cliente (ver funcional_reporChaves).
+ */
+static struct {
+    utilizador_chaveNIF nif;    ///< NIF retirado
+    utilizador_chaveCC  cc;     ///< CC retirado
+    int                 temNIF; ///< Se 'nif' foi retirado do índice
+    int                 temCC;  ///< Se 'cc' foi retirado do índice
+} clientes_retiradas;
+
+/**
+ * @brief   Retira dos índices de clientes o NIF e o CC do cliente 'u', no slot
+ *          'i', se estes o referirem. As chaves retiradas são repostas por
+ *          funcional_reporChaves se outro cliente as tiver.
+ * @param i Slot do cliente.
+ * @param u Cliente.
+ */
+static void funcional_desindexarCliente(const colSize_t i, const utilizador* const u) {
+    if (!clientes_indexados) return;
+    memcpy(clientes_retiradas.nif.NIF, u->NIF, sizeof(clientes_retiradas.nif.NIF));
+    memcpy(clientes_retiradas.cc.CC, u->CC, sizeof(clientes_retiradas.cc.CC));
+    clientes_retiradas.temNIF = niftab_remover(&clientes_NIF, &clientes_retiradas.nif, i);
+    clientes_retiradas.temCC  = cctab_remover(&clientes_CC, &clientes_retiradas.cc, i);
+}
+
+/**
+ * @brief Volta a acrescentar aos índices as chaves retiradas pelo último
+ *        funcional_desindexarCliente que não voltaram a ser indexadas, se
+ *        outro cliente (com o mesmo NIF ou CC) as tiver. Só percorre os
+ *        clientes se uma chave ficou sem cliente.
+ */
+static void funcional_reporChaves() {
+    if (!clientes_indexados) return;
+    int semNIF = clientes_retiradas.temNIF && niftab_obter(&clientes_NIF, &clientes_retiradas.nif) == COL_INVAL_INDEX;
+    int semCC  = clientes_retiradas.temCC && cctab_obter(&clientes_CC, &clientes_retiradas.cc) == COL_INVAL_INDEX;
+    clientes_retiradas.temNIF = 0;
+    clientes_retiradas.temCC  = 0;
+    COL_PARA_CADA(utilizadorcol, &clientes, u) {
+        if (!semNIF && !semCC) break;
+        if (semNIF && !memcmp(u->NIF, clientes_retiradas.nif.NIF, sizeof(u->NIF))) {
+            protectFcnCall(niftab_inserir(&clientes_NIF, &clientes_retiradas.nif, u_i), "niftab_inserir falhou");
+            semNIF = 0;
+        }
+        if (semCC && !memcmp(u->CC, clientes_retiradas.cc.CC, sizeof(u->CC))) {
+            protectFcnCall(cctab_inserir(&clientes_CC, &clientes_retiradas.cc, u_i), "cctab_inserir falhou");
+            semCC = 0;
+        }
+    }
+}
+
+/**
+ * @brief Garante que os clientes foram carregados e que os índices de clientes
+ *        por NIF e por CC estão construídos. Depois de construídos, os índices
+ *        são mantidos por interface_editar_cliente até ao próximo
+ *        funcional_load.
+ */
+void funcional_exigirIndices() {
+    funcional_exigir(PERSISTENCIA_CLIENTES);
+    if (clientes_indexados) return;
+    niftab_limpar(&clientes_NIF);
+    cctab_limpar(&clientes_CC);
+    protectFcnCall(niftab_reserve(&clientes_NIF, clientes.size), "niftab_reserve falhou");
+    protectFcnCall(cctab_reserve(&clientes_CC, clientes.size), "cctab_reserve falhou");
+    clientes_indexados = 1;
+    for (colSize_t i = 0; i < clientes.size; ++i) {
+        if (utilizadorcol_vivo(&clientes, i)) funcional_indexarCliente(i, &clientes.data[i]);
+    }
+}
+
+/**
+ * @brief   Procura um cliente pelo NIF (9 caracteres) ou pelo número de cartão
+ *          de cidadão (12 caracteres).
+ * @param s NIF ou CC.
+ * @returns O slot do cliente em 'clientes', ou COL_INVAL_INDEX se nenhum
+ *          cliente tiver esse NIF ou CC.
+ */
+colSize_t funcional_procurarCliente(const char* const s) {
+    funcional_exigirIndices();
+    if (strlen(s) == sizeof(((utilizador_chaveNIF*) 0)->NIF)) {
+        utilizador_chaveNIF nif;
+        memcpy(nif.NIF, s, sizeof(nif.NIF));
+        return niftab_obter(&clientes_NIF, &nif);
+    } else if (strlen(s) == sizeof(((utilizador_chaveCC*) 0)->CC)) {
+        utilizador_chaveCC cc;
+        memcpy(cc.CC, s, sizeof(cc.CC));
+        return cctab_obter(&clientes_CC, &cc);
+    }
+    return COL_INVAL_INDEX;
+}
+
+/**
+ * @brief           Percorre as encomendas dos meses entre 'de' e 'ate', tal
+ *                  como encomendacol_iterateFW: primeiro as arquivadas, lendo
+ *                  só os ficheiros desses meses, e depois as encomendas
+ *                  abertas, sem as carregar de ficheiro se ainda não foram
+ *                  carregadas e o diário não as alterou.
+ * @param de        Primeiro mês a percorrer (ver persistencia_mes).
+ * @param ate       Primeiro mês que não é preciso percorrer.
+ * @param predicate Função chamada com cada encomenda, que não a pode alterar.
+ *                  Pode ser chamada com encomendas abertas de outros meses.
+ * @param userData  Dados passados a 'predicate'.
+ */
+void funcional_percorrerMeses(const uint32_t de, const uint32_t ate, encomendacol_pred_t predicate,
+                              void* const userData) {
+    // Os registos adiados podem incluir meses arquivados
+    if (diario_adiado(PERSISTENCIA_ENCOMENDAS)) funcional_exigir(PERSISTENCIA_ENCOMENDAS);
+    protectFcnCall(persistencia_percorrerArquivo(FICHEIRO_DADOS, de, ate, predicate, userData),
+                   "impossível ler o arquivo de encomendas");
+    if (persistencia_pendente(PERSISTENCIA_ENCOMENDAS)) {
+        protectFcnCall(persistencia_percorrerEncomendas(predicate, userData), "impossível ler encomendas do ficheiro");
+    } else
+        encomendacol_iterateFW(&encomendas, predicate, userData);
+}
+
+/**
+ * @brief           Percorre todas as encomendas, arquivadas e abertas, ver
+ *                  funcional_percorrerMeses.
+ * @param predicate Função chamada com cada encomenda, que não a pode alterar.
+ * @param userData  Dados passados a 'predicate'.
+ */
+void funcional_percorrerEncomendas(encomendacol_pred_t predicate, void* const userData) {
+    funcional_percorrerMeses(0, UINT32_MAX, predicate, userData);
+}
+
+/**
+ * @brief   Argumentos de funcional_pred_reduzir.
+ */
+typedef struct {
+    encomendacol_map_t map;       ///< Função de funcional_reduzirEncomendas
+    void*              resultado; ///< Acumulador onde 'map' acrescenta as encomendas
+    void*              userData;  ///< Dados passados a 'map'
+} funcional_reducao;
+
+/**
+ * @brief   Pode ser utilizado como um iterador, acrescenta a encomenda ao
+ *          resultado de funcional_reduzirEncomendas.
+ * @param e Encomenda.
+ * @param r Redução em curso.
+ * @returns 0
+ */
+static int funcional_pred_reduzir(encomenda* const e, funcional_reducao* const r) {
+    r->map(e, r->resultado, r->userData);
+    return 0;
+}
+
+/**
+ * @brief           Reduz todas as encomendas, arquivadas e abertas, a um valor
+ *                  (ver encomendacol_parallelReduce). As encomendas abertas já
+ *                  carregadas são divididas por várias threads, as restantes
+ *                  são lidas de ficheiro e acrescentadas diretamente a
+ *                  'resultado'.
+ * @param map       Acrescenta uma encomenda a um acumulador, pode ser chamada
+ *                  ao mesmo tempo em várias threads.
+ * @param combine   Junta um acumulador parcial a outro.
+ * @param identidade
+ *                  Acumulador vazio, com 'tamanho' bytes.
+ * @param tamanho   Bytes de um acumulador.
+ * @param resultado Acumulador onde juntar o resultado, que tem que começar
+ *                  igual a 'identidade'.
+ * @param userData  Dados passados a 'map' e a 'combine'.
+ */
+void funcional_reduzirEncomendas(encomendacol_map_t map, encomendacol_combine_t combine, const void* const identidade,
+                                 const size_t tamanho, void* const resultado, void* const userData) {
+    funcional_reducao r = {.map = map, .resultado = resultado, .userData = userData};
+    // Os registos adiados podem incluir meses arquivados
+    if (diario_adiado(PERSISTENCIA_ENCOMENDAS)) funcional_exigir(PERSISTENCIA_ENCOMENDAS);
+    protectFcnCall(persistencia_percorrerArquivo(FICHEIRO_DADOS, 0, UINT32_MAX,
+                                                 (encomendacol_pred_t) &funcional_pred_reduzir, &r),
+                   "impossível ler o arquivo de encomendas");
+    if (persistencia_pendente(PERSISTENCIA_ENCOMENDAS)) {
+        protectFcnCall(persistencia_percorrerEncomendas((encomendacol_pred_t) &funcional_pred_reduzir, &r),
+                       "impossível ler encomendas do ficheiro");
+    } else {
+        protectFcnCall(
+            encomendacol_parallelReduce(&encomendas, map, combine, identidade, tamanho, resultado, userData, 0),
+            "encomendacol_parallelReduce falhou");
+    }
+}
+
+/**
+ * @brief Arquiva as encomendas dos meses que já acabaram e retira-as da
+ *        coleção, de modo a que a coleção e o ficheiro de dados só tenham as
+ *        encomendas do mês atual.
+ */
+void funcional_arquivar() {
+    const uint32_t de  = persistencia_mesAberto();
+    const uint32_t fim = persistencia_mes(time(NULL));
+    if (fim <= de) return;
+    if (!persistencia_arquivar(FICHEIRO_DADOS, &encomendas, fim, FICHEIRO_COMPRIMIR)) {
+        menu_printError("impossível arquivar as encomendas de meses anteriores");
+        return;
+    }
+    // Registar antes de retirar, para que o diário reproduza a mesma coleção
+    diario_arquivar(de, fim);
+    persistencia_retirarArquivadas(&encomendas, de, fim);
+}
+
+/**
+ * @brief Garante que os resumos mensais (ver resumo.h) correspondem às
+ *        encomendas, recalculando-os numa passagem por todas as encomendas,
+ *        arquivadas e abertas, se não foram carregados de ficheiro. Depois
+ *        são mantidos por form_editar_encomendaResumida.
+ * @details Tal como em funcional_percorrerEncomendas, as encomendas
+ *          arquivadas e as que ainda não foram carregadas são lidas de
+ *          ficheiro uma a uma. As encomendas abertas já carregadas são
+ *          acrescentadas de uma só vez, com os preços calculados por
+ *          encomenda_CalcPrecoBatch.
+ */
+void funcional_exigirResumos() {
+    if (resumo_valido()) return;
+    funcional_exigir(PERSISTENCIA_ARTIGOS);
+    resumo_invalidar();
+    // Os registos adiados podem incluir meses arquivados
+    if (diario_adiado(PERSISTENCIA_ENCOMENDAS)) funcional_exigir(PERSISTENCIA_ENCOMENDAS);
+    protectFcnCall(persistencia_percorrerArquivo(FICHEIRO_DADOS, 0, UINT32_MAX,
+                                                 (encomendacol_pred_t) &resumo_pred_acrescentar, &artigos),
+                   "impossível ler o arquivo de encomendas");
+    if (persistencia_pendente(PERSISTENCIA_ENCOMENDAS)) {
+        protectFcnCall(persistencia_percorrerEncomendas((encomendacol_pred_t) &resumo_pred_acrescentar, &artigos),
+                       "impossível ler encomendas do ficheiro");
+    } else
+        resumo_acrescentarColecao(&encomendas, &artigos);
+    resumo_validar();
+}
+
+
+
+
 // De interface_imprimir_recibo
 // *********************************************************************************************************************
 /**
  * @brief      Pode ser utilizado como um iterador, imprime encomenda num recibo.
  * @param e    Encomenda a ser impressa
- * @param data Ano e mês do recibo como também alguns dados remetentes ao total
- *             do preço do recibo e artigos compras e encomendas vendidas.
+ * @param data Ano e mês do recibo.
  * @returns    0
  */
-int pred_printencRec(encomenda const* const e, struct {
-    int      ano;
-    int      mes;
-    uint64_t total;
-    uint64_t art;
-    uint64_t compras;
-    uint64_t encomendas;
+int pred_printencRec(encomenda* const e, struct {
+    int ano;
+    int mes;
 } * data) {
     struct tm const* const t = localtime(&e->tempo);
     if (t->tm_mon == data->mes && t->tm_year == data->ano) {
         printf("* Dia %d/%d/%d\n", 1900 + t->tm_year, t->tm_mon + 1, t->tm_mday);
-        printf("    * NOME %s\n", protectStr(clientes.data[e->ID_cliente].nome));
-        printf("    * NIF  %9.9s\n", clientes.data[e->ID_cliente].NIF);
-        printf("    * CC   %12.12s\n", clientes.data[e->ID_cliente].CC);
+        utilizador const* const u = utilizadorcol_obter(&clientes, e->ID_cliente);
+        printf("    * NOME %s\n", u ? protectStr(nomes_str(u->nome)) : "[ REMOVIDO ]");
+        printf("    * NIF  %9.9s\n", u ? u->NIF : "---------");
+        printf("    * CC   %12.12s\n", u ? u->CC : "------------");
         printf("    * ARTIGOS COMPRADOS:\n");
         int64_t   preco_art;
         colSize_t i;
         for (i = 0; i < e->compras.size; i++) {
             // inicio
-            compra const* const c = &e->compras.data[i];
-            artigo const* const a = &artigos.data[c->IDartigo];
-            preco_art             = a->preco_cent;
+            compra const* const c = &compracol_data(&e->compras)[i];
+            artigo const* const a = artigocol_obter(&artigos, c->IDartigo);
+            if (!a) {
+                printf("        * [ ARTIGO REMOVIDO ]");
+                if (compra_temPreco(c)) printf("\t- TOTAL: %ldc", compra_precoIVA(c) * c->qtd);
+                printf("\t- QUANTIDADE: %ld\n", c->qtd);
+                continue;
+            }
+            // Preço e IVA do momento da venda, se foram registados
+            const int64_t preco_base = compra_temPreco(c) ? c->preco_cent : a->preco_cent;
+            const uint8_t iva        = compra_temPreco(c) ? c->iva : (a->meta & ARTIGO_IVA);
+            preco_art                = compra_precoUnitario(c, a);
             printf("        * ");
             // consumo
             printf("CONSUMO %s", (a->meta & ARTIGO_GRUPO_ANIMAL) ? "ANIMAL" : "HUMANO");
             // preço
-            printf("\t- PREÇO %luc\t- IVA", a->preco_cent);
+            printf("\t- PREÇO %luc\t- IVA", preco_base);
             // iva
-            switch (a->meta & ARTIGO_IVA) {
-                case ARTIGO_IVA_INTERMEDIO:
-                    printf(" %d%%", (int) ((ARTIGO_IVA_INTERMEDIO_VAL - 1) * 100));
-                    preco_art *= ARTIGO_IVA_INTERMEDIO_VAL;
-                    break;
-                case ARTIGO_IVA_NORMAL:
-                    printf(" %d%%", (int) ((ARTIGO_IVA_NORMAL_VAL - 1) * 100));
-                    preco_art *= ARTIGO_IVA_NORMAL_VAL;
-                    break;
-                case ARTIGO_IVA_REDUZIDO:
-                    printf(" %d%%", (int) ((ARTIGO_IVA_REDUZIDO_VAL - 1) * 100));
-                    preco_art *= ARTIGO_IVA_REDUZIDO_VAL;
-                    break;
-            }
+            if (iva != ARTIGO_IVA) printf(" %ld%%", artigo_ivaPercentagem[iva]);
             // total
             printf("\t- TOTAL: %ldc", preco_art * c->qtd);
             // quantidade
@@ -130,18 +466,13 @@ int pred_printencRec(encomenda const* const e, struct {
             } else
                 printf("\t- ARTIGO DE VENDA LIVRE ");
             // nome
-            printf("\t\"%s\"", protectStr(a->nome));
+            printf("\t\"%s\"", protectStr(nomes_str(a->nome)));
             // fim
-            data->art += c->qtd;
             printf("\n");
             fflush(stdout);
         }
-        const uint64_t tot = encomenda_CalcPreco(e, &artigos);
-        printf("    * TOTAL %ld\n", tot);
+        printf("    * TOTAL %ld\n", encomenda_total(e, &artigos));
         fflush(stdout);
-        data->compras += i;
-        data->total += tot;
-        data->encomendas += 1;
     }
     return 0;
 }
@@ -152,13 +483,15 @@ int pred_printencRec(encomenda const* const e, struct {
 // De interface_cliente
 // *********************************************************************************************************************
 /**
- * @brief   Pode ser utilizado como um iterador, imprime um utilizador.
+ * @brief   Pode ser utilizado como um iterador, imprime um utilizador com o
+ *          seu slot em 'clientes' como ID.
  * @param u Utilizador a ser impresso.
- * @param i Deve ser inicializado como 0, no final irá conter o número de
- *          clientes impressos.
+ * @param i Deve ser inicializado como 0, no final irá conter o slot do último
+ *          cliente impresso mais 1.
  * @returns 0
  */
 int pred_printUti(utilizador const* const u, int64_t* const i) {
+    *i = u - clientes.data;
     printf("   %8lu   |   ", (*i)++);
     menu_printUtilizador(*u);
     printf("\n");
@@ -182,9 +515,10 @@ int form_editar_cliente(utilizador* const u, int isNew) {
         menu_printHeader("Editar Utilizador");
 
     printf("Inserir nome");
-    if (!isNew) printf(" (%s)", protectStr(u->nome));
-    freeN(u->nome);
-    u->nome = menu_readNotNulStr();
+    if (!isNew) printf(" (%s)", protectStr(nomes_str(u->nome)));
+    char* const nome = menu_readNotNulStr();
+    u->nome          = nomes_inserir(nome);
+    free(nome);
 
     char* tmp = NULL;
     while (1) {
@@ -229,13 +563,15 @@ int form_editar_cliente(utilizador* const u, int isNew) {
 // De interface_artigo
 // *********************************************************************************************************************
 /**
- * @brief   Pode ser utilizado como um iterador, imprime um artigo.
+ * @brief   Pode ser utilizado como um iterador, imprime um artigo com o seu
+ *          slot em 'artigos' como ID.
  * @param a Artigo a ser impresso.
- * @param i Deve ser inicializado como 0, no final irá conter o número de
- *          artigos impressos.
+ * @param i Deve ser inicializado como 0, no final irá conter o slot do último
+ *          artigo impresso mais 1.
  * @returns 0
  */
 int pred_printArt(artigo const* const a, int64_t* const i) {
+    *i = a - artigos.data;
     printf("   %8lu   |   ", (*i)++);
     menu_printArtigoStock(a);
     printf("\n");
@@ -267,9 +603,10 @@ int form_editar_artigo(artigo* const a, int isNew) {
     }
 
     printf("Inserir nome de artigo");
-    if (!isNew) printf(" (%s)", protectStr(a->nome));
-    freeN(a->nome);
-    a->nome = menu_readNotNulStr();
+    if (!isNew) printf(" (%s)", protectStr(nomes_str(a->nome)));
+    char* const nome = menu_readNotNulStr();
+    a->nome          = nomes_inserir(nome);
+    free(nome);
 
     while (1) {
         printf("Inserir preço de artigo (cent)");
@@ -370,9 +707,12 @@ int form_editar_compra(compra* const c, int isNew) {
 
     artigo* art;
     if (!isNew) {
-        art = &artigos.data[c->IDartigo];
-        // Fazer reset do stock
-        art->stock += c->qtd;
+        art = artigocol_obter(&artigos, c->IDartigo);
+        // Fazer reset do stock, se o artigo ainda existir
+        if (art) {
+            art->stock += c->qtd;
+            diario_artigo(COL_SLOT_INDEX(c->IDartigo), art);
+        }
         // Eleminar compra
         printf("Eleminar compra (S / N)");
         int YN = 2;
@@ -383,6 +723,11 @@ int form_editar_compra(compra* const c, int isNew) {
                 case 1: return 0;
             }
         }
+        if (!art) {
+            // Sem o artigo não há stock para vender, a compra fica como estava
+            menu_printError("o artigo desta compra foi removido");
+            return 1;
+        }
     } else {
         // Ler tipo de artigo
         menu_printInfo("escolher artigo");
@@ -393,12 +738,17 @@ int form_editar_compra(compra* const c, int isNew) {
             printf("         -2   |   Reimprimir\n");
             printf("         -1   |   Sair\n");
             max = 0;
-            artigocol_iterateFW(&artigos, (artigocol_pred_t) &pred_printArt, &max);
+            COL_PARA_CADA(artigocol, &artigos, a) pred_printArt(a, &max);
             menu_printInfo("Insira o ID do artigo que será vendido na compra");
             id = menu_readInt64_tMinMax(-2, max - 1);
+            if (id >= 0 && !artigocol_vivo(&artigos, id)) {
+                menu_printError("o artigo %ld foi removido", id);
+                id = -2;
+            }
         }
-        c->IDartigo = id;
+        c->IDartigo = artigocol_handle(&artigos, id);
         art         = &artigos.data[id];
+        compra_registarPreco(c, art);
 
         // Ler receita
         char* tmp = NULL;
@@ -441,6 +791,7 @@ int form_editar_compra(compra* const c, int isNew) {
     if (!isNew) printf(" (%ld)", c->qtd);
     c->qtd = menu_readInt64_tMinMax(1, art->stock);
     art->stock -= c->qtd;
+    diario_artigo(COL_SLOT_INDEX(c->IDartigo), art);
 
     return 1;
 }
@@ -451,7 +802,7 @@ int form_editar_compra(compra* const c, int isNew) {
 // De interface_encomenda
 // *********************************************************************************************************************
 /**
- * @def GENERIC_EDIT(nome, colect, col, col_pred, editfnc, nomenew)
+ * @def GENERIC_EDIT(nome, colect, col, col_pred, editfnc, nomenew, registar)
  *          Macro que implementa uma funcionalidade reutilizada bastantes vezes
  *           para editar uma coleção.
  *          nome - String com o nome dos objetos representados na coleção;
@@ -463,9 +814,12 @@ int form_editar_compra(compra* const c, int isNew) {
  *           o objeto da colção - onde 'a' é o objeto - e isNew é 0 caso o
  *           artigo já exista na coleção;
  *          nomenew - nome da função que cria um novo artigo, com a assinatura
- *           col_type func().
+ *           col_type func();
+ *          registar - função que regista a alteração no diário, com a
+ *           assinatura void func(colSize_t id, col_type* a) onde 'a' é NULL se
+ *           o objeto foi removido.
  */
-#define GENERIC_EDIT(nome, colect, col, col_pred, editfnc, nomenew)                                                    \
+#define GENERIC_EDIT(nome, colect, col, col_pred, editfnc, nomenew, registar)                                          \
     int64_t id = -2;                                                                                                   \
     int64_t max;                                                                                                       \
     while (1) {                                                                                                        \
@@ -477,7 +831,7 @@ int form_editar_compra(compra* const c, int isNew) {
             printf("         -2   |   Reimprimir\n");                                                                  \
             printf("         -1   |   Sair\n");                                                                        \
             max = 0;                                                                                                   \
-            COL_EVAL(colect, _iterateFW)(&col, (COL_EVAL(colect, _pred_t)) & col_pred, &max);                          \
+            COL_PARA_CADA(colect, &col, obj) col_pred(obj, &max);                                                      \
             printf("   %8lu   |   Criar Novo " nome "\n", max++);                                                      \
             menu_printInfo("Insira o ID do " nome " para editar");                                                     \
             id = menu_readInt64_tMinMax(-2, max - 1);                                                                  \
@@ -486,14 +840,69 @@ int form_editar_compra(compra* const c, int isNew) {
             if (id == max - 1) {                                                                                       \
                 /* Novo, adicionar ao vetor*/                                                                          \
                 protectFcnCall(COL_EVAL(colect, _push)(&col, nomenew()), #colect "_push falhou");                      \
+                registar(id, COL_EVAL(colect, _at)(&col, id));                                                         \
             }                                                                                                          \
                                                                                                                        \
             /* id é o ID do cliente a editar */                                                                       \
-            if (!editfnc(&col.data[id], id == max - 1)) {                                                              \
-                COL_EVAL(colect, _DEALOC)(&col.data[id]);                                                              \
+            if (!editfnc(COL_EVAL(colect, _at)(&col, id), id == max - 1)) {                                            \
+                COL_EVAL(colect, _DEALOC)(COL_EVAL(colect, _at)(&col, id));                                            \
                 COL_EVAL(colect, _moveBelow)(&col, id);                                                                \
+                registar(id, NULL);                                                                                    \
                 menu_printInfo(nome " removido.");                                                                     \
+            } else                                                                                                     \
+                registar(id, COL_EVAL(colect, _at)(&col, id));                                                         \
+        } else                                                                                                         \
+            break;                                                                                                     \
+    }
+
+/**
+ * @def SLOTS_EDIT(nome, colect, col, col_pred, editfnc, nomenew, registar)
+ *          Igual a GENERIC_EDIT, para coleções com COL_SLOTS. O ID de cada
+ *          objeto é o seu slot: um objeto novo pode ocupar o slot de um objeto
+ *          removido e remover um objeto não muda o ID dos outros, por isso os
+ *          handles guardados noutros objetos continuam válidos. col_pred tem
+ *          que imprimir o slot de cada objeto e deixar em 'max' o último slot
+ *          impresso mais 1 (ver pred_printArt).
+ */
+#define SLOTS_EDIT(nome, colect, col, col_pred, editfnc, nomenew, registar)                                            \
+    int64_t id = -2;                                                                                                   \
+    int64_t max;                                                                                                       \
+    while (1) {                                                                                                        \
+        id = -2;                                                                                                       \
+        menu_printDiv();                                                                                               \
+        menu_printHeader("Selecione " nome);                                                                           \
+        while (id == -2) {                                                                                             \
+            printf("      ID      |   Item\n");                                                                        \
+            printf("         -2   |   Reimprimir\n");                                                                  \
+            printf("         -1   |   Sair\n");                                                                        \
+            max = 0;                                                                                                   \
+            COL_PARA_CADA(colect, &col, obj) col_pred(obj, &max);                                                      \
+            printf("   %8lu   |   Criar Novo " nome "\n", (uint64_t) col.size);                                        \
+            menu_printInfo("Insira o ID do " nome " para editar");                                                     \
+            id = menu_readInt64_tMinMax(-2, col.size);                                                                 \
+            if (id >= 0 && id < col.size && !COL_EVAL(colect, _vivo)(&col, id)) {                                      \
+                menu_printError(nome " %ld foi removido", id);                                                         \
+                id = -2;                                                                                               \
             }                                                                                                          \
+        }                                                                                                              \
+        if (id != -1) {                                                                                                \
+            const int novo = (id == col.size);                                                                         \
+            if (novo) {                                                                                                \
+                /* Novo, ocupar um slot livre ou acrescentar ao vetor */                                               \
+                const colSize_t h = COL_EVAL(colect, _inserir)(&col, nomenew());                                       \
+                protectFcnCall((h != COL_INVAL_INDEX), #colect "_inserir falhou");                                     \
+                id = COL_SLOT_INDEX(h);                                                                                \
+                registar(id, &col.data[id]);                                                                           \
+            }                                                                                                          \
+                                                                                                                       \
+            /* id é o slot do objeto a editar */                                                                      \
+            if (!editfnc(&col.data[id], novo)) {                                                                       \
+                COL_EVAL(colect, _DEALOC)(&col.data[id]);                                                              \
+                COL_EVAL(colect, _remover)(&col, COL_EVAL(colect, _handle)(&col, id));                                 \
+                registar(id, NULL);                                                                                    \
+                menu_printInfo(nome " removido.");                                                                     \
+            } else                                                                                                     \
+                registar(id, &col.data[id]);                                                                           \
         } else                                                                                                         \
             break;                                                                                                     \
     }
@@ -505,13 +914,20 @@ int form_editar_compra(compra* const c, int isNew) {
  *          encomendas impressas.
  * @returns 0
  */
-int pred_printEnc(encomenda const* const e, int64_t* const i) {
+int pred_printEnc(encomenda* const e, int64_t* const i) {
     printf("   %8lu   |   ", (*i)++);
     menu_printEncomendaBrief(e, &clientes, &artigos);
     printf("\n");
     return 0;
 }
 
+/**
+ * @def DIARIO_COMPRA_ATUAL(J, C)
+ *          Regista no diário a compra 'J' da encomenda 'e' que está a ser
+ *          editada em form_editar_encomenda.
+ */
+#define DIARIO_COMPRA_ATUAL(J, C) diario_compra(encomendacol_indice(&encomendas, e), J, C)
+
 /**
  * @brief       Função responsável por editar todos os parametros de uma
  *              encomenda.
@@ -523,22 +939,43 @@ int pred_printEnc(encomenda const* const e, int64_t* const i) {
  *              terá que ser eleminada pois é inválida.
  */
 int form_editar_encomenda(encomenda* const e, int isNew) {
-    GENERIC_EDIT("Compra", compracol, e->compras, pred_printCom, form_editar_compra, new_compra);
+    GENERIC_EDIT("Compra", compracol, e->compras, pred_printCom, form_editar_compra, new_compra, DIARIO_COMPRA_ATUAL);
+    encomenda_invalidarTotal(e);
     if (!isNew) printf("Deseja alterar o id do cliente? (S / N)");
     if (isNew || menu_YN('S', 'N')) {
         menu_printHeader("Selecione Cliente");
         id = -2;
         while (id == -2) {
             printf("      ID      |   Item\n");
+            printf("         -3   |   Procurar por NIF ou CC\n");
             printf("         -2   |   Reimprimir\n");
             printf("         -1   |   Sair\n");
             max = 0;
-            utilizadorcol_iterateFW(&clientes, (utilizadorcol_pred_t) &pred_printUti, &max);
+            COL_PARA_CADA(utilizadorcol, &clientes, u) pred_printUti(u, &max);
             menu_printInfo("Insira o ID do Cliente");
-            id = menu_readInt64_tMinMax(-2, max - 1);
+            id = menu_readInt64_tMinMax(-3, max - 1);
+            if (id == -3) {
+                printf("Inserir NIF ou CC");
+                char* const     s = menu_readNotNulStr();
+                const colSize_t i = funcional_procurarCliente(s);
+                free(s);
+                if (i == COL_INVAL_INDEX) {
+                    menu_printError("nenhum cliente tem esse NIF ou CC");
+                    id = -2;
+                    continue;
+                }
+                id = i;
+                printf("   %8lu   |   ", id);
+                menu_printUtilizador(clientes.data[id]);
+                printf("\n");
+            }
+            if (id >= 0 && !utilizadorcol_vivo(&clientes, id)) {
+                menu_printError("o cliente %ld foi removido", id);
+                id = -2;
+            }
         }
         if (id != -1) {
-            e->ID_cliente = id;
+            e->ID_cliente = utilizadorcol_handle(&clientes, id);
         } else
             return 1;
     }
@@ -552,31 +989,122 @@ int form_editar_encomenda(encomenda* const e, int isNew) {
 // De inteface_diretor
 // *********************************************************************************************************************
 
+/**
+ * @brief   Regista a alteração do cliente 'i' no diário, invalida o índice de
+ *          clientes por NIF e volta a acrescentar o cliente aos índices de
+ *          clientes. Uma chave que deixou de ter cliente passa para outro
+ *          cliente com o mesmo NIF ou CC, se existir.
+ * @param i Slot do cliente.
+ * @param u O cliente depois da alteração, ou NULL se foi removido.
+ */
+void funcional_registarCliente(const colSize_t i, const utilizador* const u) {
+    diario_cliente(i, u);
+    listagens_invalidarNIF();
+    if (u) funcional_indexarCliente(i, u);
+    funcional_reporChaves();
+}
+
+/**
+ * @brief       Retira o cliente dos índices de clientes e edita-o com
+ *              form_editar_cliente; funcional_registarCliente volta a
+ *              acrescentá-lo com o NIF e o CC novos.
+ * @param u     Cliente a editar.
+ * @param isNew Deve ser 1 se cliente é novo.
+ * @returns     O resultado de form_editar_cliente.
+ */
+int form_editar_clienteIndexado(utilizador* const u, int isNew) {
+    funcional_desindexarCliente(u - clientes.data, u);
+    return form_editar_cliente(u, isNew);
+}
+
+/**
+ * @brief       Retira a encomenda dos resumos mensais e edita-a com
+ *              form_editar_encomenda; se a encomenda não for removida volta a
+ *              ser acrescentada com o cliente, a data e as compras novas.
+ * @param e     Encomenda a editar.
+ * @param isNew Deve ser 1 se a encomenda é nova.
+ * @returns     O resultado de form_editar_encomenda.
+ */
+int form_editar_encomendaResumida(encomenda* const e, int isNew) {
+    if (!isNew) resumo_retirar(e, &artigos);
+    const int editada = form_editar_encomenda(e, isNew);
+    if (editada) resumo_acrescentar(e, &artigos);
+    return editada;
+}
+
 /**
  * @brief Premite editar clientes.
  */
 void interface_editar_cliente() {
-    GENERIC_EDIT("Cliente", utilizadorcol, clientes, pred_printUti, form_editar_cliente, newUtilizador);
+    funcional_exigir(PERSISTENCIA_CLIENTES);
+    SLOTS_EDIT("Cliente", utilizadorcol, clientes, pred_printUti, form_editar_clienteIndexado, newUtilizador,
+               funcional_registarCliente);
+}
+
+/**
+ * 1 se a última edição com form_editar_artigoPreco mudou o preço, a taxa de
+ * IVA ou a existência de um artigo que já existia, consumido por
+ * funcional_registarArtigo.
+ */
+static int funcional_artigoMudouPreco = 0;
+
+/**
+ * @brief       Edita o artigo com form_editar_artigo e marca se o preço, a
+ *              taxa de IVA ou a existência do artigo mudaram. Um artigo novo
+ *              tem um handle que nenhuma compra usa, por isso criá-lo,
+ *              editá-lo ou removê-lo não muda o preço de nenhuma encomenda.
+ * @param a     Artigo a editar.
+ * @param isNew Deve ser 1 se o artigo é novo.
+ * @returns     O resultado de form_editar_artigo.
+ */
+int form_editar_artigoPreco(artigo* const a, int isNew) {
+    const int64_t preco  = a->preco_cent;
+    const uint8_t iva    = a->meta & ARTIGO_IVA;
+    const int     editou = form_editar_artigo(a, isNew);
+    funcional_artigoMudouPreco = !isNew && (!editou || a->preco_cent != preco || (a->meta & ARTIGO_IVA) != iva);
+    return editou;
+}
+
+/**
+ * @brief   Regista a alteração do artigo 'i' no diário e, se o preço, a taxa
+ *          de IVA ou a existência do artigo mudaram (ver
+ *          form_editar_artigoPreco), invalida os totais guardados nas
+ *          encomendas e os resumos que dependem do preço atual dos artigos.
+ * @param i Slot do artigo.
+ * @param a O artigo depois da alteração, ou NULL se foi removido.
+ */
+void funcional_registarArtigo(const colSize_t i, const artigo* const a) {
+    diario_artigo(i, a);
+    if (funcional_artigoMudouPreco) {
+        artigo_mudouPreco();
+        resumo_mudouPreco();
+    }
+    funcional_artigoMudouPreco = 0;
 }
 
 /**
  * @brief Premite editar artigos.
  */
 void interface_editar_artigo() {
-    GENERIC_EDIT("Artigo", artigocol, artigos, pred_printArt, form_editar_artigo, newArtigo);
+    funcional_exigir(PERSISTENCIA_ARTIGOS);
+    SLOTS_EDIT("Artigo", artigocol, artigos, pred_printArt, form_editar_artigoPreco, newArtigo, funcional_registarArtigo);
 }
 
 /**
  * @brief Premite editar encomendas.
  */
 void interface_editar_encomenda() {
-    GENERIC_EDIT("Encomenda", encomendacol, encomendas, pred_printEnc, form_editar_encomenda, newEncomenda);
+    funcional_exigirTudo();
+    GENERIC_EDIT("Encomenda", encomendacol, encomendas, pred_printEnc, form_editar_encomendaResumida, newEncomenda,
+                 diario_encomenda);
 }
 
 /**
  * @brief Premite imprimir um recibo para um certo mês.
  */
 void interface_imprimir_recibo() {
+    funcional_exigir(PERSISTENCIA_ARTIGOS);
+    funcional_exigir(PERSISTENCIA_CLIENTES);
     printf("Inserir ano");
     int64_t ano = menu_readInt64_t();
     menu_printInfo("Inserir mês");
@@ -614,24 +1142,20 @@ PRINT_BEGUIN:
 
     printf("\n*** Mês do recibo: %lu/%lu\n", ano, mes);
     struct {
-        int      ano;
-        int      mes;
-        uint64_t total;
-        uint64_t art;
-        uint64_t compras;
-        uint64_t encomendas;
+        int ano;
+        int mes;
     } data;
-    data.ano        = ((int) ano) - 1900;
-    data.mes        = ((int) mes) - 1;
-    data.total      = 0;
-    data.art        = 0;
-    data.compras    = 0;
-    data.encomendas = 0;
-    encomendacol_iterateFW(&encomendas, (encomendacol_pred_t) &pred_printencRec, &data);
-    printf("*** Artigos vendidos neste mês: %ld\n", data.art);
-    printf("*** Compras vendidas neste mês: %ld\n", data.compras);
-    printf("*** Encomendas vendidas neste mês: %ld\n", data.encomendas);
-    printf("*** Total mensal: %ld c\n", data.total);
+    data.ano = ((int) ano) - 1900;
+    data.mes = ((int) mes) - 1;
+    funcional_exigirResumos();
+    funcional_percorrerMeses((uint32_t) ano * 12 + mes - 1, (uint32_t) ano * 12 + mes,
+                             (encomendacol_pred_t) &pred_printencRec, &data);
+    // Totais do mês lidos dos resumos, sem os somar encomenda a encomenda
+    const resumo* const r = resumo_obter(RESUMO_TODOS, (uint32_t) ano * 12 + mes - 1);
+    printf("*** Artigos vendidos neste mês: %ld\n", r ? r->artigos : 0);
+    printf("*** Compras vendidas neste mês: %ld\n", r ? r->compras : 0);
+    printf("*** Encomendas vendidas neste mês: %ld\n", r ? r->encomendas : 0);
+    printf("*** Total mensal: %ld c\n", r ? r->total : 0);
     menu_printHeader("Final do Recibo");
     menu_printDiv();
 
@@ -648,20 +1172,24 @@ PRINT_BEGUIN:
  * @brief Listagens proporstas pelo aluno.
  */
 void interface_outras_listagens() {
+    funcional_exigir(PERSISTENCIA_ARTIGOS);
+    funcional_exigir(PERSISTENCIA_CLIENTES);
     // TODO: Finalizar mplementação
     while (1) {
         menu_printDiv();
         menu_printHeader("Listagens Extra");
-        switch (menu_selection(&(strcol) {.size = 3,
+        switch (menu_selection(&(strcol) {.size = 4,
                                           .data = (char*[]) {
-                                              "Recibo individual",         // 0
-                                              "Pesquisa",                  // 1
-                                              "Clientes que mais gastaram" // 2
+                                              "Recibo individual",          // 0
+                                              "Pesquisa",                   // 1
+                                              "Clientes que mais gastaram", // 2
+                                              "Clientes por NIF"            // 3
                                           }})) {
             case -1: return;
             case 0: listagem_imprimir_recibo(); break;
             case 1: listagem_procura(); break;
             case 2: listagem_utiMaisGasto(); break;
+            case 3: listagem_clientesPorNIF(); break;
         }
     }
 }
@@ -677,11 +1205,18 @@ void interface_outras_listagens() {
 void interface_criar_encomenda() {
     menu_printDiv();
     menu_printHeader("Adicionar Compras a Nova Encomenda");
-    encomendacol_push(&encomendas, newEncomenda());
-    if (!form_editar_encomenda(&encomendas.data[encomendas.size - 1], 1)) {
-        freeEncomenda(&encomendas.data[encomendas.size - 1]);
+    funcional_exigirTudo();
+    protectFcnCall(encomendacol_push(&encomendas, newEncomenda()), "encomendacol_push falhou");
+    // Com COL_SEGMENTOS 'e' continua válido mesmo que sejam acrescentadas encomendas
+    const colSize_t  id = encomendas.size - 1;
+    encomenda* const e  = encomendacol_at(&encomendas, id);
+    diario_encomenda(id, e);
+    if (!form_editar_encomendaResumida(e, 1)) {
+        freeEncomenda(e);
         encomendacol_pop(&encomendas);
-    }
+        diario_encomenda(id, NULL);
+    } else
+        diario_encomenda(id, e);
 }
 
 
@@ -689,12 +1224,120 @@ void interface_criar_encomenda() {
 
 // De interface_inicio
 // *********************************************************************************************************************
+static uint64_t funcional_gravarGeracao = 0;  ///< Geração do ficheiro a ser gravado em segundo plano
+static uint64_t funcional_gravarDiario  = 0;  ///< Tamanho do diário quando a gravação começou
+static int      funcional_gravarPct     = -1; ///< Último progresso mostrado
+
+/**
+ * @brief        Trata o fim de uma gravação em segundo plano: o diário passa a
+ *               conter só as alterações feitas depois de a gravação ter
+ *               começado.
+ * @param estado Estado da gravação.
+ */
+void funcional_acabarGravacao(const enum persistencia_fundo estado) {
+    if (estado == PERSISTENCIA_FUNDO_CONCLUIDA) {
+        protectFcnCall(diario_rodar(FICHEIRO_DIARIO, funcional_gravarGeracao, funcional_gravarDiario),
+                       "impossível recomeçar o diário");
+        menu_printInfo("ficheiro gravado");
+    } else if (estado == PERSISTENCIA_FUNDO_FALHOU) {
+        menu_printError("impossível escrever dados no ficheiro");
+    }
+    if (estado != PERSISTENCIA_FUNDO_A_GRAVAR) funcional_gravarPct = -1;
+}
+
+/**
+ * @brief Mostra o progresso da gravação em segundo plano e trata o seu fim.
+ */
+void funcional_verificarGravacao() {
+    int                           pct;
+    const enum persistencia_fundo estado = persistencia_estadoFundo(&pct);
+    if (estado == PERSISTENCIA_FUNDO_A_GRAVAR && pct != funcional_gravarPct) {
+        menu_printInfo("a gravar em segundo plano: %d%%", pct);
+        funcional_gravarPct = pct;
+    }
+    funcional_acabarGravacao(estado);
+}
+
+/**
+ * @brief Espera pela gravação em segundo plano, se houver uma.
+ */
+void funcional_esperarGravacao() { funcional_acabarGravacao(persistencia_esperarFundo()); }
+
+/**
+ * @brief Responsavél por gravar os dados em ficheiro (um checkpoint do diário).
+ * @details A gravação é feita em segundo plano sobre uma cópia das coleções
+ *          tal como estão agora; o programa continua a registar alterações
+ *          no diário, que passam para o diário da nova geração quando a
+ *          gravação acaba (funcional_verificarGravacao).
+ */
+void funcional_save() {
+    menu_printDiv();
+    if (funcional_gravarPct >= 0) {
+        menu_printInfo("já está a ser gravado um ficheiro");
+        return;
+    }
+    funcional_exigirTudo();
+    funcional_arquivar();
+    funcional_gravarGeracao = diario_geracao() + 1;
+    funcional_gravarDiario  = diario_tamanho();
+    funcional_gravarPct     = 0;
+    if (!persistencia_gravarFundo(FICHEIRO_DADOS, funcional_gravarGeracao, funcional_gravarDiario, FICHEIRO_COMPRIMIR,
+                                  &artigos, &encomendas, &clientes)) {
+        funcional_gravarPct = -1;
+        menu_printError("impossível escrever dados no ficheiro");
+        return;
+    }
+    // Os resumos correspondem às coleções copiadas, por isso têm a mesma geração
+    if (resumo_valido() && !resumo_gravar(FICHEIRO_RESUMOS, funcional_gravarGeracao))
+        menu_printError("impossível escrever os resumos mensais no ficheiro");
+    menu_printInfo("a gravar em segundo plano");
+    funcional_verificarGravacao();
+}
+
+/**
+ * @brief Responsavél por carregar o estado de ficheiro e do diário.
+ */
+void funcional_load() {
+    menu_printDiv();
+    funcional_esperarGravacao();
+    menu_printInfo("a carregar de ficheiro");
+
+    // Eliminar dados
+    artigocol_free(&artigos);
+    encomendacol_free(&encomendas);
+    utilizadorcol_free(&clientes);
+    nomes_libertar();
+    listagens_invalidarNIF();
+    clientes_indexados = 0;
+    resumo_libertar();
+
+    // Carregar artigos, encomendas e clientes
+    uint64_t geracao = 0, diario = 0;
+    if (access(FICHEIRO_DADOS, F_OK) == 0) {
+        protectFcnCall(persistencia_carregar(FICHEIRO_DADOS, &geracao, &diario, &artigos, &encomendas, &clientes),
+                       "impossível carregar dados de ficheiro");
+    } else
+        persistencia_fechar();
+
+    // Aplicar as alterações feitas depois da última gravação
+    protectFcnCall(diario_reproduzir(FICHEIRO_DIARIO, geracao, diario, &artigos, &encomendas, &clientes),
+                   "impossível abrir o diário");
+
+    // Os resumos gravados só servem se o diário não alterou as encomendas, nem
+    // os artigos de que dependem as compras sem o preço registado
+    if (!diario_alterouEncomendas() && resumo_carregar(FICHEIRO_RESUMOS, geracao) && diario_alterouArtigos())
+        resumo_mudouPreco();
+    menu_printInfo("dados carregados");
+}
+
 /**
  * @brief As opções que remetem ao diretor.
  */
 void interface_diretor() {
     int64_t i;
     while (1) {
+        funcional_verificarGravacao();
+        if (diario_precisaCompactar() && funcional_gravarPct < 0) funcional_save();
         menu_printDiv();
         menu_printHeader("Menu de Diretor Clínico");
         switch (menu_selection(&(strcol) {.size = 6,
@@ -713,8 +1356,13 @@ void interface_diretor() {
             case 3:
                 menu_printDiv();
                 menu_printHeader("Stock");
+                funcional_exigir(PERSISTENCIA_ARTIGOS);
                 i = 0;
-                artigocol_iterateFW(&artigos, (artigocol_pred_t) &pred_printArt, &i);
+                COL_PARA_CADA(artigocol, &artigos, a) pred_printArt(a, &i);
+                artigo_colunas colunas = {0};
+                protectFcnCall(artigo_colunasCarregar(&colunas, &artigos), "artigo_colunasCarregar falhou");
+                printf("*** Valor do stock (sem IVA): %ld c\n", artigo_colunasValorStock(&colunas));
+                artigo_colunasLibertar(&colunas);
                 break;
             case 4: interface_imprimir_recibo(); break;
             case 5: interface_outras_listagens(); break;
@@ -728,6 +1376,8 @@ void interface_diretor() {
 void interface_funcionario() {
     int64_t i;
     while (1) {
+        funcional_verificarGravacao();
+        if (diario_precisaCompactar() && funcional_gravarPct < 0) funcional_save();
         menu_printDiv();
         menu_printHeader("Menu de Funcionário");
         switch (menu_selection(&(strcol) {.size = 3,
@@ -744,65 +1394,18 @@ void interface_funcionario() {
             case 3:
                 menu_printDiv();
                 menu_printHeader("Stock");
+                funcional_exigir(PERSISTENCIA_ARTIGOS);
                 i = 0;
-                artigocol_iterateFW(&artigos, (artigocol_pred_t) &pred_printArt, &i);
+                COL_PARA_CADA(artigocol, &artigos, a) pred_printArt(a, &i);
+                artigo_colunas colunas = {0};
+                protectFcnCall(artigo_colunasCarregar(&colunas, &artigos), "artigo_colunasCarregar falhou");
+                printf("*** Valor do stock (sem IVA): %ld c\n", artigo_colunasValorStock(&colunas));
+                artigo_colunasLibertar(&colunas);
                 break;
         }
     }
 }
 
-/**
- * @brief Responsavél por gravar os dados em ficheiro.
- */
-void funcional_save() {
-    menu_printDiv();
-    menu_printInfo("a escrever em ficheiro");
-
-    // Abrir ficheiro
-    FILE* dataFile;
-    protectVarFcnCall(dataFile, fopen("saved_data.bin", "wb"), "ficheiro não pode ser aberto");
-
-    // Escrever artigos
-    protectFcnCall(artigocol_write(&artigos, dataFile), "impossível escrever artigos no ficheiro");
-
-    // Escrever encomendas
-    protectFcnCall(encomendacol_write(&encomendas, dataFile), "impossível escrever encomendas no ficheiro");
-
-    // Escrever clientes
-    protectFcnCall(utilizadorcol_write(&clientes, dataFile), "impossível escrever clientes no ficheiro");
-
-    fclose(dataFile);
-    menu_printInfo("ficheiro gravado");
-}
-
-/**
- * @brief Responsavél por carregar o estado de ficheiro.
- */
-void funcional_load() {
-    menu_printDiv();
-    menu_printInfo("a carregar de ficheiro");
-
-    // Eliminar dados
-    artigocol_free(&artigos);
-    encomendacol_free(&encomendas);
-    utilizadorcol_free(&clientes);
-
-    // Abrir ficheiro
-    FILE* dataFile;
-    protectVarFcnCall(dataFile, fopen("saved_data.bin", "rb"), "ficheiro não pode ser aberto");
-
-    // Carregar artigos
-    protectFcnCall(artigocol_read(&artigos, dataFile), "impossível carregar artigos de ficheiro");
-
-    // Carregar encomendas
-    protectFcnCall(encomendacol_read(&encomendas, dataFile), "impossível carregar encomendas de ficheiro");
-
-    // Carregar clientes
-    protectFcnCall(utilizadorcol_read(&clientes, dataFile), "impossível carregar clientes de ficheiro");
-
-    fclose(dataFile);
-    menu_printInfo("dados carregados");
-}
 
 
 
@@ -815,6 +1418,7 @@ void funcional_load() {
 void interface_inicio() {
     char* login = NULL;
     while (1) {
+        funcional_verificarGravacao();
         switch (menu_selection(&(strcol) {.size = 3,
                                           .data = (char*[]) {
                                               "Log in",         // 0
@@ -881,16 +1485,28 @@ int main() {
     menu_printDiv();
     menu_printHeader("A Iniciar");
     setlocale(LC_ALL, "en_US.UTF-8");
-    artigos    = artigocol_new();
-    encomendas = encomendacol_new();
-    clientes   = utilizadorcol_new();
+    artigos      = artigocol_new();
+    encomendas   = encomendacol_new();
+    clientes     = utilizadorcol_new();
+    clientes_NIF = niftab_new();
+    clientes_CC  = cctab_new();
+    paralelo_definirThreads(FICHEIRO_THREADS);
+    funcional_load();
 
     interface_inicio();
 
     menu_printHeader("A Terminar");
+    funcional_esperarGravacao();
     artigocol_free(&artigos);
     encomendacol_free(&encomendas);
     utilizadorcol_free(&clientes);
+    niftab_free(&clientes_NIF);
+    cctab_free(&clientes_CC);
+    listagens_libertar();
+    nomes_libertar();
+    resumo_libertar();
+    persistencia_fechar();
+    diario_fechar();
     menu_printDiv();
 
     return 0;
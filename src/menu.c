@@ -146,7 +146,7 @@ int64_t menu_selection(const strcol* const itens) {
         printf("         -2   |   Reimprimir\n");
         printf("         -1   |   Sair\n");
         max = 0;
-        strcol_iterateFW((strcol*) itens, (strcol_pred_t) &pred_printItem, &max);
+        COL_PARA_CADA(strcol, itens, item) pred_printItem(item, &max);
         op = menu_readInt64_tMinMax(-2, max - 1);
     }
     return op;
@@ -232,18 +232,19 @@ void menu_printHeader(const char* header) {
  * @param av Coleção de artigos ao qual o ID dos artigos na encomenda faz
  *           referência.
  */
-void menu_printEncomendaBrief(const encomenda* const e, const utilizadorcol* const uv, const artigocol* const av) {
+void menu_printEncomendaBrief(encomenda* const e, const utilizadorcol* const uv, const artigocol* const av) {
 
-    struct tm* lt = localtime(&e->tempo);
+    const utilizador* const u  = utilizadorcol_obter(uv, e->ID_cliente);
+    struct tm*              lt = localtime(&e->tempo);
     printf("Cliente: %s NIF:(%.9s) Data: %d/%d/%d %d:%d  -  TOTAL: %ldc",
-           protectStr(uv->data[e->ID_cliente].nome), //
-           uv->data[e->ID_cliente].NIF,              //
+           u ? protectStr(nomes_str(u->nome)) : "[ REMOVIDO ]", //
+           u ? u->NIF : "---------",                 //
            1900 + lt->tm_year,                       //
            1 + lt->tm_mon,                           //
            lt->tm_mday,                              //
            lt->tm_hour,                              //
            lt->tm_min,                               //
-           encomenda_CalcPreco(e, av)                //
+           encomenda_total(e, av)                    //
     );
 }
 
@@ -252,7 +253,7 @@ void menu_printEncomendaBrief(const encomenda* const e, const utilizadorcol* con
  * @param u Utilizador para ser impresso.
  */
 void menu_printUtilizador(const utilizador u) {
-    printf("NIF: %.9s CC: %12.12s Nome: %s", u.NIF, u.CC, protectStr(u.nome));
+    printf("NIF: %.9s CC: %12.12s Nome: %s", u.NIF, u.CC, protectStr(nomes_str(u.nome)));
 }
 
 /**
@@ -269,7 +270,7 @@ void menu_printArtigo(const artigo* const a) {
 
     printf("%s%s -  Preço: %ldc + (IVA %s)  -  Grupo %s %s",
            (a->meta & ARTIGO_DESATIVADO) ? "[ DESATIVADO ]" : "",                      //
-           protectStr(a->nome),                                                        //
+           protectStr(nomes_str(a->nome)),                                             //
            a->preco_cent,                                                              //
            iva,                                                                        //
            (a->meta & ARTIGO_GRUPO_ANIMAL) ? "animal" : "humano",                      //
@@ -283,7 +284,11 @@ void menu_printArtigo(const artigo* const a) {
  */
 void menu_printCompra(const compra* const c, const artigocol* const av) {
     printf("QTD: %lu  |  ", c->qtd);
-    menu_printArtigo(&(av->data[c->IDartigo]));
+    const artigo* const a = artigocol_obter(av, c->IDartigo);
+    if (a)
+        menu_printArtigo(a);
+    else
+        printf("[ ARTIGO REMOVIDO ]");
 }
 
 /**
@@ -299,7 +304,7 @@ void menu_printArtigoStock(const artigo* const a) {
     }
 
     printf("%s (%ld em stock) -  Preço: %ldc + (IVA %s)  -  Grupo %s %s %s",
-           protectStr(a->nome),                                                         //
+           protectStr(nomes_str(a->nome)),                                              //
            a->stock,                                                                    //
            a->preco_cent,                                                               //
            iva,                                                                         //
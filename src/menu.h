@@ -26,6 +26,8 @@
 #    define encomendacol_H
 #    define COL_TIPO encomenda
 #    define COL_NOME encomendacol
+#    define COL_PARALELO
+#    define COL_SEGMENTOS
 #    define COL_DEALOC(X) freeEncomenda(X)
 #    define COL_WRITE(X, F) save_encomenda(F, X)
 #    define COL_READ(X, F) load_encomenda(F, X)
@@ -46,6 +48,7 @@
 #    define utilizadorcol_H
 #    define COL_TIPO utilizador
 #    define COL_NOME utilizadorcol
+#    define COL_SLOTS
 #    define COL_DEALOC(X) freeUtilizador(X)
 #    define COL_WRITE(X, F) save_utilizador(F, X)
 #    define COL_READ(X, F) load_utilizador(F, X)
@@ -66,6 +69,6 @@ void    menu_printCompra(const compra* const c, const artigocol* const av);
 int64_t menu_readInt64_t();
 int     menu_YN(const char Y, const char N);
 
-void menu_printEncomendaBrief(const encomenda* const e, const utilizadorcol* const uv, const artigocol* const av);
+void menu_printEncomendaBrief(encomenda* const e, const utilizadorcol* const uv, const artigocol* const av);
 
 #endif
@@ -0,0 +1,221 @@
+/**
+ * @file    nomes.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Tabela de nomes: os nomes dos artigos e dos clientes são guardados
+ *          uma só vez, seguidos num único bloco de memória, e referidos por
+ *          um id de 32 bits.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#define _POSIX_C_SOURCE 200809L // strnlen
+#include "nomes.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "utilities.h"
+
+#define COL_PRE
+#include "colecao.h"
+
+char*         nomes_dados     = NULL; ///< Nomes terminados em '\0', seguidos
+size_t        nomes_n         = 0;    ///< Bytes utilizados em 'nomes_dados'
+static size_t nomes_alocado   = 0;    ///< Bytes alocados em 'nomes_dados'
+static size_t nomes_indexados = 0;    ///< Bytes de 'nomes_dados' cujos nomes já estão em 'nomes_tabela'
+
+#define COL_IMPLEMENTACAO
+#define TAB_TIPO nomes_id
+#define TAB_NOME nomestab
+#define TAB_HASH(K) fnv1a(nomes_dados + *(K), strlen(nomes_dados + *(K)), FNV1A_INICIO)
+#define TAB_IGUAL(A, B) (strcmp(nomes_dados + *(A), nomes_dados + *(B)) == 0)
+#include "tabela.h"
+#define TAB_TIPO nomes_id
+#define TAB_NOME nomesgravtab
+#include "tabela.h"
+#undef COL_IMPLEMENTACAO
+
+static nomestab     nomes_tabela;              ///< Id de cada nome, procurado pelo próprio nome
+static nomesgravtab nomes_gravacao;            ///< Offset no bloco gravado de cada id já gravado
+static nomes_id*    nomes_ordem        = NULL; ///< Ids gravados, pela ordem em que foram gravados
+static size_t       nomes_nOrdem       = 0;    ///< Número de ids em 'nomes_ordem'
+static size_t       nomes_alocadoOrdem = 0;    ///< Ids alocados em 'nomes_ordem'
+static uint64_t     nomes_tamGravado   = 0;    ///< Tamanho do bloco gravado
+
+/**
+ * @brief       Garante que 'nomes_dados' tem espaço para mais 'tam' bytes.
+ * @param tam   Número de bytes.
+ * @returns     0 se não conseguiu alocar memória ou se a tabela ficaria com
+ *              mais de NOMES_NENHUM bytes.
+ * @returns     1 se conseguiu.
+ */
+static int nomes_reservar(const size_t tam) {
+    if (tam >= NOMES_NENHUM - nomes_n) return 0;
+    if (nomes_n + tam <= nomes_alocado) return 1;
+    size_t novo = nomes_alocado ? nomes_alocado : 4096;
+    while (novo < nomes_n + tam) novo *= 2;
+    if (novo > NOMES_NENHUM) novo = NOMES_NENHUM;
+    char* const dados = realloc(nomes_dados, novo);
+    if (!dados) return 0;
+    nomes_dados   = dados;
+    nomes_alocado = novo;
+    return 1;
+}
+
+/**
+ * @brief       Acrescenta a 'nomes_tabela' os nomes que ainda não estão lá
+ *              (os nomes copiados por nomes_adotar).
+ * @returns     0 se não conseguiu alocar memória.
+ * @returns     1 se conseguiu.
+ */
+static int nomes_indexar() {
+    while (nomes_indexados < nomes_n) {
+        const nomes_id id = (nomes_id) nomes_indexados;
+        if (!nomestab_inserir(&nomes_tabela, &id, id)) return 0;
+        nomes_indexados += strlen(nomes_dados + id) + 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief       Insere um nome na tabela, se ainda não existir.
+ * @param s     Nome.
+ * @returns     O id do nome.
+ * @returns     NOMES_NENHUM se 's' for NULL ou se não conseguiu alocar memória.
+ * @warning     's' não pode apontar para a própria tabela de nomes.
+ */
+nomes_id nomes_inserir(const char* const s) { return s ? nomes_inserirTam(s, strlen(s)) : NOMES_NENHUM; }
+
+/**
+ * @brief       Insere um nome com 'tam' bytes, que não tem que ser terminado
+ *              por '\0', na tabela, se ainda não existir.
+ * @param s     Nome.
+ * @param tam   Tamanho do nome (o nome acaba no primeiro '\0', se existir).
+ * @returns     O id do nome.
+ * @returns     NOMES_NENHUM se 's' for NULL ou se não conseguiu alocar memória.
+ * @warning     's' não pode apontar para a própria tabela de nomes.
+ */
+nomes_id nomes_inserirTam(const char* const s, const size_t tam) {
+    if (!s) return NOMES_NENHUM;
+    const size_t len = strnlen(s, tam);
+    if (!nomes_indexar() || !nomes_reservar(len + 1)) return NOMES_NENHUM;
+    // O nome é copiado para o fim da tabela para ser procurado, mas só conta
+    // para 'nomes_n' se ainda não existir
+    const nomes_id novo = (nomes_id) nomes_n;
+    memcpy(nomes_dados + novo, s, len);
+    nomes_dados[novo + len] = '\0';
+    const colSize_t id      = nomestab_obter(&nomes_tabela, &novo);
+    if (id != COL_INVAL_INDEX) return (nomes_id) id;
+    if (!nomestab_inserir(&nomes_tabela, &novo, novo)) return NOMES_NENHUM;
+    nomes_n += len + 1;
+    nomes_indexados = nomes_n;
+    return novo;
+}
+
+/**
+ * @brief       Copia o bloco de strings de um ficheiro de dados para a tabela
+ *              de nomes, se esta estiver vazia, de modo a que o offset de cada
+ *              string no bloco seja o seu id.
+ * @details     Os nomes só são acrescentados ao índice de nomes quando for
+ *              inserido o próximo nome.
+ * @param bloco Strings terminadas em '\0', seguidas.
+ * @param tam   Tamanho do bloco, em que o último byte é '\0'.
+ * @returns     1 se copiou o bloco.
+ * @returns     0 se a tabela não estava vazia ou se não conseguiu alocar
+ *              memória (os nomes do bloco têm que ser inseridos um a um).
+ */
+int nomes_adotar(const char* const bloco, const size_t tam) {
+    if (nomes_n != 0 || !nomes_reservar(tam)) return 0;
+    memcpy(nomes_dados, bloco, tam);
+    nomes_n         = tam;
+    nomes_indexados = 0;
+    nomestab_limpar(&nomes_tabela);
+    return 1;
+}
+
+/**
+ * @brief       Liberta a tabela de nomes, todos os ids deixam de ser válidos.
+ */
+void nomes_libertar() {
+    free(nomes_dados);
+    nomes_dados     = NULL;
+    nomes_n         = 0;
+    nomes_alocado   = 0;
+    nomes_indexados = 0;
+    nomestab_free(&nomes_tabela);
+    nomes_acabarGravacao();
+}
+
+/**
+ * @brief       Começa um novo bloco de strings para gravar, vazio.
+ */
+void nomes_comecarGravacao() {
+    nomesgravtab_limpar(&nomes_gravacao);
+    nomes_nOrdem     = 0;
+    nomes_tamGravado = 0;
+}
+
+/**
+ * @brief       Reserva o nome 'id' no bloco de strings a gravar, cada nome é
+ *              gravado uma só vez.
+ * @param id    Id do nome.
+ * @returns     O offset do nome no bloco a gravar.
+ * @returns     NOMES_NENHUM se 'id' não for válido ou se não conseguiu alocar
+ *              memória (nomes_tamGravacao fica maior que NOMES_NENHUM).
+ */
+uint32_t nomes_gravar(const nomes_id id) {
+    const char* const s = nomes_str(id);
+    if (!s) return NOMES_NENHUM;
+    const colSize_t gravado = nomesgravtab_obter(&nomes_gravacao, &id);
+    if (gravado != COL_INVAL_INDEX) return gravado;
+    if (nomes_nOrdem == nomes_alocadoOrdem) {
+        const size_t    novo  = nomes_alocadoOrdem ? nomes_alocadoOrdem * 2 : 256;
+        nomes_id* const ordem = realloc(nomes_ordem, sizeof(nomes_id) * novo);
+        if (!ordem) {
+            nomes_tamGravado = UINT64_MAX;
+            return NOMES_NENHUM;
+        }
+        nomes_ordem        = ordem;
+        nomes_alocadoOrdem = novo;
+    }
+    const uint64_t off = nomes_tamGravado;
+    if (off >= NOMES_NENHUM || !nomesgravtab_inserir(&nomes_gravacao, &id, (colSize_t) off)) {
+        nomes_tamGravado = UINT64_MAX;
+        return NOMES_NENHUM;
+    }
+    nomes_ordem[nomes_nOrdem++] = id;
+    nomes_tamGravado += strlen(s) + 1;
+    return (uint32_t) off;
+}
+
+/**
+ * @brief       Retorna o tamanho do bloco de strings a gravar.
+ * @returns     O tamanho, maior ou igual a NOMES_NENHUM se o bloco não pode
+ *              ser gravado.
+ */
+uint64_t nomes_tamGravacao() { return nomes_tamGravado; }
+
+/**
+ * @brief       Retorna os nomes reservados com nomes_gravar, pela ordem em
+ *              que devem ser escritos no bloco de strings.
+ * @param n     Onde guardar o número de nomes.
+ * @returns     Os ids dos nomes.
+ */
+const nomes_id* nomes_gravados(size_t* const n) {
+    *n = nomes_nOrdem;
+    return nomes_ordem;
+}
+
+/**
+ * @brief       Liberta a memória utilizada para gravar o bloco de strings.
+ */
+void nomes_acabarGravacao() {
+    nomesgravtab_free(&nomes_gravacao);
+    free(nomes_ordem);
+    nomes_ordem        = NULL;
+    nomes_nOrdem       = 0;
+    nomes_alocadoOrdem = 0;
+    nomes_tamGravado   = 0;
+}
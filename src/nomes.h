@@ -0,0 +1,62 @@
+/**
+ * @file    nomes.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Tabela de nomes: os nomes dos artigos e dos clientes são guardados
+ *          uma só vez, seguidos num único bloco de memória, e referidos por
+ *          um id de 32 bits (o offset do nome no bloco).
+ * @details A tabela só cresce: alterar um nome acrescenta o novo nome e o
+ *          antigo só desaparece na próxima gravação. Nomes iguais têm
+ *          sempre o mesmo id, por isso podem ser comparados pelo id.
+ *
+ *          O bloco de strings do ficheiro de dados tem o mesmo formato, por
+ *          isso ao carregar é copiado de uma só vez (nomes_adotar) e os ids
+ *          gravados nos registos são os próprios offsets. Ao gravar, apenas
+ *          os nomes utilizados são escritos (nomes_gravar).
+ *
+ *          Os ponteiros retornados por nomes_str deixam de ser válidos
+ *          quando é inserido um nome novo.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef NOMES_H
+#define NOMES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief   Id de um nome, o seu offset na tabela de nomes.
+ */
+typedef uint32_t nomes_id;
+
+/**
+ * @def NOMES_NENHUM
+ *          Id que não se refere a nenhum nome.
+ */
+#define NOMES_NENHUM (~(nomes_id) 0)
+
+extern char*  nomes_dados; ///< Nomes terminados em '\0', seguidos
+extern size_t nomes_n;     ///< Bytes utilizados em 'nomes_dados'
+
+nomes_id        nomes_inserir(const char* const s);
+nomes_id        nomes_inserirTam(const char* const s, const size_t tam);
+int             nomes_adotar(const char* const bloco, const size_t tam);
+void            nomes_libertar();
+void            nomes_comecarGravacao();
+uint32_t        nomes_gravar(const nomes_id id);
+uint64_t        nomes_tamGravacao();
+const nomes_id* nomes_gravados(size_t* const n);
+void            nomes_acabarGravacao();
+
+/**
+ * @brief       Retorna o nome com o id 'id'.
+ * @param id    Id do nome.
+ * @returns     O nome, válido até ser inserido outro nome.
+ * @returns     NULL se 'id' for NOMES_NENHUM ou inválido.
+ */
+static inline const char* nomes_str(const nomes_id id) { return (id < nomes_n) ? nomes_dados + id : NULL; }
+
+#endif
@@ -8,12 +8,14 @@
  * @copyright Copyright (c) 2020
  */
 
+#define _POSIX_C_SOURCE 200809L
 #include "outrasListagens.h"
 
 #include <fcntl.h>
 #include <unistd.h>
 
 #include "menu.h"
+#include "resumo.h"
 #include "utilities.h"
 
 // De listagens_fuzzySearch
@@ -23,9 +25,12 @@ colSize_t getSize_art() { return artigos.size; }
 /**
  * @brief   Retorna o nome do artigo na posição 'i'.
  * @param i Posição do artigo.
- * @returns O nome do artigo na posição 'i'.
+ * @returns O nome do artigo na posição 'i', vazio se o artigo foi removido.
  */
-char* getStr_art(colSize_t i) { return artigos.data[i].nome; }
+const char* getStr_art(colSize_t i) {
+    const char* const nome = artigocol_vivo(&artigos, i) ? nomes_str(artigos.data[i].nome) : NULL;
+    return nome ? nome : "";
+}
 
 /**
  * @brief   Imprime o artigo na posição 'i'.
@@ -41,9 +46,12 @@ colSize_t getSize_uti() { return clientes.size; }
 /**
  * @brief   Retorna o nome do cliente na posição 'i'.
  * @param i Posição do utilizador.
- * @returns O nome do cliente na posição 'i'.
+ * @returns O nome do cliente na posição 'i', vazio se o cliente foi removido.
  */
-char* getStr_uti(colSize_t i) { return clientes.data[i].nome; }
+const char* getStr_uti(colSize_t i) {
+    const char* const nome = utilizadorcol_vivo(&clientes, i) ? nomes_str(clientes.data[i].nome) : NULL;
+    return nome ? nome : "";
+}
 
 /**
  * @brief   Imprime o cliente na posição 'i'.
@@ -161,7 +169,7 @@ wstrcol listagens_partirEspacos(wchar_t const* frase) {
  * @returns          Objetos impessos.
  */
 size_t listagens_fuzzySearch(char* find, size_t maxDist, size_t minToPrint, size_t const step,
-                             colSize_t (*const getSize)(), char* (*const getStr)(colSize_t),
+                             colSize_t (*const getSize)(), const char* (*const getStr)(colSize_t),
                              void (*const getPrint)(colSize_t)) {
     menu_printDiv();
     menu_printHeader("Resultados da Pesquisa");
@@ -223,18 +231,13 @@ int pred_printUti(utilizador const* const u, int64_t* const i);
 /**
  * @brief      Pode ser utilizado como um iterador, imprime encomenda num recibo.
  * @param e    Encomenda a ser impressa
- * @param data Ano e mês do recibo como também alguns dados remetentes ao total
- *             do preço do recibo e artigos compras e encomendas vendidas.
+ * @param data Ano e mês do recibo e cliente.
  * @returns    0
  */
-int listagens_pred_printencRec(encomenda const* const e, struct {
+int listagens_pred_printencRec(encomenda* const e, struct {
     int       ano;
     int       mes;
     colSize_t ID_cliente;
-    uint64_t  total;
-    uint64_t  art;
-    uint64_t  compras;
-    uint64_t  encomendas;
 } * data) {
     struct tm const* const t = localtime(&e->tempo);
     if (t->tm_mon == data->mes && t->tm_year == data->ano && e->ID_cliente == data->ID_cliente) {
@@ -244,29 +247,25 @@ int listagens_pred_printencRec(encomenda const* const e, struct {
         colSize_t i;
         for (i = 0; i < e->compras.size; i++) {
             // inicio
-            compra const* const c = &e->compras.data[i];
-            artigo const* const a = &artigos.data[c->IDartigo];
-            preco_art             = a->preco_cent;
+            compra const* const c = &compracol_data(&e->compras)[i];
+            artigo const* const a = artigocol_obter(&artigos, c->IDartigo);
+            if (!a) {
+                printf("        * [ ARTIGO REMOVIDO ]");
+                if (compra_temPreco(c)) printf("\t- TOTAL: %ldc", compra_precoIVA(c) * c->qtd);
+                printf("\t- QUANTIDADE: %ld\n", c->qtd);
+                continue;
+            }
+            // Preço e IVA do momento da venda, se foram registados
+            const int64_t preco_base = compra_temPreco(c) ? c->preco_cent : a->preco_cent;
+            const uint8_t iva        = compra_temPreco(c) ? c->iva : (a->meta & ARTIGO_IVA);
+            preco_art                = compra_precoUnitario(c, a);
             printf("        * ");
             // consumo
             printf("CONSUMO %s", (a->meta & ARTIGO_GRUPO_ANIMAL) ? "ANIMAL" : "HUMANO");
             // preço
-            printf("\t- PREÇO %luc\t- IVA", a->preco_cent);
+            printf("\t- PREÇO %luc\t- IVA", preco_base);
             // iva
-            switch (a->meta & ARTIGO_IVA) {
-                case ARTIGO_IVA_INTERMEDIO:
-                    printf(" %d%%", (int) ((ARTIGO_IVA_INTERMEDIO_VAL - 1) * 100));
-                    preco_art *= ARTIGO_IVA_INTERMEDIO_VAL;
-                    break;
-                case ARTIGO_IVA_NORMAL:
-                    printf(" %d%%", (int) ((ARTIGO_IVA_NORMAL_VAL - 1) * 100));
-                    preco_art *= ARTIGO_IVA_NORMAL_VAL;
-                    break;
-                case ARTIGO_IVA_REDUZIDO:
-                    printf(" %d%%", (int) ((ARTIGO_IVA_REDUZIDO_VAL - 1) * 100));
-                    preco_art *= ARTIGO_IVA_REDUZIDO_VAL;
-                    break;
-            }
+            if (iva != ARTIGO_IVA) printf(" %ld%%", artigo_ivaPercentagem[iva]);
             // total
             printf("\t- TOTAL: %ldc", preco_art * c->qtd);
             // quantidade
@@ -277,18 +276,13 @@ int listagens_pred_printencRec(encomenda const* const e, struct {
             } else
                 printf("\t- ARTIGO DE VENDA LIVRE ");
             // nome
-            printf("\t\"%s\"", protectStr(a->nome));
+            printf("\t\"%s\"", protectStr(nomes_str(a->nome)));
             // fim
-            data->art += c->qtd;
             printf("\n");
             fflush(stdout);
         }
-        const uint64_t tot = encomenda_CalcPreco(e, &artigos);
-        printf("    * TOTAL %ld\n", tot);
+        printf("    * TOTAL %ld\n", encomenda_total(e, &artigos));
         fflush(stdout);
-        data->compras += i;
-        data->total += tot;
-        data->encomendas += 1;
     }
     return 0;
 }
@@ -320,15 +314,19 @@ void listagem_imprimir_recibo() {
         printf("         -2   |   Reimprimir\n");
         printf("         -1   |   Sair\n");
         max = 0;
-        utilizadorcol_iterateFW(&clientes, (utilizadorcol_pred_t) &pred_printUti, &max);
+        COL_PARA_CADA(utilizadorcol, &clientes, u) pred_printUti(u, &max);
         menu_printInfo("Insira o ID do Cliente para editar");
         id = menu_readInt64_tMinMax(-2, max - 1);
+        if (id >= 0 && !utilizadorcol_vivo(&clientes, id)) {
+            menu_printError("o cliente %ld foi removido", id);
+            id = -2;
+        }
     }
     if (id == -1)
         return;
     else
-        ID_cliente = id;
-    utilizador const* const cliente = &clientes.data[ID_cliente];
+        ID_cliente = utilizadorcol_handle(&clientes, id);
+    utilizador const* const cliente = utilizadorcol_obter(&clientes, ID_cliente);
 
     // Imprimir recibo
     int bak = dup(1);
@@ -361,30 +359,26 @@ PRINT_BEGUIN:
     menu_printDiv();
     menu_printHeader("Recibo Mensal");
     printf("\n*** Mês do recibo: %lu/%lu\n", ano, mes);
-    printf("*** NOME %s\n", protectStr(cliente->nome));
+    printf("*** NOME %s\n", protectStr(nomes_str(cliente->nome)));
     printf("*** NIF  %9.9s\n", cliente->NIF);
     printf("*** CC   %12.12s\n", cliente->CC);
     struct {
         int       ano;
         int       mes;
         colSize_t ID_cliente;
-        uint64_t  total;
-        uint64_t  art;
-        uint64_t  compras;
-        uint64_t  encomendas;
     } data;
     data.ano        = ((int) ano) - 1900;
     data.mes        = ((int) mes) - 1;
     data.ID_cliente = ID_cliente;
-    data.total      = 0;
-    data.art        = 0;
-    data.compras    = 0;
-    data.encomendas = 0;
-    encomendacol_iterateFW(&encomendas, (encomendacol_pred_t) &listagens_pred_printencRec, &data);
-    printf("*** Artigos vendidos neste mês: %ld\n", data.art);
-    printf("*** Compras vendidas neste mês: %ld\n", data.compras);
-    printf("*** Encomendas vendidas neste mês: %ld\n", data.encomendas);
-    printf("*** Total mensal: %ld c\n", data.total);
+    funcional_exigirResumos();
+    funcional_percorrerMeses((uint32_t) ano * 12 + mes - 1, (uint32_t) ano * 12 + mes,
+                             (encomendacol_pred_t) &listagens_pred_printencRec, &data);
+    // Totais do mês lidos dos resumos, sem os somar encomenda a encomenda
+    const resumo* const r = resumo_obter(ID_cliente, (uint32_t) ano * 12 + mes - 1);
+    printf("*** Artigos vendidos neste mês: %ld\n", r ? r->artigos : 0);
+    printf("*** Compras vendidas neste mês: %ld\n", r ? r->compras : 0);
+    printf("*** Encomendas vendidas neste mês: %ld\n", r ? r->encomendas : 0);
+    printf("*** Total mensal: %ld c\n", r ? r->total : 0);
     menu_printHeader("Final do Recibo");
     menu_printDiv();
 
@@ -429,40 +423,228 @@ void listagem_procura() {
 }
 
 /**
- * @brief Imprime os utilizadores que mais gastaram num certo mês.
+ * @brief   Total gasto por um cliente, entrada do ranking de
+ *          listagem_utiMaisGasto.
+ */
+typedef struct {
+    uint64_t  gasto;   ///< Total gasto pelo cliente, em cêntimos
+    colSize_t cliente; ///< Slot do cliente em 'clientes'
+} listagens_gastoCliente;
+
+/**
+ * @brief   Ordem do ranking: mais gasto primeiro e, com o mesmo total, o
+ *          cliente com o slot mais baixo primeiro.
+ * @param a Primeira entrada.
+ * @param b Segunda entrada.
+ * @returns Negativo se 'a' vem antes de 'b', positivo se vem depois, 0 se
+ *          são iguais.
+ */
+static int listagens_compararGasto(const void* const a, const void* const b) {
+    const listagens_gastoCliente* const x = a;
+    const listagens_gastoCliente* const y = b;
+    if (x->gasto != y->gasto) return (x->gasto < y->gasto) ? 1 : -1;
+    return (x->cliente > y->cliente) - (x->cliente < y->cliente);
+}
+
+/**
+ * @brief   Desce a entrada 'i' de um heap em que a raiz é a entrada que vem
+ *          por último no ranking (ver listagens_compararGasto).
+ * @param h Heap.
+ * @param n Número de entradas em 'h'.
+ * @param i Entrada a descer.
+ */
+static void listagens_descerHeap(listagens_gastoCliente* const h, const colSize_t n, colSize_t i) {
+    while (1) {
+        colSize_t       pior = i;
+        const colSize_t e    = 2 * i + 1;
+        const colSize_t d    = 2 * i + 2;
+        if (e < n && listagens_compararGasto(&h[e], &h[pior]) > 0) pior = e;
+        if (d < n && listagens_compararGasto(&h[d], &h[pior]) > 0) pior = d;
+        if (pior == i) return;
+        const listagens_gastoCliente tmp = h[i];
+        h[i]                             = h[pior];
+        h[pior]                          = tmp;
+        i                                = pior;
+    }
+}
+
+/**
+ * @brief          Escolhe os 'k' clientes que mais gastaram, por ordem.
+ * @details        Com 'k' menor que o número de clientes as entradas passam
+ *                 por um heap limitado a 'k', cuja raiz é a pior das escolhidas
+ *                 até agora, em O(n log k). Só as 'k' escolhidas são
+ *                 ordenadas. Os clientes que não gastaram nada são ignorados.
+ * @param gastoUti Total gasto por cada cliente.
+ * @param n        Número de clientes em 'gastoUti'.
+ * @param k        Número máximo de clientes a escolher, 0 para todos.
+ * @param out      Onde guardar os clientes escolhidos, com 'k' posições (ou
+ *                 'n', se 'k' é 0).
+ * @returns        O número de clientes guardados em 'out'.
+ */
+static colSize_t listagens_maisGastaram(const uint64_t* const gastoUti, const colSize_t n, colSize_t k,
+                                        listagens_gastoCliente* const out) {
+    if (k == 0 || k > n) k = n;
+    colSize_t m = 0;
+    for (colSize_t i = 0; i < n; i++) {
+        if (!gastoUti[i]) continue;
+        const listagens_gastoCliente g = {.gasto = gastoUti[i], .cliente = i};
+        if (m < k) {
+            out[m++] = g;
+            // Quando fica cheio passa a ser um heap
+            if (m == k)
+                for (colSize_t j = k / 2; j-- > 0;) listagens_descerHeap(out, k, j);
+        } else if (listagens_compararGasto(&g, &out[0]) < 0) {
+            out[0] = g;
+            listagens_descerHeap(out, k, 0);
+        }
+    }
+    qsort(out, m, sizeof(listagens_gastoCliente), &listagens_compararGasto);
+    return m;
+}
+
+/**
+ * @brief     Total gasto por cada cliente num mês, lido dos resumos mensais
+ *            (ver resumo.h) sem percorrer as encomendas: um resumo_obter por
+ *            cliente.
+ * @param mes Mês a considerar (ver persistencia_mes).
+ * @returns   O total gasto por cada cliente, com 'clientes.size' posições,
+ *            que tem que ser libertado.
+ */
+static uint64_t* listagens_somarGastos(const uint32_t mes) {
+    uint64_t* gastoUti;
+    protectVarFcnCall(gastoUti, calloc(clientes.size + 1, sizeof(uint64_t)), "calloc falhou");
+    funcional_exigirResumos();
+    for (colSize_t i = 0; i < clientes.size; i++) {
+        if (!utilizadorcol_vivo(&clientes, i)) continue;
+        const resumo* const r = resumo_obter(utilizadorcol_handle(&clientes, i), mes);
+        if (r) gastoUti[i] = (uint64_t) r->total;
+    }
+    return gastoUti;
+}
+
+/**
+ * @brief Imprime os utilizadores que mais gastaram num certo mês, todos ou só
+ *        os K primeiros.
  */
 void listagem_utiMaisGasto() {
     menu_printDiv();
     menu_printHeader("Clientes Que Mais Gastaram");
     printf("Inserir ano");
-    int64_t ano = menu_readInt64_t() - 1900;
+    int64_t ano = menu_readInt64_t();
     menu_printInfo("Inserir mês");
-    int64_t mes = menu_readInt64_tMinMax(1, 12) - 1;
-
-    uint64_t* gastoUti = calloc(clientes.size, sizeof(uint64_t));
-    for (colSize_t i = 0; i < encomendas.size; i++) {
-        encomenda const* const enc  = &encomendas.data[i];
-        struct tm*             time = localtime(&enc->tempo);
-        if (time->tm_mon == mes || time->tm_year == ano)
-            gastoUti[enc->ID_cliente] += encomenda_CalcPreco(enc, &artigos);
+    int64_t mes = menu_readInt64_tMinMax(1, 12);
+
+    colSize_t k = 0;
+    switch (menu_selection(&(strcol) {.size = 2,
+                                      .data = (char*[]) {
+                                          "Todos os clientes ordenados", // 0
+                                          "Só os K que mais gastaram",   // 1
+                                      }})) {
+        case -1: return;
+        case 0: break;
+        case 1:
+            menu_printInfo("Inserir K");
+            k = (colSize_t) menu_readInt64_tMinMax(1, COL_SLOT_MAX);
+            break;
     }
 
-    uint64_t  max = 1;
-    colSize_t maxid;
+    const colSize_t         n        = clientes.size;
+    uint64_t* const         gastoUti = listagens_somarGastos((uint32_t) ano * 12 + mes - 1);
+    listagens_gastoCliente* ranking;
+    protectVarFcnCall(ranking, malloc(sizeof(listagens_gastoCliente) * ((k && k < n) ? k : n + 1)), "malloc falhou");
+    const colSize_t m = listagens_maisGastaram(gastoUti, n, k, ranking);
+    free(gastoUti);
+
     menu_printHeader("Utilizadores Ordenados");
-    while (max != 0) {
-        max = 0;
-        for (colSize_t i = 0; i < clientes.size; i++) {
-            if (gastoUti[i] > max) {
-                maxid = i;
-                max   = gastoUti[i];
-            }
-        }
-        if (max > 0) {
-            menu_printUtilizador(clientes.data[maxid]);
-            printf("   TOTAL GASTO: %luc\n", max);
-            gastoUti[maxid] = 0;
-        }
+    for (colSize_t i = 0; i < m; i++) {
+        menu_printUtilizador(clientes.data[ranking[i].cliente]);
+        printf("   TOTAL GASTO: %luc\n", ranking[i].gasto);
     }
-    free(gastoUti);
-}
\ No newline at end of file
+    free(ranking);
+}
+
+
+
+// De listagem_clientesPorNIF
+// *********************************************************************************************************************
+static nifcol listagens_nifs;          ///< Índice de clientes ordenado por NIF
+static int    listagens_nifValido = 0; ///< Se 'listagens_nifs' corresponde a 'clientes'
+
+/**
+ * @brief Marca o índice de clientes por NIF como desatualizado, deve ser
+ *        chamado sempre que um cliente é criado, alterado ou removido. O
+ *        índice é reconstruído quando voltar a ser usado.
+ */
+void listagens_invalidarNIF() { listagens_nifValido = 0; }
+
+/**
+ * @brief Liberta o índice de clientes por NIF.
+ */
+void listagens_libertar() {
+    nifcol_free(&listagens_nifs);
+    listagens_nifValido = 0;
+}
+
+/**
+ * @brief   Retorna o índice de clientes por NIF, reconstruindo-o com uma única
+ *          ordenação se algum cliente mudou desde a última vez.
+ * @returns O índice.
+ */
+static nifcol* listagens_indiceNIF() {
+    if (listagens_nifValido) return &listagens_nifs;
+    protectFcnCall(nifcol_reserve(&listagens_nifs, clientes.size), "nifcol_reserve falhou");
+    listagens_nifs.size = 0;
+    for (colSize_t i = 0; i < clientes.size; i++) {
+        if (!utilizadorcol_vivo(&clientes, i)) continue;
+        listagens_nif* const n = &listagens_nifs.data[listagens_nifs.size++];
+        memcpy(n->NIF, clientes.data[i].NIF, sizeof(n->NIF));
+        n->cliente = utilizadorcol_handle(&clientes, i);
+    }
+    nifcol_sort(&listagens_nifs);
+    listagens_nifValido = 1;
+    return &listagens_nifs;
+}
+
+/**
+ * @brief   Pode ser utilizado como um iterador, imprime o cliente de uma
+ *          entrada do índice por NIF.
+ * @param n Entrada do índice.
+ * @param i Número de clientes impressos.
+ * @returns 0
+ */
+int listagens_pred_printNIF(listagens_nif const* const n, colSize_t* const i) {
+    utilizador const* const u = utilizadorcol_obter(&clientes, n->cliente);
+    printf("   %8u   |   ", COL_SLOT_INDEX(n->cliente));
+    menu_printUtilizador(*u);
+    printf("\n");
+    ++(*i);
+    return 0;
+}
+
+/**
+ * @brief Imprime, ordenados por NIF, os clientes cujo NIF começa pelos dígitos
+ *        inseridos.
+ */
+void listagem_clientesPorNIF() {
+    menu_printDiv();
+    menu_printHeader("Clientes Por NIF");
+    printf("Inserir os primeiros dígitos do NIF");
+    char* const  prefixo = menu_readNotNulStr();
+    const size_t n       = strlen(prefixo) < 9 ? strlen(prefixo) : 9;
+
+    // Os NIF com o prefixo estão entre o prefixo seguido de 0x00 e o prefixo seguido de 0xFF
+    listagens_nif de;
+    listagens_nif ate;
+    memset(de.NIF, 0x00, sizeof(de.NIF));
+    memset(ate.NIF, 0xFF, sizeof(ate.NIF));
+    memcpy(de.NIF, prefixo, n);
+    memcpy(ate.NIF, prefixo, n);
+    de.cliente  = 0;
+    ate.cliente = COL_INVAL_INDEX;
+    free(prefixo);
+
+    colSize_t impressos = 0;
+    printf("      ID      |   Cliente\n");
+    nifcol_iterateRange(listagens_indiceNIF(), &de, &ate, (nifcol_pred_t) &listagens_pred_printNIF, &impressos);
+    if (!impressos) menu_printInfo("nenhum cliente com o NIF começado por esses dígitos");
+}
@@ -16,6 +16,7 @@
 #include <wctype.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "artigo.h"
 #include "encomenda.h"
@@ -25,6 +26,8 @@
 #    define artigocol_H
 #    define COL_TIPO artigo
 #    define COL_NOME artigocol
+#    define COL_PARALELO
+#    define COL_SLOTS
 #    define COL_DEALOC(X) freeArtigo(X)
 #    define COL_WRITE(X, F) save_artigo(F, X)
 #    define COL_READ(X, F) load_artigo(F, X)
@@ -35,6 +38,8 @@
 #    define encomendacol_H
 #    define COL_TIPO encomenda
 #    define COL_NOME encomendacol
+#    define COL_PARALELO
+#    define COL_SEGMENTOS
 #    define COL_DEALOC(X) freeEncomenda(X)
 #    define COL_WRITE(X, F) save_encomenda(F, X)
 #    define COL_READ(X, F) load_encomenda(F, X)
@@ -45,6 +50,7 @@
 #    define utilizadorcol_H
 #    define COL_TIPO utilizador
 #    define COL_NOME utilizadorcol
+#    define COL_SLOTS
 #    define COL_DEALOC(X) freeUtilizador(X)
 #    define COL_WRITE(X, F) save_utilizador(F, X)
 #    define COL_READ(X, F) load_utilizador(F, X)
@@ -59,16 +65,55 @@
 #    include "colecao.h"
 #endif
 
+/**
+ * @brief   Entrada do índice de clientes ordenado por NIF.
+ */
+typedef struct {
+    char      NIF[9];  ///< NIF do cliente
+    colSize_t cliente; ///< Handle do cliente em 'clientes'
+} listagens_nif;
+
+/**
+ * @brief   Ordena o índice por NIF e, entre clientes com o mesmo NIF, por
+ *          handle (COL_CMP de nifcol).
+ * @param a Primeira entrada.
+ * @param b Segunda entrada.
+ * @returns Negativo, 0 ou positivo como strcmp.
+ */
+static inline int listagens_compararNIF(const listagens_nif* const a, const listagens_nif* const b) {
+    const int c = memcmp(a->NIF, b->NIF, sizeof(a->NIF));
+    if (c) return c;
+    return (a->cliente > b->cliente) - (a->cliente < b->cliente);
+}
+
+#ifndef nifcol_H
+#    define nifcol_H
+#    define COL_TIPO listagens_nif
+#    define COL_NOME nifcol
+#    define COL_CMP(A, B) listagens_compararNIF(A, B)
+#    include "colecao.h"
+#endif
+
 // Estado do programa
 // *****************************************************************************
-artigocol     artigos;
-encomendacol  encomendas;
-utilizadorcol clientes;
+extern artigocol     artigos;
+extern encomendacol  encomendas;
+extern utilizadorcol clientes;
+void                 funcional_percorrerMeses(const uint32_t de, const uint32_t ate, encomendacol_pred_t predicate,
+                                              void* const userData);
+void                 funcional_percorrerEncomendas(encomendacol_pred_t predicate, void* const userData);
+void                 funcional_reduzirEncomendas(encomendacol_map_t map, encomendacol_combine_t combine,
+                                                 const void* const identidade, const size_t tamanho,
+                                                 void* const resultado, void* const userData);
+void                 funcional_exigirResumos();
 
 // Listagens
 // *****************************************************************************
 void listagem_imprimir_recibo();
 void listagem_procura();
 void listagem_utiMaisGasto();
+void listagem_clientesPorNIF();
+void listagens_invalidarNIF();
+void listagens_libertar();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+/**
+ * @file    paralelo.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Divide um intervalo [0, n) em partes contíguas e executa uma tarefa
+ *          sobre cada parte numa thread diferente.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "paralelo.h"
+
+#include <stdlib.h>
+#ifndef _WIN32
+#    include <pthread.h>
+#    include <unistd.h>
+#endif
+
+static int paralelo_nThreads = 1; ///< Threads usadas por omição (paralelo_definirThreads)
+
+/**
+ * @brief   Parte de um intervalo entregue a uma thread.
+ */
+typedef struct {
+    paralelo_tarefa_t tarefa; ///< Tarefa a executar
+    void*             arg;    ///< Argumento da tarefa
+    size_t            de;     ///< Primeiro elemento da parte
+    size_t            ate;    ///< Elemento depois do último da parte
+    int               ok;     ///< Resultado da tarefa
+#ifndef _WIN32
+    pthread_t thread; ///< Thread que executa a parte
+    int       criada; ///< Se 'thread' foi criada e tem que ser esperada
+#endif
+} paralelo_parte;
+
+/**
+ * @brief   Define o número de threads usadas por omição, para carregar o
+ *          ficheiro de dados e pelas coleções com COL_PARALELO.
+ * @param n Número de threads, 1 para não usar threads ou 0 (ou negativo) para
+ *          usar todos os processadores disponíveis.
+ */
+void paralelo_definirThreads(int n) {
+    if (n <= 0) {
+#ifdef _WIN32
+        const char* const nproc = getenv("NUMBER_OF_PROCESSORS");
+        n                       = nproc ? atoi(nproc) : 1;
+#else
+        n = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    }
+    paralelo_nThreads = (n < 1) ? 1 : (n > PARALELO_MAX_THREADS) ? PARALELO_MAX_THREADS : n;
+}
+
+/**
+ * @brief   Retorna o número de threads usadas por omição.
+ * @returns O número definido por paralelo_definirThreads, 1 se nunca foi
+ *          definido.
+ */
+int paralelo_threads() { return paralelo_nThreads; }
+
+/**
+ * @brief   Executa uma parte de um intervalo.
+ * @param p paralelo_parte a executar.
+ * @returns NULL.
+ */
+static void* paralelo_correrParte(void* const p) {
+    paralelo_parte* const parte = p;
+    parte->ok                   = parte->tarefa(parte->arg, parte->de, parte->ate);
+    return NULL;
+}
+
+/**
+ * @brief         Divide [0, n) em partes contíguas e executa 'tarefa' sobre
+ *                cada uma numa thread diferente. A primeira parte é executada
+ *                na thread que chamou e, se não for possível criar uma thread,
+ *                a sua parte também.
+ * @param n       Número de elementos.
+ * @param minimo  Número mínimo de elementos por parte.
+ * @param threads Número máximo de partes.
+ * @param tarefa  Tarefa a executar.
+ * @param arg     Argumento da tarefa.
+ * @returns       0 se alguma parte falhou.
+ * @returns       1 caso contrário.
+ */
+int paralelo_executar(const size_t n, const size_t minimo, const int threads, const paralelo_tarefa_t tarefa,
+                      void* const arg) {
+#ifdef _WIN32
+    (void) minimo;
+    (void) threads;
+    return tarefa(arg, 0, n);
+#else
+    size_t k = (minimo > 1) ? n / minimo : n;
+    if (k > (size_t) threads) k = (size_t) threads;
+    if (k > PARALELO_MAX_THREADS) k = PARALELO_MAX_THREADS;
+    if (k <= 1) return tarefa(arg, 0, n);
+
+    paralelo_parte partes[PARALELO_MAX_THREADS];
+    for (size_t i = 0; i < k; i++) {
+        partes[i] = (paralelo_parte){.tarefa = tarefa, .arg = arg, .de = n * i / k, .ate = n * (i + 1) / k};
+    }
+    for (size_t i = 1; i < k; i++) {
+        partes[i].criada = !pthread_create(&partes[i].thread, NULL, paralelo_correrParte, &partes[i]);
+        if (!partes[i].criada) paralelo_correrParte(&partes[i]);
+    }
+    paralelo_correrParte(&partes[0]);
+    int ok = 1;
+    for (size_t i = 0; i < k; i++) {
+        if (partes[i].criada) pthread_join(partes[i].thread, NULL);
+        ok = ok && partes[i].ok;
+    }
+    return ok;
+#endif
+}
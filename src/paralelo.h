@@ -0,0 +1,38 @@
+/**
+ * @file    paralelo.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Divide um intervalo [0, n) em partes contíguas e executa uma tarefa
+ *          sobre cada parte numa thread diferente. Usado para carregar o
+ *          ficheiro de dados (persistencia.c) e por _parallelForEach e
+ *          _parallelReduce (COL_PARALELO em colecao.h).
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef PARALELO_H
+#define PARALELO_H
+
+#include <stddef.h>
+
+/**
+ * @def PARALELO_MAX_THREADS
+ *          Número máximo de threads usadas por paralelo_executar.
+ */
+#define PARALELO_MAX_THREADS 64
+
+/**
+ * @brief      Tarefa executada por paralelo_executar sobre os elementos
+ *             [de, ate) de um intervalo.
+ * @returns    0 se a tarefa falhou.
+ * @returns    1 caso contrário.
+ */
+typedef int (*paralelo_tarefa_t)(void* const arg, const size_t de, const size_t ate);
+
+void paralelo_definirThreads(int n);
+int  paralelo_threads();
+int  paralelo_executar(const size_t n, const size_t minimo, const int threads, const paralelo_tarefa_t tarefa,
+                       void* const arg);
+
+#endif
@@ -0,0 +1,1791 @@
+/**
+ * @file    persistencia.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Responsável por gravar e carregar o estado do programa num ficheiro
+ *          que pode ser mapeado em memória e utilizado diretamente.
+ * @details O ficheiro é constituído por um cabeçalho, uma tabela de secções
+ *          (offset, tamanho, número de registos e checksum), uma tabela de
+ *          registos de tamanho fixo para cada coleção e um bloco de strings
+ *          partilhado (terminadas em '\0'). Ao carregar, o ficheiro é mapeado
+ *          em memória (MAP_PRIVATE) e apenas o cabeçalho é lido; cada coleção é
+ *          carregada na primeira vez que é pedida com
+ *          persistencia_carregarSeccao. O bloco de strings é copiado de uma só
+ *          vez para a tabela de nomes (nomes.h) e as compras ficam a apontar
+ *          para o mapa, só sendo copiadas na primeira vez que são alteradas.
+ *          As secções pedidas ao mesmo tempo são verificadas e descomprimidas
+ *          em paralelo e os registos de cada secção são divididos por várias
+ *          threads (paralelo_definirThreads).
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // madvise
+#include "persistencia.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifndef _WIN32
+#    include <sys/mman.h>
+#    include <sys/wait.h>
+#endif
+
+#include "arena.h"
+#include "compressao.h"
+#include "menu.h"
+#include "nomes.h"
+#include "paralelo.h"
+#include "utilities.h"
+
+static char*  persistencia_mapa    = NULL; ///< Ficheiro atualmente mapeado
+static size_t persistencia_mapaTam = 0;    ///< Tamanho do mapa
+
+static uint8_t* persistencia_bloco      = NULL; ///< Bytes da secção atual ainda por comprimir
+static size_t   persistencia_blocoTam   = 0;    ///< Bytes usados em persistencia_bloco
+static uint8_t* persistencia_comprimido = NULL; ///< Bloco comprimido, com o seu cabeçalho
+
+static int      persistencia_progressoFd = -1; ///< Onde escrever o progresso da gravação (-1 se não escrever)
+static uint64_t persistencia_feitos      = 0;  ///< Registos já gravados
+static uint64_t persistencia_total       = 0;  ///< Registos a gravar
+static int      persistencia_percentagem = -1; ///< Última percentagem escrita em persistencia_progressoFd
+
+#ifndef _WIN32
+static pid_t persistencia_fundoPid = -1; ///< Processo que está a gravar em segundo plano
+static int   persistencia_fundoFd  = -1; ///< Progresso enviado por persistencia_fundoPid
+#endif
+static int                     persistencia_fundoPct    = 0; ///< Último progresso lido
+static enum persistencia_fundo persistencia_fundoEstado = PERSISTENCIA_FUNDO_NADA; ///< Estado da última gravação
+
+static const size_t persistencia_tamRegisto[PERSISTENCIA_N_SECCOES] = {
+    sizeof(persistencia_artigo), sizeof(persistencia_encomenda), sizeof(compra), sizeof(persistencia_utilizador), 1};
+static uint8_t* persistencia_dados[PERSISTENCIA_N_SECCOES]; ///< Bytes (descomprimidos) de cada secção
+static uint32_t persistencia_versao         = PERSISTENCIA_VERSAO; ///< Versão do ficheiro mapeado
+static unsigned persistencia_descomprimidas = 0; ///< Secções em persistencia_dados alocadas (bit 1 << tipo)
+static unsigned persistencia_abertas        = 0; ///< Secções com o checksum já verificado (bit 1 << tipo)
+
+/**
+ * @def PERSISTENCIA_JANELA
+ *          Bytes de uma secção percorrida por persistencia_percorrerEncomendas
+ *          que podem ficar em memória antes de serem devolvidos ao sistema.
+ */
+#define PERSISTENCIA_JANELA (4 * 1024 * 1024)
+
+/**
+ * @brief   Leitor sequencial de uma secção do mapa, que a descomprime um bloco
+ *          de cada vez em vez de a carregar toda.
+ */
+typedef struct {
+    const persistencia_seccao* s;          ///< Secção a ler
+    const char*                mapa;       ///< Início da secção no mapa
+    const uint8_t*             src;        ///< Bytes da secção (no mapa ou já descomprimidos)
+    uint64_t                   tam;        ///< Tamanho de 'src'
+    uint64_t                   pos;        ///< Próximo byte de 'src'
+    uint64_t                   largado;    ///< Bytes de 'src' já devolvidos ao sistema
+    int                        comprimida; ///< Se 'src' é uma sequência de blocos comprimidos
+    int                        verificar;  ///< Se o checksum da secção ainda não foi verificado
+    uint32_t                   checksum;   ///< fnv1a dos bytes de 'src' já lidos
+    uint8_t*                   bloco;      ///< Bloco atual descomprimido
+    size_t                     blocoTam;   ///< Bytes em 'bloco'
+    size_t                     blocoPos;   ///< Próximo byte de 'bloco'
+    uint8_t*                   junto;      ///< Registos que atravessam dois blocos
+    size_t                     juntoAloc;  ///< Bytes alocados em 'junto'
+} persistencia_leitor;
+
+static persistencia_seccao persistencia_seccoes[PERSISTENCIA_N_SECCOES]; ///< Tabela de secções do mapa
+static unsigned            persistencia_pendentes = 0; ///< Secções do mapa ainda não carregadas (bit 1 << tipo)
+static uint32_t            persistencia_arquivoInicio = 0; ///< Primeiro mês arquivado (persistencia_mes)
+static uint32_t            persistencia_arquivoFim    = 0; ///< Primeiro mês depois do último mês arquivado
+static artigocol*          persistencia_av        = NULL; ///< Onde carregar os artigos
+static encomendacol*       persistencia_ev        = NULL; ///< Onde carregar as encomendas
+static utilizadorcol*      persistencia_uv        = NULL; ///< Onde carregar os clientes
+static int                 persistencia_adotados  = 0; ///< Se os ids dos nomes são os offsets do bloco de strings
+static nomes_id            persistencia_semNome   = NOMES_NENHUM; ///< Nome dos artigos com um nome inválido
+
+/**
+ * @def PERSISTENCIA_MIN_REGISTOS
+ *          Número mínimo de registos descodificados por cada thread.
+ * @def PERSISTENCIA_MIN_BLOCOS
+ *          Número mínimo de blocos descomprimidos por cada thread.
+ */
+#define PERSISTENCIA_MIN_REGISTOS 16384
+#define PERSISTENCIA_MIN_BLOCOS 4
+
+static arena persistencia_arena     = {NULL, 0}; ///< Objetos criados ao carregar (formato antigo e diário)
+static int   persistencia_aCarregar = 0;         ///< Se persistencia_alocar aloca em persistencia_arena
+
+
+
+
+// Gravar
+// *********************************************************************************************************************
+/**
+ * @brief   Alinha um offset a 8 bytes.
+ * @param o Offset a alinhar.
+ * @returns O menor múltiplo de 8 maior ou igual a 'o'.
+ */
+static uint64_t persistencia_alinhar(const uint64_t o) { return (o + 7) & ~(uint64_t) 7; }
+
+/**
+ * @brief     Escreve zeros até que a posição atual seja 'alvo'.
+ * @param f   Ficheiro onde escrever.
+ * @param pos Posição atual no ficheiro, é atualizada.
+ * @param alvo Posição a atingir.
+ * @returns   0 se falhou a escrever.
+ * @returns   1 caso contrário.
+ */
+static int persistencia_preencher(FILE* const f, uint64_t* const pos, const uint64_t alvo) {
+    static const char ZEROS[8] = {0};
+    if (alvo == *pos) return 1;
+    if (!fwrite(ZEROS, alvo - *pos, 1, f)) return 0;
+    *pos = alvo;
+    return 1;
+}
+
+/**
+ * @brief           Começa uma secção na primeira posição alinhada a partir de
+ *                  'pos'.
+ * @param f         Ficheiro onde escrever.
+ * @param pos       Posição atual no ficheiro.
+ * @param s         Entrada da secção na tabela de secções.
+ * @param comprimir Se a secção deve ser gravada em blocos comprimidos.
+ * @returns         0 se falhou a escrever.
+ * @returns         1 caso contrário.
+ */
+static int persistencia_comecarSeccao(FILE* const f, uint64_t* const pos, persistencia_seccao* const s,
+                                      const int comprimir) {
+    if (!persistencia_preencher(f, pos, persistencia_alinhar(*pos))) return 0;
+    memset(s, 0, sizeof(*s));
+    s->offset             = *pos;
+    s->checksum           = FNV1A_INICIO;
+    s->flags              = comprimir ? PERSISTENCIA_COMPRIMIDA : 0;
+    persistencia_blocoTam = 0;
+    return 1;
+}
+
+/**
+ * @brief      Escreve bytes tal como ficam no ficheiro e atualiza o tamanho e
+ *             o checksum da secção.
+ * @param f    Ficheiro onde escrever.
+ * @param s    Entrada da secção na tabela de secções.
+ * @param data Bytes a escrever.
+ * @param size Número de bytes.
+ * @returns    0 se falhou a escrever.
+ * @returns    1 caso contrário.
+ */
+static int persistencia_escreverFicheiro(FILE* const f, persistencia_seccao* const s, const void* const data,
+                                         const size_t size) {
+    if (size && !fwrite(data, size, 1, f)) return 0;
+    s->tam += size;
+    s->checksum = fnv1a(data, size, s->checksum);
+    return 1;
+}
+
+/**
+ * @brief   Comprime e escreve os bytes acumulados em persistencia_bloco.
+ * @param f Ficheiro onde escrever.
+ * @param s Entrada da secção na tabela de secções.
+ * @returns 0 se falhou a escrever.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_despejar(FILE* const f, persistencia_seccao* const s) {
+    if (!persistencia_blocoTam) return 1;
+    const size_t n = compressao_comprimirBloco(persistencia_bloco, persistencia_blocoTam, persistencia_comprimido);
+    persistencia_blocoTam = 0;
+    return persistencia_escreverFicheiro(f, s, persistencia_comprimido, n);
+}
+
+/**
+ * @brief      Escreve bytes de uma secção, comprimindo-os em blocos se a
+ *             secção for comprimida.
+ * @param f    Ficheiro onde escrever.
+ * @param s    Entrada da secção na tabela de secções.
+ * @param data Bytes a escrever.
+ * @param size Número de bytes.
+ * @returns    0 se falhou a escrever.
+ * @returns    1 caso contrário.
+ */
+static int persistencia_escreverBytes(FILE* const f, persistencia_seccao* const s, const void* const data,
+                                      size_t size) {
+    if (!(s->flags & PERSISTENCIA_COMPRIMIDA)) return persistencia_escreverFicheiro(f, s, data, size);
+    const uint8_t* src = data;
+    while (size) {
+        size_t n = COMPRESSAO_BLOCO - persistencia_blocoTam;
+        if (n > size) n = size;
+        memcpy(persistencia_bloco + persistencia_blocoTam, src, n);
+        persistencia_blocoTam += n;
+        src += n;
+        size -= n;
+        if (persistencia_blocoTam == COMPRESSAO_BLOCO && !persistencia_despejar(f, s)) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief     Acaba uma secção, escrevendo o último bloco se for comprimida.
+ * @param f   Ficheiro onde escrever.
+ * @param pos Posição atual no ficheiro, passa a ser o fim da secção.
+ * @param s   Entrada da secção na tabela de secções.
+ * @param n   Número de registos da secção.
+ * @returns   0 se falhou a escrever.
+ * @returns   1 caso contrário.
+ */
+static int persistencia_acabarSeccao(FILE* const f, uint64_t* const pos, persistencia_seccao* const s,
+                                     const uint64_t n) {
+    if (!persistencia_despejar(f, s)) return 0;
+    s->n = n;
+    *pos = s->offset + s->tam;
+    return 1;
+}
+
+/**
+ * @brief   Conta 'n' registos gravados e, se a percentagem gravada mudou,
+ *          escreve-a em persistencia_progressoFd.
+ * @param n Número de registos gravados desde a última chamada.
+ */
+static void persistencia_progresso(const uint64_t n) {
+    persistencia_feitos += n;
+    if (persistencia_progressoFd < 0 || !persistencia_total) return;
+    const int pct = (int) (persistencia_feitos * 100 / persistencia_total);
+    if (pct == persistencia_percentagem) return;
+    persistencia_percentagem = pct;
+    const uint8_t b          = (uint8_t) pct;
+    if (write(persistencia_progressoFd, &b, 1) != 1) persistencia_progressoFd = -1;
+}
+
+/**
+ * @brief   Escreve o cabeçalho, a tabela de secções, as tabelas e o bloco de
+ *          strings em 'f'.
+ * @returns 0 se falhou a escrever.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_escrever(FILE* const f, const uint64_t geracao, const uint64_t diario, const int comprimir,
+                                 const artigocol* const av, const encomendacol* const ev,
+                                 const utilizadorcol* const uv) {
+    const persistencia_cabecalho cab = {.magia     = PERSISTENCIA_MAGIA,
+                                        .versao    = PERSISTENCIA_VERSAO,
+                                        .endian    = PERSISTENCIA_ENDIAN,
+                                        .n_seccoes = PERSISTENCIA_N_SECCOES,
+                                        .geracao   = geracao,
+                                        .diario    = diario,
+                                        .arquivo_inicio = persistencia_arquivoInicio,
+                                        .arquivo_fim    = persistencia_arquivoFim};
+    persistencia_seccao          tab[PERSISTENCIA_N_SECCOES];
+    persistencia_seccao*         s;
+    memset(tab, 0, sizeof(tab));
+    nomes_comecarGravacao();
+
+    persistencia_feitos      = 0;
+    persistencia_percentagem = -1;
+    persistencia_total       = (uint64_t) av->size + ev->size + uv->size;
+    for (colSize_t i = 0; i < ev->size; i++) persistencia_total += encomendacol_at(ev, i)->compras.size;
+
+    // Cabeçalho e tabela de secções, reescrita no fim
+    uint64_t pos = 0;
+    if (!fwrite(&cab, sizeof(cab), 1, f) || !fwrite(tab, sizeof(tab), 1, f)) return 0;
+    pos += sizeof(cab) + sizeof(tab);
+
+    // Artigos
+    s = &tab[PERSISTENCIA_ARTIGOS];
+    if (!persistencia_comecarSeccao(f, &pos, s, comprimir)) return 0;
+    for (colSize_t i = 0; i < av->size; i++) {
+        persistencia_artigo r;
+        memset(&r, 0, sizeof(r));
+        r.geracao = artigocol_geracao(av, i);
+        if (!artigocol_vivo(av, i)) {
+            // Slot livre, só a geração interessa
+            r.nome = PERSISTENCIA_SEM_STR;
+            if (!persistencia_escreverBytes(f, s, &r, sizeof(r))) return 0;
+            continue;
+        }
+        r.nome       = nomes_gravar(av->data[i].nome);
+        r.meta       = av->data[i].meta;
+        r.preco_cent = av->data[i].preco_cent;
+        r.stock      = av->data[i].stock;
+        if (!persistencia_escreverBytes(f, s, &r, sizeof(r))) return 0;
+    }
+    persistencia_progresso(av->size);
+    if (!persistencia_acabarSeccao(f, &pos, s, av->size)) return 0;
+
+    // Encomendas
+    s = &tab[PERSISTENCIA_ENCOMENDAS];
+    if (!persistencia_comecarSeccao(f, &pos, s, comprimir)) return 0;
+    uint64_t primeira = 0;
+    for (colSize_t i = 0; i < ev->size; i++) {
+        const encomenda* const e = encomendacol_at(ev, i);
+        persistencia_encomenda r;
+        memset(&r, 0, sizeof(r));
+        r.tempo           = e->tempo;
+        r.ID_cliente      = e->ID_cliente;
+        r.n_compras       = e->compras.size;
+        r.primeira_compra = primeira;
+        primeira += r.n_compras;
+        if (!persistencia_escreverBytes(f, s, &r, sizeof(r))) return 0;
+        persistencia_progresso(1);
+    }
+    if (!persistencia_acabarSeccao(f, &pos, s, ev->size)) return 0;
+
+    // Compras, a tabela tem a disposição de 'compra' (COL_POD)
+    s = &tab[PERSISTENCIA_COMPRAS];
+    if (!persistencia_comecarSeccao(f, &pos, s, comprimir)) return 0;
+    for (colSize_t i = 0; i < ev->size; i++) {
+        const compracol* const cv = &encomendacol_at(ev, i)->compras;
+        if (!persistencia_escreverBytes(f, s, compracol_data(cv), (size_t) cv->size * sizeof(compra))) return 0;
+        persistencia_progresso(cv->size);
+    }
+    if (!persistencia_acabarSeccao(f, &pos, s, primeira)) return 0;
+
+    // Clientes
+    s = &tab[PERSISTENCIA_CLIENTES];
+    if (!persistencia_comecarSeccao(f, &pos, s, comprimir)) return 0;
+    for (colSize_t i = 0; i < uv->size; i++) {
+        persistencia_utilizador r;
+        memset(&r, 0, sizeof(r));
+        r.geracao = utilizadorcol_geracao(uv, i);
+        if (!utilizadorcol_vivo(uv, i)) {
+            // Slot livre, só a geração interessa
+            r.nome = PERSISTENCIA_SEM_STR;
+            if (!persistencia_escreverBytes(f, s, &r, sizeof(r))) return 0;
+            continue;
+        }
+        r.nome = nomes_gravar(uv->data[i].nome);
+        memcpy(r.NIF, uv->data[i].NIF, sizeof(r.NIF));
+        memcpy(r.CC, uv->data[i].CC, sizeof(r.CC));
+        if (!persistencia_escreverBytes(f, s, &r, sizeof(r))) return 0;
+    }
+    persistencia_progresso(uv->size);
+    if (!persistencia_acabarSeccao(f, &pos, s, uv->size)) return 0;
+    const uint64_t tam_strings = nomes_tamGravacao();
+    if (tam_strings >= PERSISTENCIA_SEM_STR) {
+        menu_printError("ao gravar - demasiados nomes para o bloco de strings");
+        return 0;
+    }
+
+    // Strings, cada nome utilizado uma só vez, pela ordem em que foram reservadas
+    s = &tab[PERSISTENCIA_STRINGS];
+    if (!persistencia_comecarSeccao(f, &pos, s, comprimir)) return 0;
+    size_t                n_nomes;
+    const nomes_id* const nomes = nomes_gravados(&n_nomes);
+    for (size_t i = 0; i < n_nomes; i++) {
+        const char* const nome = nomes_str(nomes[i]);
+        if (!persistencia_escreverBytes(f, s, nome, strlen(nome) + 1)) return 0;
+    }
+    nomes_acabarGravacao();
+    if (!persistencia_acabarSeccao(f, &pos, s, tam_strings)) return 0;
+
+    // Tabela de secções final
+    if (fseek(f, sizeof(cab), SEEK_SET)) return 0;
+    return fwrite(tab, sizeof(tab), 1, f);
+}
+
+/**
+ * @brief           Grava as três coleções em 'caminho'.
+ * @details         Os dados são escritos num ficheiro temporário que depois
+ *                  substitui 'caminho', de modo a que um ficheiro que esteja
+ *                  mapeado nunca seja truncado.
+ * @param caminho   Ficheiro onde gravar.
+ * @param geracao   Geração do ficheiro gravado.
+ * @param diario    Tamanho do diário da geração anterior cujos registos já
+ *                  estão incluídos nas coleções gravadas.
+ * @param comprimir Se as secções devem ser gravadas em blocos comprimidos, o
+ *                  que reduz o ficheiro mas obriga a descomprimir cada secção
+ *                  para memória em vez de a usar diretamente do mapa.
+ * @param av        Artigos a gravar.
+ * @param ev        Encomendas a gravar.
+ * @param uv        Clientes a gravar.
+ * @returns         0 se falhou a gravar.
+ * @returns         1 caso contrário.
+ * @warning         Secções ainda pendentes (persistencia_pendente) têm que ser
+ *                  carregadas antes de gravar, caso contrário as coleções
+ *                  gravadas estão incompletas.
+ */
+int persistencia_gravar(const char* const caminho, const uint64_t geracao, const uint64_t diario, const int comprimir,
+                        const artigocol* const av, const encomendacol* const ev, const utilizadorcol* const uv) {
+    char* tmp;
+    protectVarFcnCall(tmp, malloc(strlen(caminho) + 5), "alocação de memória recusada");
+    strcpy(tmp, caminho);
+    strcat(tmp, ".tmp");
+
+    FILE* f = fopen(tmp, "wb");
+    if (!f) {
+        menu_printError("ao gravar - '%s' não pode ser aberto", tmp);
+        free(tmp);
+        return 0;
+    }
+    if (comprimir) {
+        protectVarFcnCall(persistencia_bloco, malloc(COMPRESSAO_BLOCO), "alocação de memória recusada");
+        const size_t tam = sizeof(compressao_bloco) + COMPRESSAO_LIMITE(COMPRESSAO_BLOCO);
+        protectVarFcnCall(persistencia_comprimido, malloc(tam), "alocação de memória recusada");
+    }
+    int ok = persistencia_escrever(f, geracao, diario, comprimir, av, ev, uv) && !fflush(f);
+    freeN(persistencia_bloco);
+    freeN(persistencia_comprimido);
+#ifndef _WIN32
+    ok = ok && !fsync(fileno(f));
+#endif
+    ok = !fclose(f) && ok;
+#ifdef _WIN32
+    if (ok) remove(caminho);
+#endif
+    ok = ok && !rename(tmp, caminho);
+    if (!ok) remove(tmp);
+    free(tmp);
+    return ok;
+}
+
+
+/**
+ * @brief           Grava as três coleções em 'caminho' em segundo plano.
+ * @details         O processo é duplicado (fork) e o processo filho, que vê
+ *                  uma cópia copy-on-write das coleções tal como estão neste
+ *                  momento, grava-as com persistencia_gravar enquanto o
+ *                  processo original continua a aceitar alterações. O progresso
+ *                  e o resultado são obtidos com persistencia_estadoFundo. Em
+ *                  plataformas sem fork a gravação é feita de imediato.
+ * @param caminho   Ficheiro onde gravar.
+ * @param geracao   Geração do ficheiro gravado.
+ * @param diario    Ver persistencia_gravar.
+ * @param comprimir Ver persistencia_gravar.
+ * @param av        Artigos a gravar.
+ * @param ev        Encomendas a gravar.
+ * @param uv        Clientes a gravar.
+ * @returns         0 se não foi possível começar a gravação.
+ * @returns         1 caso contrário.
+ * @warning         Só pode haver uma gravação de cada vez.
+ */
+int persistencia_gravarFundo(const char* const caminho, const uint64_t geracao, const uint64_t diario,
+                             const int comprimir, const artigocol* const av, const encomendacol* const ev,
+                             const utilizadorcol* const uv) {
+    if (persistencia_fundoEstado == PERSISTENCIA_FUNDO_A_GRAVAR) return 0;
+    persistencia_fundoPct = 0;
+#ifdef _WIN32
+    persistencia_fundoEstado = persistencia_gravar(caminho, geracao, diario, comprimir, av, ev, uv)
+                                   ? PERSISTENCIA_FUNDO_CONCLUIDA
+                                   : PERSISTENCIA_FUNDO_FALHOU;
+    persistencia_fundoPct    = 100;
+    return 1;
+#else
+    int p[2];
+    if (pipe(p)) return 0;
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(p[0]);
+        close(p[1]);
+        return 0;
+    }
+    if (pid == 0) {
+        // Processo filho, não pode voltar ao menu nem correr atexit
+        close(p[0]);
+        persistencia_progressoFd = p[1];
+        const int ok             = persistencia_gravar(caminho, geracao, diario, comprimir, av, ev, uv);
+        fflush(stdout);
+        _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    close(p[1]);
+    fcntl(p[0], F_SETFL, fcntl(p[0], F_GETFL) | O_NONBLOCK);
+    persistencia_fundoPid    = pid;
+    persistencia_fundoFd     = p[0];
+    persistencia_fundoEstado = PERSISTENCIA_FUNDO_A_GRAVAR;
+    return 1;
+#endif
+}
+
+/**
+ * @brief          Lê o progresso e o resultado da gravação em segundo plano.
+ * @param bloquear Se deve esperar que a gravação acabe.
+ * @returns        O estado da gravação.
+ */
+static enum persistencia_fundo persistencia_verificarFundo(const int bloquear) {
+#ifndef _WIN32
+    if (persistencia_fundoEstado != PERSISTENCIA_FUNDO_A_GRAVAR) return persistencia_fundoEstado;
+    uint8_t b[64];
+    ssize_t n;
+    while ((n = read(persistencia_fundoFd, b, sizeof(b))) > 0) persistencia_fundoPct = b[n - 1];
+    int estado;
+    if (waitpid(persistencia_fundoPid, &estado, bloquear ? 0 : WNOHANG) != persistencia_fundoPid) {
+        return persistencia_fundoEstado;
+    }
+    close(persistencia_fundoFd);
+    persistencia_fundoFd     = -1;
+    persistencia_fundoPid    = -1;
+    persistencia_fundoEstado = (WIFEXITED(estado) && WEXITSTATUS(estado) == EXIT_SUCCESS)
+                                   ? PERSISTENCIA_FUNDO_CONCLUIDA
+                                   : PERSISTENCIA_FUNDO_FALHOU;
+    if (persistencia_fundoEstado == PERSISTENCIA_FUNDO_CONCLUIDA) persistencia_fundoPct = 100;
+#else
+    (void) bloquear;
+#endif
+    return persistencia_fundoEstado;
+}
+
+/**
+ * @brief           Verifica, sem bloquear, o estado da gravação em segundo
+ *                  plano. Um estado final (CONCLUIDA ou FALHOU) só é retornado
+ *                  uma vez, as chamadas seguintes retornam
+ *                  PERSISTENCIA_FUNDO_NADA.
+ * @param progresso Onde guardar a percentagem de registos já gravados, pode
+ *                  ser NULL.
+ * @returns         O estado da gravação.
+ */
+enum persistencia_fundo persistencia_estadoFundo(int* const progresso) {
+    const enum persistencia_fundo e = persistencia_verificarFundo(0);
+    if (progresso) *progresso = persistencia_fundoPct;
+    if (e != PERSISTENCIA_FUNDO_A_GRAVAR) persistencia_fundoEstado = PERSISTENCIA_FUNDO_NADA;
+    return e;
+}
+
+/**
+ * @brief   Espera que a gravação em segundo plano acabe.
+ * @returns O estado final da gravação, ou PERSISTENCIA_FUNDO_NADA se não
+ *          havia nenhuma gravação por verificar.
+ */
+enum persistencia_fundo persistencia_esperarFundo() {
+    const enum persistencia_fundo e = persistencia_verificarFundo(1);
+    persistencia_fundoEstado        = PERSISTENCIA_FUNDO_NADA;
+    return e;
+}
+
+
+
+
+// Carregar
+// *********************************************************************************************************************
+/**
+ * @brief     Mapeia 'f' em memória.
+ * @param f   Ficheiro a mapear.
+ * @param tam Onde guardar o tamanho do mapa.
+ * @returns   O mapa, a libertar com persistencia_desmapear.
+ * @returns   NULL se falhou.
+ */
+static char* persistencia_mapearFicheiro(FILE* const f, size_t* const tam) {
+    struct stat st;
+    if (fstat(fileno(f), &st) || st.st_size == 0) return NULL;
+    *tam = st.st_size;
+#ifdef _WIN32
+    char* m = malloc(*tam);
+    if (m && !fread(m, *tam, 1, f)) {
+        free(m);
+        return NULL;
+    }
+    return m;
+#else
+    void* m = mmap(NULL, *tam, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(f), 0);
+    return (m == MAP_FAILED) ? NULL : m;
+#endif
+}
+
+/**
+ * @brief     Liberta um mapa criado por persistencia_mapearFicheiro.
+ * @param m   Mapa a libertar.
+ * @param tam Tamanho do mapa.
+ */
+static void persistencia_desmapear(char* const m, const size_t tam) {
+#ifdef _WIN32
+    (void) tam;
+    free(m);
+#else
+    munmap(m, tam);
+#endif
+}
+
+/**
+ * @brief   Liberta o ficheiro mapeado.
+ * @warning Nenhum objeto pode continuar a emprestar memória do mapa e as
+ *          secções que ainda não foram carregadas são descartadas.
+ */
+void persistencia_fechar() {
+    persistencia_pendentes = 0;
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if ((persistencia_descomprimidas >> t) & 1) free(persistencia_dados[t]);
+        persistencia_dados[t] = NULL;
+    }
+    persistencia_descomprimidas = 0;
+    persistencia_abertas        = 0;
+    persistencia_versao         = PERSISTENCIA_VERSAO;
+    persistencia_arquivoInicio  = 0;
+    persistencia_arquivoFim     = 0;
+    arena_free(&persistencia_arena);
+    if (!persistencia_mapa) return;
+    persistencia_desmapear(persistencia_mapa, persistencia_mapaTam);
+    persistencia_mapa    = NULL;
+    persistencia_mapaTam = 0;
+}
+
+/**
+ * @brief   Verifica se 'p' aponta para o ficheiro mapeado, para uma secção
+ *          descomprimida ou para a arena dos objetos criados ao carregar.
+ * @param p Ponteiro a verificar.
+ * @returns 1 se 'p' é emprestado e não pode ser libertado.
+ * @returns 0 caso contrário.
+ */
+int persistencia_eEmprestado(const void* const p) {
+    if (persistencia_mapa && (const char*) p >= persistencia_mapa &&
+        (const char*) p < persistencia_mapa + persistencia_mapaTam)
+        return 1;
+    // Secções descomprimidas
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        const size_t tam = persistencia_seccoes[t].n * persistencia_tamRegisto[t];
+        if (((persistencia_descomprimidas >> t) & 1) && (const uint8_t*) p >= persistencia_dados[t] &&
+            (const uint8_t*) p < persistencia_dados[t] + tam)
+            return 1;
+    }
+    return arena_contem(&persistencia_arena, p);
+}
+
+/**
+ * @brief   A partir de agora, os objetos alocados com persistencia_alocar e
+ *          persistencia_strdup ficam numa arena libertada de uma só vez com o
+ *          mapa (persistencia_fechar), em vez de um a um.
+ */
+void persistencia_comecarCarga() { persistencia_aCarregar = 1; }
+
+/**
+ * @brief   Volta a alocar os objetos com malloc.
+ */
+void persistencia_acabarCarga() { persistencia_aCarregar = 0; }
+
+/**
+ * @brief     Aloca 'tam' bytes, na arena se estiver a carregar.
+ * @param tam Número de bytes.
+ * @returns   Ponteiro para os bytes, que só podem ser libertados com
+ *            persistencia_libertar.
+ * @returns   NULL se não conseguiu alocar memória.
+ */
+void* persistencia_alocar(const size_t tam) {
+    return persistencia_aCarregar ? arena_alocar(&persistencia_arena, tam) : malloc(tam);
+}
+
+/**
+ * @brief        Redimensiona bytes alocados com persistencia_alocar. Os bytes
+ *               emprestados são copiados para um novo bloco.
+ * @param p      Bytes a redimensionar, ou NULL.
+ * @param antigo Número de bytes em 'p'.
+ * @param tam    Novo número de bytes.
+ * @returns      Ponteiro para os bytes redimensionados.
+ * @returns      NULL se não conseguiu alocar memória ('p' continua válido).
+ */
+void* persistencia_realocar(void* const p, const size_t antigo, const size_t tam) {
+    if (!p || !persistencia_eEmprestado(p)) return realloc(p, tam);
+    if (tam <= antigo) return p;
+    void* const novo = persistencia_alocar(tam);
+    if (novo) memcpy(novo, p, antigo);
+    return novo;
+}
+
+/**
+ * @brief   Liberta bytes alocados com persistencia_alocar, se não forem
+ *          emprestados.
+ * @param p Bytes a libertar.
+ */
+void persistencia_libertar(void* const p) {
+    if (p && !persistencia_eEmprestado(p)) free(p);
+}
+
+/**
+ * @brief   Duplica uma string com persistencia_alocar.
+ * @param s String a duplicar.
+ * @returns Uma cópia da string ou NULL se 's' for NULL.
+ */
+char* persistencia_strdup(const char* const s) {
+    if (!s) return NULL;
+    const size_t len = strlen(s) + 1;
+    char*        new;
+    protectVarFcnCall(new, persistencia_alocar(len), "alocação de memória recusada");
+    memcpy(new, s, len);
+    return new;
+}
+
+/**
+ * @brief   Mapeia 'f' em memória como o ficheiro atual.
+ * @param f Ficheiro a mapear.
+ * @returns 0 se falhou.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_mapear(FILE* const f) {
+    persistencia_mapa = persistencia_mapearFicheiro(f, &persistencia_mapaTam);
+    return persistencia_mapa != NULL;
+}
+
+/**
+ * @brief        Tamanho dos registos de uma secção, tal como estão num
+ *               ficheiro da versão 'versao'.
+ * @param t      Tipo da secção.
+ * @param versao Versão do ficheiro.
+ * @returns      O tamanho de cada registo (1 no bloco de strings).
+ */
+static size_t persistencia_tamNoFicheiro(const enum persistencia_tipo t, const uint32_t versao) {
+    if (t == PERSISTENCIA_COMPRAS && versao < PERSISTENCIA_VERSAO_PRECOS) return sizeof(persistencia_compraAntiga);
+    return persistencia_tamRegisto[t];
+}
+
+/**
+ * @brief         Verifica que uma secção está contida no mapa e que o seu
+ *                tamanho corresponde ao número de registos.
+ * @param s       Secção a verificar.
+ * @param mapaTam Tamanho do mapa.
+ * @param t       Tipo da secção.
+ * @param versao  Versão do ficheiro.
+ * @returns       1 se a secção é válida.
+ * @returns       0 caso contrário.
+ */
+static int persistencia_seccaoValida(const persistencia_seccao* const s, const size_t mapaTam,
+                                     const enum persistencia_tipo t, const uint32_t versao) {
+    const size_t tam = persistencia_tamNoFicheiro(t, versao);
+    if (s->offset % 8 != 0 || s->offset > mapaTam || s->tam > mapaTam - s->offset) return 0;
+    if (s->flags & PERSISTENCIA_COMPRIMIDA) {
+        // Cada bloco tem pelo menos um cabeçalho e no máximo COMPRESSAO_BLOCO bytes descomprimidos
+        return s->n <= (s->tam / sizeof(compressao_bloco)) * (COMPRESSAO_BLOCO / tam);
+    }
+    return s->n == s->tam / tam && s->tam % tam == 0;
+}
+
+/**
+ * @brief   Blocos de uma secção comprimida a descomprimir em paralelo.
+ */
+typedef struct {
+    const uint8_t* src;     ///< Blocos comprimidos
+    uint8_t*       dst;     ///< Onde descomprimir
+    size_t*        origem;  ///< Offset de cada bloco em 'src' (mais o fim)
+    size_t*        destino; ///< Offset de cada bloco em 'dst' (mais o fim)
+} persistencia_blocos;
+
+/**
+ * @brief     Descomprime os blocos [de, ate).
+ * @param arg persistencia_blocos.
+ * @param de  Primeiro bloco.
+ * @param ate Bloco depois do último.
+ * @returns   0 se algum bloco é inválido.
+ * @returns   1 caso contrário.
+ */
+static int persistencia_tarefaBlocos(void* const arg, const size_t de, const size_t ate) {
+    const persistencia_blocos* const b = arg;
+    return compressao_descomprimirBlocos(b->src + b->origem[de], b->origem[ate] - b->origem[de],
+                                         b->dst + b->destino[de], b->destino[ate] - b->destino[de]);
+}
+
+/**
+ * @brief         Descomprime uma sequência de blocos, dividindo-os por várias
+ *                threads depois de percorrer os seus cabeçalhos.
+ * @param src     Blocos, cada um precedido do seu cabeçalho.
+ * @param tam     Tamanho de 'src'.
+ * @param dst     Onde escrever os bytes descomprimidos.
+ * @param tam_dst Número total de bytes depois de descomprimidos.
+ * @param threads Número máximo de threads.
+ * @returns       0 se algum bloco é inválido.
+ * @returns       1 caso contrário.
+ */
+static int persistencia_descomprimir(const uint8_t* const src, const size_t tam, uint8_t* const dst,
+                                     const size_t tam_dst, const int threads) {
+    size_t           n = 0, i = 0, o = 0;
+    compressao_bloco c;
+    if (threads > 1) {
+        for (; i < tam && compressao_lerCabecalho(src + i, tam - i, &c); n++) i += sizeof(c) + c.tam_comprimido;
+    }
+    if (n < 2 * PERSISTENCIA_MIN_BLOCOS || i != tam) return compressao_descomprimirBlocos(src, tam, dst, tam_dst);
+
+    persistencia_blocos b = {src, dst, malloc((n + 1) * sizeof(size_t)), malloc((n + 1) * sizeof(size_t))};
+    int                 ok = b.origem && b.destino;
+    i                      = 0;
+    for (size_t k = 0; ok && k < n; k++) {
+        compressao_lerCabecalho(src + i, tam - i, &c);
+        b.origem[k]  = i;
+        b.destino[k] = o;
+        ok           = c.tam <= tam_dst - o;
+        i += sizeof(c) + c.tam_comprimido;
+        o += c.tam;
+    }
+    if (ok) {
+        b.origem[n]  = i;
+        b.destino[n] = o;
+        ok = o == tam_dst && paralelo_executar(n, PERSISTENCIA_MIN_BLOCOS, threads, persistencia_tarefaBlocos, &b);
+    }
+    free(b.origem);
+    free(b.destino);
+    return ok;
+}
+
+/**
+ * @brief   Secção a abrir por persistencia_tarefaAbrir.
+ */
+typedef struct {
+    enum persistencia_tipo t;       ///< Secção
+    int                    threads; ///< Threads disponíveis para a secção
+    uint8_t*               d;       ///< Onde descomprimir a secção
+} persistencia_abertura;
+
+/**
+ * @brief     Verifica o checksum (0) e descomprime (1) uma secção, para que
+ *            as duas coisas possam ser feitas ao mesmo tempo.
+ * @param arg persistencia_abertura.
+ * @param de  Primeiro passo.
+ * @param ate Passo depois do último.
+ * @returns   0 se a secção está corrompida.
+ * @returns   1 caso contrário.
+ */
+static int persistencia_tarefaAbrir(void* const arg, const size_t de, const size_t ate) {
+    const persistencia_abertura* const a   = arg;
+    const persistencia_seccao* const   s   = &persistencia_seccoes[a->t];
+    const uint8_t* const               src = (uint8_t*) persistencia_mapa + s->offset;
+    int                                ok  = 1;
+    for (size_t i = de; ok && i < ate; i++) {
+        if (i == 0) {
+            ok = fnv1a(src, s->tam, FNV1A_INICIO) == s->checksum;
+        } else {
+            const int    threads = (a->threads > 2) ? a->threads - 1 : 1;
+            const size_t tam     = s->n * persistencia_tamNoFicheiro(a->t, persistencia_versao);
+            ok                   = persistencia_descomprimir(src, s->tam, a->d, tam, threads);
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief         Verifica o checksum de uma secção e, se estiver comprimida,
+ *                descomprime-a para memória. Com mais de uma thread, o
+ *                checksum é calculado enquanto os blocos são descomprimidos.
+ * @param t       Secção a abrir.
+ * @param threads Número máximo de threads.
+ * @returns       1 se a secção está intacta e persistencia_dados[t] aponta
+ *                para os seus registos.
+ * @returns       0 caso contrário.
+ * @warning       Não altera as máscaras de secções, para poder ser chamada ao
+ *                mesmo tempo para secções diferentes.
+ */
+static int persistencia_abrirSeccao(const enum persistencia_tipo t, const int threads) {
+    const persistencia_seccao* const s  = &persistencia_seccoes[t];
+    persistencia_abertura            a  = {t, threads, NULL};
+    int                              ok = 1;
+    if (s->flags & PERSISTENCIA_COMPRIMIDA) {
+        const size_t tam = s->n * persistencia_tamNoFicheiro(t, persistencia_versao);
+        protectVarFcnCall(a.d, malloc(tam ? tam : 1), "alocação de memória recusada");
+        ok = paralelo_executar(2, 1, threads, persistencia_tarefaAbrir, &a);
+    } else {
+        ok = persistencia_tarefaAbrir(&a, 0, 1);
+    }
+    if (!ok) {
+        menu_printError("ao carregar - secção %d do ficheiro corrompida", (int) t);
+        free(a.d);
+        return 0;
+    }
+    const uint8_t* const d = a.d ? a.d : persistencia_dados[t];
+    if (t == PERSISTENCIA_STRINGS && s->n && d[s->n - 1] != '\0') {
+        menu_printError("ao carregar - bloco de strings corrompido");
+        free(a.d);
+        return 0;
+    }
+    if (a.d) persistencia_dados[t] = a.d;
+    return 1;
+}
+
+/**
+ * @brief   Secções a abrir por persistencia_tarefaAbrirSeccoes.
+ */
+typedef struct {
+    enum persistencia_tipo tipos[PERSISTENCIA_N_SECCOES]; ///< Secções a abrir
+    int                    ok[PERSISTENCIA_N_SECCOES];    ///< Se cada secção foi aberta
+    int                    threads;                       ///< Threads disponíveis para cada secção
+} persistencia_aberturas;
+
+/**
+ * @brief     Abre as secções [de, ate).
+ * @param arg persistencia_aberturas.
+ * @param de  Primeira secção.
+ * @param ate Secção depois da última.
+ * @returns   0 se alguma secção está corrompida.
+ * @returns   1 caso contrário.
+ */
+static int persistencia_tarefaAbrirSeccoes(void* const arg, const size_t de, const size_t ate) {
+    persistencia_aberturas* const a  = arg;
+    int                           ok = 1;
+    for (size_t i = de; i < ate; i++) {
+        a->ok[i] = persistencia_abrirSeccao(a->tipos[i], a->threads);
+        ok       = ok && a->ok[i];
+    }
+    return ok;
+}
+
+/**
+ * @brief         Abre várias secções ao mesmo tempo, dividindo as threads
+ *                disponíveis entre elas.
+ * @param seccoes Secções a abrir (bit 1 << tipo).
+ * @returns       0 se alguma secção está corrompida.
+ * @returns       1 caso contrário.
+ */
+static int persistencia_abrirSeccoes(const unsigned seccoes) {
+    persistencia_aberturas a = {.threads = 1};
+    size_t                 n = 0;
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if ((seccoes >> t) & 1) a.tipos[n++] = (enum persistencia_tipo) t;
+    }
+    if (!n) return 1;
+    if (paralelo_threads() > (int) n) a.threads = paralelo_threads() / (int) n;
+    const int ok = paralelo_executar(n, 1, paralelo_threads(), persistencia_tarefaAbrirSeccoes, &a);
+    for (size_t i = 0; i < n; i++) {
+        const enum persistencia_tipo t = a.tipos[i];
+        if (!a.ok[i]) continue;
+        persistencia_abertas |= 1u << t;
+        if (persistencia_seccoes[t].flags & PERSISTENCIA_COMPRIMIDA) persistencia_descomprimidas |= 1u << t;
+    }
+    return ok;
+}
+
+/**
+ * @brief     Retorna o nome com o offset 'off' no bloco de strings.
+ * @details   Se o bloco foi copiado para a tabela de nomes (persistencia_lerStrings)
+ *            o offset é o próprio id, se não o nome é inserido na tabela, o que
+ *            não pode ser feito por várias threads ao mesmo tempo.
+ * @param off Offset do nome.
+ * @returns   O id do nome, ou NOMES_NENHUM.
+ */
+static nomes_id persistencia_nome(const uint32_t off) {
+    const persistencia_seccao* const s = &persistencia_seccoes[PERSISTENCIA_STRINGS];
+    if (off == PERSISTENCIA_SEM_STR || off >= s->n) return NOMES_NENHUM;
+    if (persistencia_adotados) return off;
+    return nomes_inserir((const char*) persistencia_dados[PERSISTENCIA_STRINGS] + off);
+}
+
+/**
+ * @brief   Copia o bloco de strings para a tabela de nomes, se esta estiver
+ *          vazia.
+ * @returns 1.
+ */
+static int persistencia_lerStrings() {
+    const persistencia_seccao* const s = &persistencia_seccoes[PERSISTENCIA_STRINGS];
+    persistencia_adotados = nomes_adotar((const char*) persistencia_dados[PERSISTENCIA_STRINGS], s->n);
+    return 1;
+}
+
+/**
+ * @brief   Número de threads que podem descodificar os artigos ou os clientes.
+ * @returns paralelo_threads(), ou 1 se os nomes têm que ser inseridos na
+ *          tabela de nomes um a um (persistencia_nome).
+ */
+static int persistencia_threadsNomes() { return persistencia_adotados ? paralelo_threads() : 1; }
+
+/**
+ * @brief         Valida o cabeçalho de um ficheiro mapeado e copia a sua
+ *                tabela de secções.
+ * @param mapa    Ficheiro mapeado.
+ * @param mapaTam Tamanho do mapa.
+ * @param seccoes Onde copiar as PERSISTENCIA_N_SECCOES secções conhecidas.
+ * @returns       O cabeçalho do ficheiro.
+ * @returns       NULL se o ficheiro é inválido.
+ */
+static const persistencia_cabecalho* persistencia_validar(const char* const mapa, const size_t mapaTam,
+                                                          persistencia_seccao* const seccoes) {
+    if (mapaTam < sizeof(persistencia_cabecalho)) {
+        menu_printError("ao carregar - ficheiro corrompido");
+        return NULL;
+    }
+    const persistencia_cabecalho* const cab = (persistencia_cabecalho*) mapa;
+    if (cab->versao < PERSISTENCIA_VERSAO_MIN || cab->versao > PERSISTENCIA_VERSAO) {
+        menu_printError("ao carregar - versão %u do ficheiro não suportada", cab->versao);
+        return NULL;
+    }
+    if (cab->endian != PERSISTENCIA_ENDIAN) {
+        menu_printError("ao carregar - ficheiro gravado numa máquina com outra ordem de bytes");
+        return NULL;
+    }
+    if (cab->n_seccoes < PERSISTENCIA_N_SECCOES ||
+        cab->n_seccoes > (mapaTam - sizeof(*cab)) / sizeof(persistencia_seccao)) {
+        menu_printError("ao carregar - ficheiro corrompido");
+        return NULL;
+    }
+    memcpy(seccoes, mapa + sizeof(*cab), sizeof(persistencia_seccao) * PERSISTENCIA_N_SECCOES);
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if (!persistencia_seccaoValida(&seccoes[t], mapaTam, t, cab->versao)) {
+            menu_printError("ao carregar - ficheiro corrompido");
+            return NULL;
+        }
+    }
+    return cab;
+}
+
+/**
+ * @brief   Lê o cabeçalho e a tabela de secções do ficheiro mapeado, sem
+ *          carregar nenhuma coleção.
+ * @returns 0 se o ficheiro é inválido.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_lerCabecalho(uint64_t* const geracao, uint64_t* const diario) {
+    const persistencia_cabecalho* const cab =
+        persistencia_validar(persistencia_mapa, persistencia_mapaTam, persistencia_seccoes);
+    if (!cab) return 0;
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        // As secções comprimidas só são descomprimidas quando forem carregadas
+        const persistencia_seccao* const s = &persistencia_seccoes[t];
+        persistencia_dados[t] = (s->flags & PERSISTENCIA_COMPRIMIDA) ? NULL : (uint8_t*) persistencia_mapa + s->offset;
+    }
+    persistencia_versao        = cab->versao;
+    *geracao                   = cab->geracao;
+    *diario                    = cab->diario;
+    persistencia_arquivoInicio = cab->arquivo_inicio;
+    persistencia_arquivoFim    = cab->arquivo_fim;
+    persistencia_pendentes     = (1u << PERSISTENCIA_N_SECCOES) - 1;
+    return 1;
+}
+
+/**
+ * @brief     Descodifica os artigos [de, ate) para o espaço reservado em
+ *            persistencia_av.
+ * @param arg Não usado.
+ * @param de  Primeiro artigo.
+ * @param ate Artigo depois do último.
+ * @returns   1.
+ */
+static int persistencia_tarefaArtigos(void* const arg, const size_t de, const size_t ate) {
+    (void) arg;
+    const persistencia_artigo* const ra = (persistencia_artigo*) persistencia_dados[PERSISTENCIA_ARTIGOS];
+    for (size_t i = de; i < ate; i++) {
+        artigo* const a = &persistencia_av->data[i];
+        if (ra[i].geracao & 1) {
+            // Slot livre, ligado à lista de livres depois de todos os slots serem lidos
+            memset(a, 0, sizeof(*a));
+            continue;
+        }
+        a->nome       = persistencia_nome(ra[i].nome);
+        a->meta       = ra[i].meta;
+        a->preco_cent = ra[i].preco_cent;
+        a->stock      = ra[i].stock;
+        if (a->nome == NOMES_NENHUM) {
+            menu_printInfo("ao carregar artigo - nome inválido");
+            a->nome = persistencia_semNome;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief   Carrega os artigos a partir do ficheiro mapeado.
+ * @returns 0 se falhou a carregar.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_lerArtigos() {
+    const persistencia_seccao* const s = &persistencia_seccoes[PERSISTENCIA_ARTIGOS];
+    if (s->n > COL_SLOT_MAX || !artigocol_reserve(persistencia_av, s->n)) return 0;
+    persistencia_semNome = nomes_inserir("Nome");
+    paralelo_executar(s->n, PERSISTENCIA_MIN_REGISTOS, persistencia_threadsNomes(), persistencia_tarefaArtigos, NULL);
+    persistencia_av->size = s->n;
+    // Gerações dos slots, só os artigos que já foram removidos e reutilizados não estão na geração 0
+    const persistencia_artigo* const ra = (persistencia_artigo*) persistencia_dados[PERSISTENCIA_ARTIGOS];
+    for (colSize_t i = 0; i < s->n; i++) {
+        if (!artigocol_definirGeracao(persistencia_av, i, ra[i].geracao)) return 0;
+    }
+    artigocol_refazerLivres(persistencia_av);
+    artigo_mudouPreco();
+    return 1;
+}
+
+/**
+ * @brief     Converte compras de um ficheiro anterior a
+ *            PERSISTENCIA_VERSAO_PRECOS para 'compra', sem o preço de venda.
+ * @param src Registos persistencia_compraAntiga, não necessariamente
+ *            alinhados.
+ * @param n   Número de compras.
+ * @param dst Onde escrever as 'n' compras.
+ */
+static void persistencia_converterCompras(const void* const src, const size_t n, compra* const dst) {
+    for (size_t i = 0; i < n; i++) {
+        persistencia_compraAntiga r;
+        memcpy(&r, (const uint8_t*) src + i * sizeof(r), sizeof(r));
+        dst[i] = (compra) {.qtd = r.qtd, .preco_cent = 0, .IDartigo = r.IDartigo, .iva = COMPRA_SEM_PRECO};
+        memcpy(dst[i].receita, r.receita, sizeof(r.receita));
+    }
+}
+
+/**
+ * @brief   Converte as compras do ficheiro mapeado, se este for anterior a
+ *          PERSISTENCIA_VERSAO_PRECOS, para que as encomendas as possam
+ *          emprestar.
+ * @returns 1.
+ */
+static int persistencia_lerCompras() {
+    if (persistencia_versao >= PERSISTENCIA_VERSAO_PRECOS) return 1;
+    const persistencia_seccao* const s = &persistencia_seccoes[PERSISTENCIA_COMPRAS];
+    compra*                          c;
+    protectVarFcnCall(c, malloc(s->n ? s->n * sizeof(compra) : 1), "alocação de memória recusada");
+    persistencia_converterCompras(persistencia_dados[PERSISTENCIA_COMPRAS], s->n, c);
+    if ((persistencia_descomprimidas >> PERSISTENCIA_COMPRAS) & 1) free(persistencia_dados[PERSISTENCIA_COMPRAS]);
+    persistencia_dados[PERSISTENCIA_COMPRAS] = (uint8_t*) c;
+    persistencia_descomprimidas |= 1u << PERSISTENCIA_COMPRAS;
+    return 1;
+}
+
+/**
+ * @brief     Descodifica as encomendas [de, ate) para o espaço reservado em
+ *            persistencia_ev.
+ * @param arg Não usado.
+ * @param de  Primeira encomenda.
+ * @param ate Encomenda depois da última.
+ * @returns   0 se alguma encomenda aponta para compras que não existem.
+ * @returns   1 caso contrário.
+ */
+static int persistencia_tarefaEncomendas(void* const arg, const size_t de, const size_t ate) {
+    (void) arg;
+    const persistencia_seccao* const    sc = &persistencia_seccoes[PERSISTENCIA_COMPRAS];
+    const persistencia_encomenda* const re = (persistencia_encomenda*) persistencia_dados[PERSISTENCIA_ENCOMENDAS];
+    compra* const                       rc = (compra*) persistencia_dados[PERSISTENCIA_COMPRAS];
+    for (size_t i = de; i < ate; i++) {
+        if (re[i].primeira_compra > sc->n || re[i].n_compras > sc->n - re[i].primeira_compra) {
+            menu_printError("ao carregar encomenda - compras inválidas");
+            return 0;
+        }
+        encomenda* const e = encomendacol_at(persistencia_ev, i);
+        e->tempo           = re[i].tempo;
+        e->ID_cliente      = re[i].ID_cliente;
+        e->compras         = compracol_borrow(&rc[re[i].primeira_compra], re[i].n_compras);
+        encomenda_invalidarTotal(e);
+    }
+    return 1;
+}
+
+/**
+ * @brief   Carrega as encomendas a partir do ficheiro mapeado, as compras
+ *          ficam emprestadas do mapa.
+ * @returns 0 se falhou a carregar.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_lerEncomendas() {
+    const persistencia_seccao* const s = &persistencia_seccoes[PERSISTENCIA_ENCOMENDAS];
+    if (!encomendacol_reserve(persistencia_ev, s->n)) return 0;
+    if (!paralelo_executar(s->n, PERSISTENCIA_MIN_REGISTOS, paralelo_threads(), persistencia_tarefaEncomendas,
+                               NULL))
+        return 0;
+    persistencia_ev->size = s->n;
+    return 1;
+}
+
+/**
+ * @brief     Descodifica os clientes [de, ate) para o espaço reservado em
+ *            persistencia_uv.
+ * @param arg Não usado.
+ * @param de  Primeiro cliente.
+ * @param ate Cliente depois do último.
+ * @returns   1.
+ */
+static int persistencia_tarefaClientes(void* const arg, const size_t de, const size_t ate) {
+    (void) arg;
+    const persistencia_utilizador* const ru = (persistencia_utilizador*) persistencia_dados[PERSISTENCIA_CLIENTES];
+    for (size_t i = de; i < ate; i++) {
+        utilizador* const u = &persistencia_uv->data[i];
+        if (ru[i].geracao & 1) {
+            // Slot livre, ligado à lista de livres depois de todos os slots serem lidos
+            memset(u, 0, sizeof(*u));
+            continue;
+        }
+        u->nome = persistencia_nome(ru[i].nome);
+        memcpy(u->NIF, ru[i].NIF, sizeof(u->NIF));
+        memcpy(u->CC, ru[i].CC, sizeof(u->CC));
+        if (u->nome == NOMES_NENHUM) { menu_printInfo("ao carregar utilizador - nome inválido"); }
+    }
+    return 1;
+}
+
+/**
+ * @brief   Carrega os clientes a partir do ficheiro mapeado.
+ * @returns 0 se falhou a carregar.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_lerClientes() {
+    const persistencia_seccao* const s = &persistencia_seccoes[PERSISTENCIA_CLIENTES];
+    if (s->n > COL_SLOT_MAX || !utilizadorcol_reserve(persistencia_uv, s->n)) return 0;
+    paralelo_executar(s->n, PERSISTENCIA_MIN_REGISTOS, persistencia_threadsNomes(), persistencia_tarefaClientes,
+                      NULL);
+    persistencia_uv->size = s->n;
+    // Gerações dos slots, só os clientes que já foram removidos e reutilizados não estão na geração 0
+    const persistencia_utilizador* const ru = (persistencia_utilizador*) persistencia_dados[PERSISTENCIA_CLIENTES];
+    for (colSize_t i = 0; i < s->n; i++) {
+        if (!utilizadorcol_definirGeracao(persistencia_uv, i, ru[i].geracao)) return 0;
+    }
+    utilizadorcol_refazerLivres(persistencia_uv);
+    return 1;
+}
+
+/**
+ * @brief   Verifica se uma secção do ficheiro carregado ainda não foi lida.
+ * @param t Secção a verificar.
+ * @returns 1 se a secção ainda tem que ser carregada com
+ *          persistencia_carregarSeccao.
+ * @returns 0 caso contrário.
+ */
+int persistencia_pendente(const enum persistencia_tipo t) { return (persistencia_pendentes >> t) & 1; }
+
+/**
+ * @brief         Carrega várias secções do ficheiro mapeado para as coleções
+ *                indicadas a persistencia_carregar. As secções pedidas e as
+ *                secções de que dependem (as compras para as encomendas e as
+ *                strings para os artigos e os clientes) são verificadas e
+ *                descomprimidas ao mesmo tempo; os registos de cada secção são
+ *                depois descodificados por várias threads
+ *                (paralelo_definirThreads).
+ * @param seccoes Secções a carregar (bit 1 << tipo).
+ * @returns       0 se alguma secção está corrompida ou falhou a carregar.
+ * @returns       1 caso contrário (ou se as secções já estavam carregadas).
+ */
+int persistencia_carregarSeccoes(unsigned seccoes) {
+    static const unsigned dependencias[PERSISTENCIA_N_SECCOES] = {
+        [PERSISTENCIA_ARTIGOS]    = 1u << PERSISTENCIA_STRINGS,
+        [PERSISTENCIA_ENCOMENDAS] = 1u << PERSISTENCIA_COMPRAS,
+        [PERSISTENCIA_CLIENTES]   = 1u << PERSISTENCIA_STRINGS,
+    };
+    static int (*const ler[PERSISTENCIA_N_SECCOES])() = {
+        [PERSISTENCIA_ARTIGOS]    = persistencia_lerArtigos,
+        [PERSISTENCIA_ENCOMENDAS] = persistencia_lerEncomendas,
+        [PERSISTENCIA_COMPRAS]    = persistencia_lerCompras,
+        [PERSISTENCIA_CLIENTES]   = persistencia_lerClientes,
+        [PERSISTENCIA_STRINGS]    = persistencia_lerStrings,
+    };
+
+    seccoes &= persistencia_pendentes;
+    for (int t = 0; t < PERSISTENCIA_N_SECCOES; t++) {
+        if ((seccoes >> t) & 1) seccoes |= dependencias[t];
+    }
+    int ok = persistencia_abrirSeccoes(seccoes & ~persistencia_abertas);
+    // As dependências são carregadas antes das secções que precisam delas
+    for (int t = PERSISTENCIA_N_SECCOES - 1; t >= 0; t--) {
+        if (!((seccoes >> t) & 1) || !persistencia_pendente((enum persistencia_tipo) t)) continue;
+        const unsigned precisa = (1u << t) | dependencias[t];
+        if ((persistencia_abertas & precisa) != precisa || (ler[t] && !ler[t]())) {
+            ok = 0;
+            continue;
+        }
+        persistencia_pendentes &= ~(1u << t);
+    }
+    return ok;
+}
+
+/**
+ * @brief   Carrega uma secção do ficheiro mapeado (persistencia_carregarSeccoes).
+ * @param t Secção a carregar.
+ * @returns 0 se a secção está corrompida ou falhou a carregar.
+ * @returns 1 caso contrário (ou se a secção já estava carregada).
+ */
+int persistencia_carregarSeccao(const enum persistencia_tipo t) { return persistencia_carregarSeccoes(1u << t); }
+
+
+
+
+// Percorrer sem carregar
+// *********************************************************************************************************************
+/**
+ * @brief           Prepara um leitor sequencial de uma secção.
+ * @param l         Leitor a preparar.
+ * @param mapa      Ficheiro mapeado onde está a secção.
+ * @param s         Secção a ler.
+ * @param tam       Tamanho de cada registo da secção em 'dados'.
+ * @param dados     Registos da secção já descomprimidos, ou NULL se a secção
+ *                  tem que ser lida do mapa.
+ * @param verificar Se o checksum da secção ainda não foi verificado, o que
+ *                  também indica que as suas páginas nunca foram alteradas.
+ */
+static void persistencia_abrirLeitor(persistencia_leitor* const l, const char* const mapa,
+                                     const persistencia_seccao* const s, const size_t tam,
+                                     const uint8_t* const dados, const int verificar) {
+    memset(l, 0, sizeof(*l));
+    l->s          = s;
+    l->mapa       = mapa + s->offset;
+    l->verificar  = verificar;
+    l->comprimida = !dados;
+    l->src        = l->comprimida ? (const uint8_t*) l->mapa : dados;
+    l->tam        = l->comprimida ? s->tam : s->n * tam;
+    l->checksum   = FNV1A_INICIO;
+    if (l->comprimida) {
+        protectVarFcnCall(l->bloco, malloc(COMPRESSAO_BLOCO), "alocação de memória recusada");
+    }
+#ifndef _WIN32
+    if (l->verificar) madvise((void*) l->mapa, s->tam, MADV_SEQUENTIAL);
+#endif
+}
+
+/**
+ * @brief   Devolve ao sistema as páginas do mapa que o leitor já leu, se já
+ *          leu pelo menos PERSISTENCIA_JANELA bytes desde a última vez.
+ * @details Só é usado com secções pendentes, cujas páginas nunca foram
+ *          alteradas e podem ser lidas outra vez do ficheiro.
+ * @param l Leitor.
+ */
+static void persistencia_largar(persistencia_leitor* const l) {
+#ifndef _WIN32
+    if (!l->verificar || l->pos - l->largado < PERSISTENCIA_JANELA) return;
+    const uintptr_t pag = (uintptr_t) sysconf(_SC_PAGESIZE);
+    const uintptr_t ini = ((uintptr_t) (l->src + l->largado) + pag - 1) & ~(pag - 1);
+    const uintptr_t fim = (uintptr_t) (l->src + l->pos) & ~(pag - 1);
+    if (fim > ini) madvise((void*) ini, fim - ini, MADV_DONTNEED);
+    l->largado = l->pos;
+#else
+    (void) l;
+#endif
+}
+
+/**
+ * @brief   Descomprime o próximo bloco da secção.
+ * @param l Leitor de uma secção comprimida.
+ * @returns 0 se a secção acabou ou o bloco é inválido.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_proximoBloco(persistencia_leitor* const l) {
+    compressao_bloco b;
+    if (!compressao_lerCabecalho(l->src + l->pos, l->tam - l->pos, &b)) return 0;
+    const size_t tam = sizeof(b) + b.tam_comprimido;
+    if (!compressao_descomprimirBlocos(l->src + l->pos, tam, l->bloco, b.tam)) return 0;
+    l->checksum = fnv1a(l->src + l->pos, tam, l->checksum);
+    l->pos += tam;
+    l->blocoTam = b.tam;
+    l->blocoPos = 0;
+    persistencia_largar(l);
+    return 1;
+}
+
+/**
+ * @brief   Lê os próximos 'n' bytes da secção.
+ * @param l Leitor.
+ * @param n Número de bytes a ler.
+ * @returns Ponteiro para os 'n' bytes, válido até à próxima leitura.
+ * @returns NULL se a secção acabou ou está corrompida.
+ */
+static const void* persistencia_lerLeitor(persistencia_leitor* const l, const size_t n) {
+    if (!l->comprimida) {
+        if (n > l->tam - l->pos) return NULL;
+        const uint8_t* const p = l->src + l->pos;
+        if (l->verificar) l->checksum = fnv1a(p, n, l->checksum);
+        l->pos += n;
+        persistencia_largar(l);
+        return p;
+    }
+    if (l->blocoTam - l->blocoPos >= n) {
+        l->blocoPos += n;
+        return l->bloco + l->blocoPos - n;
+    }
+
+    // Os bytes atravessam o fim do bloco
+    if (l->juntoAloc < n) {
+        protectVarFcnCall(l->junto, realloc(l->junto, n), "alocação de memória recusada");
+        l->juntoAloc = n;
+    }
+    for (size_t k = 0; k < n;) {
+        if (l->blocoPos == l->blocoTam && !persistencia_proximoBloco(l)) return NULL;
+        const size_t c = (n - k < l->blocoTam - l->blocoPos) ? n - k : l->blocoTam - l->blocoPos;
+        memcpy(l->junto + k, l->bloco + l->blocoPos, c);
+        l->blocoPos += c;
+        k += c;
+    }
+    return l->junto;
+}
+
+/**
+ * @brief   Liberta o leitor e verifica que a secção foi lida até ao fim sem
+ *          erros.
+ * @param l Leitor.
+ * @returns 0 se a secção tem bytes a mais ou o seu checksum não corresponde.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_fecharLeitor(persistencia_leitor* const l) {
+    const int ok = l->pos == l->tam && l->blocoPos == l->blocoTam && (!l->verificar || l->checksum == l->s->checksum);
+    free(l->bloco);
+    free(l->junto);
+#ifndef _WIN32
+    if (l->verificar) madvise((void*) l->mapa, l->s->tam, MADV_NORMAL);
+#endif
+    return ok;
+}
+
+/**
+ * @brief           Percorre as encomendas de um ficheiro mapeado por ordem,
+ *                  lendo as secções das encomendas e das compras ao mesmo
+ *                  tempo, sem as carregar.
+ * @param mapa      Ficheiro mapeado.
+ * @param seccoes   Tabela de secções do ficheiro.
+ * @param dados     Registos de cada secção já descomprimidos, ou NULL.
+ * @param verificar Secções cujo checksum ainda não foi verificado (bit
+ *                  1 << tipo).
+ * @param tamCompra Tamanho de cada compra na secção das compras (ver
+ *                  persistencia_tamNoFicheiro). As compras de um ficheiro
+ *                  anterior a PERSISTENCIA_VERSAO_PRECOS são convertidas.
+ * @param predicate Função chamada com cada encomenda.
+ * @param userData  Dados passados a 'predicate'.
+ * @returns         0 se as secções estão corrompidas.
+ * @returns         1 caso contrário.
+ */
+static int persistencia_percorrer(const char* const mapa, const persistencia_seccao* const seccoes,
+                                  uint8_t* const* const dados, const unsigned verificar, const size_t tamCompra,
+                                  encomendacol_pred_t predicate, void* const userData) {
+    persistencia_leitor le, lc;
+    persistencia_abrirLeitor(&le, mapa, &seccoes[PERSISTENCIA_ENCOMENDAS], sizeof(persistencia_encomenda),
+                             dados[PERSISTENCIA_ENCOMENDAS], verificar & (1u << PERSISTENCIA_ENCOMENDAS));
+    persistencia_abrirLeitor(&lc, mapa, &seccoes[PERSISTENCIA_COMPRAS], tamCompra, dados[PERSISTENCIA_COMPRAS],
+                             verificar & (1u << PERSISTENCIA_COMPRAS));
+
+    uint64_t  compras = 0;
+    colSize_t i;
+    int       parou = 0;
+    // Compras da encomenda atual, se tiverem que ser convertidas
+    compra*   convertidas = NULL;
+    colSize_t alocadas    = 0;
+    for (i = 0; i < le.s->n; i++) {
+        const void* const p = persistencia_lerLeitor(&le, sizeof(persistencia_encomenda));
+        if (!p) break;
+        persistencia_encomenda r;
+        memcpy(&r, p, sizeof(r));
+        if (r.primeira_compra != compras || r.n_compras > lc.s->n - compras) break;
+        const void* c = persistencia_lerLeitor(&lc, (size_t) r.n_compras * tamCompra);
+        if (!c) break;
+        if (tamCompra != sizeof(compra)) {
+            if (alocadas < r.n_compras) {
+                protectVarFcnCall(convertidas, realloc(convertidas, sizeof(compra) * r.n_compras),
+                                  "alocação de memória recusada");
+                alocadas = r.n_compras;
+            }
+            persistencia_converterCompras(c, r.n_compras, convertidas);
+            c = convertidas;
+        }
+        compras += r.n_compras;
+        encomenda e = {.tempo      = r.tempo,
+                       .ID_cliente = r.ID_cliente,
+                       .compras    = compracol_borrow((compra*) c, r.n_compras)};
+        if (predicate(&e, userData)) {
+            parou = 1;
+            break;
+        }
+    }
+    free(convertidas);
+    // Se a iteração parou a meio não é possível verificar os checksums
+    const int ok_e = persistencia_fecharLeitor(&le);
+    const int ok_c = persistencia_fecharLeitor(&lc);
+    const int ok   = parou || (i == le.s->n && compras == lc.s->n && ok_e && ok_c);
+    if (!ok) menu_printError("ao percorrer encomendas - secção do ficheiro corrompida");
+    return ok;
+}
+
+/**
+ * @brief           Percorre as encomendas por ordem sem as carregar para a
+ *                  coleção, com a mesma forma que encomendacol_iterateFW.
+ * @details         Cada encomenda é lida da secção ainda pendente, com as
+ *                  compras emprestadas do mapa ou do bloco descomprimido, e só
+ *                  existe durante a chamada a 'predicate'. A memória usada não
+ *                  depende do número de encomendas: as secções comprimidas são
+ *                  descomprimidas um bloco de cada vez e as páginas já lidas
+ *                  são devolvidas ao sistema. Se as encomendas já foram
+ *                  carregadas percorre a coleção.
+ * @param predicate Função chamada com cada encomenda, que não a pode alterar;
+ *                  a iteração pára quando retornar verdade.
+ * @param userData  Dados passados a 'predicate'.
+ * @returns         0 se as secções estão corrompidas, depois de passar a
+ *                  'predicate' as encomendas anteriores ao erro.
+ * @returns         1 caso contrário.
+ * @warning         Os registos do diário não são aplicados, só deve ser usado
+ *                  se o diário não tiver registos das encomendas
+ *                  (diario_adiado).
+ */
+int persistencia_percorrerEncomendas(encomendacol_pred_t predicate, void* const userData) {
+    if (!persistencia_pendente(PERSISTENCIA_ENCOMENDAS)) {
+        encomendacol_iterateFW(persistencia_ev, predicate, userData);
+        return 1;
+    }
+    // As compras já carregadas foram convertidas por persistencia_lerCompras
+    const size_t tamCompra = persistencia_pendente(PERSISTENCIA_COMPRAS)
+                                 ? persistencia_tamNoFicheiro(PERSISTENCIA_COMPRAS, persistencia_versao)
+                                 : sizeof(compra);
+    return persistencia_percorrer(persistencia_mapa, persistencia_seccoes, persistencia_dados, persistencia_pendentes,
+                                  tamCompra, predicate, userData);
+}
+
+
+
+
+// Arquivo mensal
+// *********************************************************************************************************************
+/**
+ * @brief       Mês de uma data, tal como é usado para nomear os ficheiros do
+ *              arquivo.
+ * @param tempo Data.
+ * @returns     O ano vezes 12 mais o mês (de 0 a 11), no fuso horário local.
+ */
+uint32_t persistencia_mes(const time_t tempo) {
+    struct tm t;
+#ifdef _WIN32
+    if (localtime_s(&t, &tempo)) return 0;
+#else
+    if (!localtime_r(&tempo, &t)) return 0;
+#endif
+    return (uint32_t) (t.tm_year + 1900) * 12 + t.tm_mon;
+}
+
+/**
+ * @brief   Primeiro mês que ainda não foi arquivado.
+ * @returns O mês (ver persistencia_mes), ou 0 se nenhum mês foi arquivado.
+ */
+uint32_t persistencia_mesAberto() { return persistencia_arquivoFim; }
+
+/**
+ * @brief         Nome do ficheiro do arquivo de um mês.
+ * @param caminho Ficheiro de dados.
+ * @param mes     Mês do arquivo.
+ * @returns       "caminho.AAAA-MM.seg", a libertar com free.
+ */
+static char* persistencia_caminhoArquivo(const char* const caminho, const uint32_t mes) {
+    const size_t tam = strlen(caminho) + 16;
+    char*        c;
+    protectVarFcnCall(c, malloc(tam), "alocação de memória recusada");
+    snprintf(c, tam, "%s.%04u-%02u.seg", caminho, mes / 12, mes % 12 + 1);
+    return c;
+}
+
+/**
+ * @brief   Mês e index de uma encomenda a arquivar.
+ */
+typedef struct {
+    uint32_t  mes; ///< Mês da encomenda
+    colSize_t i;   ///< Index da encomenda
+} persistencia_arquivada;
+
+/**
+ * @brief   Ordena as encomendas a arquivar por mês e, dentro do mês, pela
+ *          ordem em que estão na coleção.
+ * @param a persistencia_arquivada.
+ * @param b persistencia_arquivada.
+ * @returns Negativo, 0 ou positivo como strcmp.
+ */
+static int persistencia_compararArquivadas(const void* const a, const void* const b) {
+    const persistencia_arquivada* const x = a;
+    const persistencia_arquivada* const y = b;
+    if (x->mes != y->mes) return x->mes < y->mes ? -1 : 1;
+    return (x->i > y->i) - (x->i < y->i);
+}
+
+/**
+ * @brief           Grava num ficheiro por mês as encomendas dos meses entre
+ *                  o primeiro mês aberto e 'fim'.
+ * @details         Cada ficheiro tem o formato de um ficheiro de dados só com
+ *                  encomendas e compras e substitui um ficheiro do mesmo mês
+ *                  deixado por um arquivo que não chegou a ser concluído. As
+ *                  encomendas continuam na coleção até serem retiradas com
+ *                  persistencia_retirarArquivadas.
+ * @param caminho   Ficheiro de dados.
+ * @param ev        Encomendas.
+ * @param fim       Primeiro mês que não deve ser arquivado.
+ * @param comprimir Se os ficheiros devem ser gravados em blocos comprimidos.
+ * @returns         0 se falhou a gravar algum mês.
+ * @returns         1 caso contrário.
+ */
+int persistencia_arquivar(const char* const caminho, const encomendacol* const ev, const uint32_t fim,
+                          const int comprimir) {
+    const uint32_t          de = persistencia_arquivoFim;
+    persistencia_arquivada* a;
+    colSize_t               n = 0;
+    protectVarFcnCall(a, malloc(sizeof(*a) * (ev->size ? ev->size : 1)), "alocação de memória recusada");
+    for (colSize_t i = 0; i < ev->size; i++) {
+        const uint32_t mes = persistencia_mes(encomendacol_at(ev, i)->tempo);
+        if (mes >= de && mes < fim) a[n++] = (persistencia_arquivada) {.mes = mes, .i = i};
+    }
+    qsort(a, n, sizeof(*a), persistencia_compararArquivadas);
+
+    const artigocol     av  = artigocol_new();
+    const utilizadorcol uv  = utilizadorcol_new();
+    encomendacol        mes = encomendacol_new();
+    int                 ok  = 1;
+    for (colSize_t i = 0; ok && i < n;) {
+        colSize_t j = i;
+        while (j < n && a[j].mes == a[i].mes) j++;
+
+        // As encomendas do mês são copiadas sem as suas compras, que continuam a pertencer a 'ev'
+        ok = encomendacol_reserve(&mes, j - i);
+        for (mes.size = 0; ok && mes.size < j - i; mes.size++)
+            *encomendacol_at(&mes, mes.size) = *encomendacol_at(ev, a[i + mes.size].i);
+        char* const c = persistencia_caminhoArquivo(caminho, a[i].mes);
+        ok            = ok && persistencia_gravar(c, 0, 0, comprimir, &av, &mes, &uv);
+        free(c);
+        i = j;
+    }
+    // As compras pertencem a 'ev', só os segmentos de 'mes' são libertados
+    mes.size = 0;
+    encomendacol_free(&mes);
+    free(a);
+    return ok;
+}
+
+/**
+ * @brief   Meses retirados por persistencia_retirarArquivadas.
+ */
+typedef struct {
+    uint32_t de;       ///< Primeiro mês a retirar
+    uint32_t fim;      ///< Primeiro mês que não é retirado
+    uint32_t primeiro; ///< Primeiro mês com encomendas retiradas, 'fim' se nenhuma foi
+} persistencia_meses;
+
+/**
+ * @brief   Pode ser utilizado como um iterador, verifica se a encomenda é de
+ *          um mês a retirar.
+ * @param e Encomenda.
+ * @param m Meses a retirar.
+ * @returns 1 se a encomenda deve ser retirada, 0 caso contrário.
+ */
+static int persistencia_pred_arquivada(const encomenda* const e, persistencia_meses* const m) {
+    const uint32_t mes = persistencia_mes(e->tempo);
+    if (mes < m->de || mes >= m->fim) return 0;
+    if (mes < m->primeiro) m->primeiro = mes;
+    return 1;
+}
+
+/**
+ * @brief     Retira da coleção as encomendas dos meses entre 'de' e 'fim',
+ *            depois de gravadas com persistencia_arquivar, e marca esses
+ *            meses como arquivados.
+ * @param ev  Encomendas.
+ * @param de  Primeiro mês aberto quando as encomendas foram arquivadas.
+ * @param fim Primeiro mês que não foi arquivado.
+ * @warning   Os index das encomendas seguintes mudam.
+ */
+void persistencia_retirarArquivadas(encomendacol* const ev, const uint32_t de, const uint32_t fim) {
+    persistencia_meses m = {.de = de, .fim = fim, .primeiro = fim};
+    encomendacol_removeIf(ev, (encomendacol_pred_t) &persistencia_pred_arquivada, &m);
+    const uint32_t primeiro = m.primeiro;
+    if (!persistencia_arquivoInicio || primeiro < persistencia_arquivoInicio) persistencia_arquivoInicio = primeiro;
+    if (fim > persistencia_arquivoFim) persistencia_arquivoFim = fim;
+}
+
+/**
+ * @brief           Percorre as encomendas arquivadas dos meses entre 'de' e
+ *                  'ate', tal como persistencia_percorrerEncomendas, abrindo
+ *                  só os ficheiros desses meses.
+ * @param caminho   Ficheiro de dados.
+ * @param de        Primeiro mês a percorrer.
+ * @param ate       Primeiro mês que não deve ser percorrido.
+ * @param predicate Função chamada com cada encomenda, que não a pode alterar;
+ *                  quando retornar verdade passa para o mês seguinte.
+ * @param userData  Dados passados a 'predicate'.
+ * @returns         0 se o ficheiro de algum mês está corrompido.
+ * @returns         1 caso contrário.
+ */
+int persistencia_percorrerArquivo(const char* const caminho, const uint32_t de, const uint32_t ate,
+                                  encomendacol_pred_t predicate, void* const userData) {
+    const uint32_t inicio = de > persistencia_arquivoInicio ? de : persistencia_arquivoInicio;
+    const uint32_t fim    = ate < persistencia_arquivoFim ? ate : persistencia_arquivoFim;
+    for (uint32_t m = inicio; m < fim; m++) {
+        char* const c = persistencia_caminhoArquivo(caminho, m);
+        FILE* const f = fopen(c, "rb");
+        free(c);
+        // Um mês sem encomendas não tem ficheiro
+        if (!f) continue;
+        size_t      tam  = 0;
+        char* const mapa = persistencia_mapearFicheiro(f, &tam);
+        fclose(f);
+        if (!mapa) {
+            menu_printError("ao percorrer arquivo - mês %u/%u não pode ser mapeado", m / 12, m % 12 + 1);
+            return 0;
+        }
+
+        persistencia_seccao                 seccoes[PERSISTENCIA_N_SECCOES];
+        uint8_t*                            dados[PERSISTENCIA_N_SECCOES];
+        const persistencia_cabecalho* const cab = persistencia_validar(mapa, tam, seccoes);
+        int ok = cab && !memcmp(cab->magia, PERSISTENCIA_MAGIA, sizeof(cab->magia));
+        for (int t = 0; ok && t < PERSISTENCIA_N_SECCOES; t++) {
+            dados[t] = (seccoes[t].flags & PERSISTENCIA_COMPRIMIDA) ? NULL : (uint8_t*) mapa + seccoes[t].offset;
+        }
+        ok = ok && persistencia_percorrer(mapa, seccoes, dados, ~0u,
+                                          persistencia_tamNoFicheiro(PERSISTENCIA_COMPRAS, cab->versao), predicate,
+                                          userData);
+        persistencia_desmapear(mapa, tam);
+        if (!ok) return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief      Carrega uma encomenda no formato antigo (antes do cabeçalho),
+ *             onde a data da encomenda não era gravada.
+ * @param f    Ficheiro de onde carregar a encomenda.
+ * @param data Encomenda para salvar os dados carregados.
+ * @returns    0 se falhou ao carregar a encomenda.
+ * @returns    1 se carregou a encomenda com sucesso.
+ */
+static int persistencia_lerEncomendaAntiga(FILE* const f, encomenda* const data) {
+    colSize_t size = 0;
+    data->compras  = compracol_new();
+    data->tempo    = 0;
+    encomenda_invalidarTotal(data);
+    if (!fread(&size, sizeof(colSize_t), 1, f)) return 0;
+    if (!compracol_reserve(&data->compras, size)) return 0;
+    for (colSize_t i = 0; i < size; i++) {
+        if (!load_compra(f, &compracol_data(&data->compras)[i])) return 0;
+        data->compras.size++;
+    }
+    return fread(&data->ID_cliente, sizeof(colSize_t), 1, f);
+}
+
+/**
+ * @brief   Carrega as coleções de um ficheiro no formato antigo, em que as
+ *          coleções estavam simplesmente gravadas umas a seguir às outras.
+ * @returns 0 se falhou a carregar.
+ * @returns 1 caso contrário.
+ */
+static int persistencia_lerAntigo(FILE* const f, artigocol* const av, encomendacol* const ev,
+                                  utilizadorcol* const uv) {
+    if (!artigocol_read(av, f)) return 0;
+    artigo_mudouPreco();
+    colSize_t size = 0;
+    if (!fread(&size, sizeof(colSize_t), 1, f)) return 0;
+    if (!encomendacol_reserve(ev, size)) return 0;
+    for (colSize_t i = 0; i < size; i++) {
+        if (!persistencia_lerEncomendaAntiga(f, encomendacol_at(ev, i))) {
+            freeEncomenda(encomendacol_at(ev, i));
+            return 0;
+        }
+        ev->size++;
+    }
+    return utilizadorcol_read(uv, f);
+}
+
+/**
+ * @brief         Abre o ficheiro 'caminho' para carregar as três coleções.
+ * @details       O ficheiro é mapeado em memória mas apenas o cabeçalho é lido;
+ *                cada coleção fica pendente até ser pedida com
+ *                persistencia_carregarSeccao. Os nomes e as compras ficam a
+ *                apontar para o mapa até à próxima chamada desta função ou de
+ *                persistencia_fechar. Ficheiros no formato antigo são lidos
+ *                por completo e copiados para memória.
+ * @param caminho Ficheiro de onde carregar.
+ * @param geracao Onde guardar a geração do ficheiro (0 no formato antigo).
+ * @param diario  Onde guardar quantos bytes do diário da geração anterior já
+ *                estão incluídos no ficheiro.
+ * @param av      Coleção vazia onde carregar os artigos.
+ * @param ev      Coleção vazia onde carregar as encomendas.
+ * @param uv      Coleção vazia onde carregar os clientes.
+ * @returns       0 se falhou a carregar.
+ * @returns       1 caso contrário.
+ * @warning       O mapa anterior é libertado, as coleções carregadas
+ *                anteriormente têm que já ter sido libertadas. As coleções têm
+ *                que continuar a existir enquanto houver secções pendentes.
+ */
+int persistencia_carregar(const char* const caminho, uint64_t* const geracao, uint64_t* const diario,
+                          artigocol* const av, encomendacol* const ev, utilizadorcol* const uv) {
+    persistencia_fechar();
+    FILE* f = fopen(caminho, "rb");
+    if (!f) {
+        menu_printError("ao carregar - '%s' não pode ser aberto", caminho);
+        return 0;
+    }
+
+    char magia[4] = {0};
+    int  ok;
+    *geracao        = 0;
+    *diario         = 0;
+    persistencia_av = av;
+    persistencia_ev = ev;
+    persistencia_uv = uv;
+    if (fread(magia, sizeof(magia), 1, f) && !memcmp(magia, PERSISTENCIA_MAGIA, sizeof(magia))) {
+        ok = persistencia_mapear(f);
+        if (!ok) menu_printError("ao carregar - '%s' não pode ser mapeado", caminho);
+        ok = ok && persistencia_lerCabecalho(geracao, diario);
+    } else {
+        menu_printInfo("a carregar ficheiro no formato antigo");
+        rewind(f);
+        persistencia_comecarCarga();
+        ok = persistencia_lerAntigo(f, av, ev, uv);
+        persistencia_acabarCarga();
+    }
+    fclose(f);
+    return ok;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file    persistencia.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Responsável por gravar e carregar o estado do programa num ficheiro
+ *          que pode ser mapeado em memória e utilizado diretamente.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef PERSISTENCIA_H
+#define PERSISTENCIA_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "artigo.h"
+#include "encomenda.h"
+#include "utilizador.h"
+
+#ifndef encomendacol_H
+#    define encomendacol_H
+#    define COL_TIPO encomenda
+#    define COL_NOME encomendacol
+#    define COL_PARALELO
+#    define COL_SEGMENTOS
+#    define COL_DEALOC(X) freeEncomenda(X)
+#    define COL_WRITE(X, F) save_encomenda(F, X)
+#    define COL_READ(X, F) load_encomenda(F, X)
+#    include "colecao.h"
+#endif
+
+#ifndef utilizadorcol_H
+#    define utilizadorcol_H
+#    define COL_TIPO utilizador
+#    define COL_NOME utilizadorcol
+#    define COL_SLOTS
+#    define COL_DEALOC(X) freeUtilizador(X)
+#    define COL_WRITE(X, F) save_utilizador(F, X)
+#    define COL_READ(X, F) load_utilizador(F, X)
+#    include "colecao.h"
+#endif
+
+/**
+ * @def PERSISTENCIA_MAGIA
+ *          Primeiros 4 bytes de um ficheiro no formato atual.
+ * @def PERSISTENCIA_VERSAO
+ *          Versão do formato do ficheiro.
+ * @def PERSISTENCIA_VERSAO_MIN
+ *          Versão mais antiga que ainda é carregada. A versão 6 só difere da
+ *          versão 7 por não ter slots livres (a geração dos registos é sempre
+ *          0).
+ * @def PERSISTENCIA_VERSAO_PRECOS
+ *          Primeira versão em que as compras têm o preço de venda. Nas versões
+ *          anteriores a tabela de compras é de persistencia_compraAntiga, que
+ *          são convertidas ao carregar (sem o preço registado).
+ * @def PERSISTENCIA_ENDIAN
+ *          Escrito tal como está em memória para detetar ficheiros gravados
+ *          numa máquina com outra ordem de bytes.
+ * @def PERSISTENCIA_SEM_STR
+ *          Offset de uma string nula.
+ * @def PERSISTENCIA_COMPRIMIDA
+ *          Flag de uma secção gravada em blocos comprimidos (ver compressao.h).
+ */
+#define PERSISTENCIA_MAGIA "LP1S"
+#define PERSISTENCIA_VERSAO ((uint32_t) 8)
+#define PERSISTENCIA_VERSAO_MIN ((uint32_t) 6)
+#define PERSISTENCIA_VERSAO_PRECOS ((uint32_t) 8)
+#define PERSISTENCIA_ENDIAN ((uint32_t) 0x01020304)
+#define PERSISTENCIA_SEM_STR (~(uint32_t) 0)
+#define PERSISTENCIA_COMPRIMIDA ((uint32_t) 1)
+
+/**
+ * @brief Secções do ficheiro, pela ordem em que aparecem na tabela de
+ *        secções.
+ */
+enum persistencia_tipo {
+    PERSISTENCIA_ARTIGOS    = 0, ///< Tabela de persistencia_artigo
+    PERSISTENCIA_ENCOMENDAS = 1, ///< Tabela de persistencia_encomenda
+    PERSISTENCIA_COMPRAS    = 2, ///< Tabela de compra
+    PERSISTENCIA_CLIENTES   = 3, ///< Tabela de persistencia_utilizador
+    PERSISTENCIA_STRINGS    = 4, ///< Bloco de strings terminadas em '\0'
+    PERSISTENCIA_N_SECCOES  = 5  ///< Número de secções conhecidas
+};
+
+/**
+ * @brief   Cabeçalho do ficheiro, seguido da tabela de 'n_seccoes'
+ *          persistencia_seccao. Secções para além das conhecidas por esta
+ *          versão são ignoradas.
+ */
+typedef struct {
+    char     magia[4];       ///< PERSISTENCIA_MAGIA
+    uint32_t versao;         ///< PERSISTENCIA_VERSAO
+    uint32_t endian;         ///< PERSISTENCIA_ENDIAN
+    uint32_t n_seccoes;      ///< Número de entradas na tabela de secções
+    uint64_t geracao;        ///< Geração do ficheiro, ver diario.h
+    uint64_t diario;         ///< Bytes do diário da geração anterior já incluídos no ficheiro
+    uint32_t arquivo_inicio; ///< Primeiro mês arquivado (ver persistencia_arquivar)
+    uint32_t arquivo_fim;    ///< Primeiro mês que não está arquivado, 0 se nenhum está
+} persistencia_cabecalho;
+
+/**
+ * @brief   Entrada da tabela de secções. Todas as secções começam num offset
+ *          múltiplo de 8 para que os registos possam ser lidos diretamente do
+ *          ficheiro mapeado.
+ */
+typedef struct {
+    uint64_t offset;   ///< Offset da secção no ficheiro
+    uint64_t tam;      ///< Tamanho da secção em bytes, tal como está no ficheiro
+    uint64_t n;        ///< Número de registos (bytes no bloco de strings)
+    uint32_t checksum; ///< fnv1a dos bytes da secção, tal como está no ficheiro
+    uint32_t flags;    ///< 0 ou PERSISTENCIA_COMPRIMIDA
+} persistencia_seccao;
+
+/**
+ * @brief Estado de uma gravação em segundo plano.
+ */
+enum persistencia_fundo {
+    PERSISTENCIA_FUNDO_NADA      = 0, ///< Nenhuma gravação foi iniciada
+    PERSISTENCIA_FUNDO_A_GRAVAR  = 1, ///< A gravação ainda não acabou
+    PERSISTENCIA_FUNDO_CONCLUIDA = 2, ///< O ficheiro foi substituído
+    PERSISTENCIA_FUNDO_FALHOU    = 3  ///< O ficheiro anterior foi mantido
+};
+
+/**
+ * @brief   Registo de tamanho fixo de um artigo.
+ */
+typedef struct {
+    uint32_t nome;       ///< Offset do nome no bloco de strings
+    uint8_t  meta;       ///< Info sobre o artigo
+    uint8_t  geracao;    ///< Geração do slot em artigocol, ímpar se o slot está livre
+    uint8_t  _pad[2];    ///< Sempre 0
+    int64_t  preco_cent; ///< Preço base do artigo em cêntimos
+    int64_t  stock;      ///< Stock do artigo
+} persistencia_artigo;
+
+/**
+ * @brief   Registo de tamanho fixo de uma encomenda, as suas compras estão
+ *          guardadas seguidas na tabela de compras.
+ */
+typedef struct {
+    int64_t   tempo;           ///< Data de criação da encomenda
+    colSize_t ID_cliente;      ///< ID do cliente que formalizou a encomenda
+    colSize_t n_compras;       ///< Número de compras da encomenda
+    uint64_t  primeira_compra; ///< Index da primeira compra na tabela de compras
+} persistencia_encomenda;
+
+/**
+ * @brief   Registo de tamanho fixo de uma compra nas versões anteriores a
+ *          PERSISTENCIA_VERSAO_PRECOS, sem o preço de venda.
+ */
+typedef struct {
+    int64_t   qtd;         ///< Quantidade de artigos encomendados
+    colSize_t IDartigo;    ///< Handle do artigo (COL_SLOT_HANDLE)
+    char      receita[19]; ///< Receita do artigo
+    uint8_t   _pad;        ///< Sempre 0
+} persistencia_compraAntiga;
+
+/**
+ * @brief   Registo de tamanho fixo de um utilizador.
+ */
+typedef struct {
+    uint32_t nome;    ///< Offset do nome no bloco de strings
+    char     NIF[9];  ///< NIF do cliente
+    char     CC[12];  ///< Número de cartão de cidadão do cliente
+    uint8_t  geracao; ///< Geração do slot em utilizadorcol, ímpar se o slot está livre
+    uint8_t  _pad[2]; ///< Sempre 0
+} persistencia_utilizador;
+
+int                     persistencia_gravar(const char* const caminho, const uint64_t geracao, const uint64_t diario,
+                                            const int comprimir, const artigocol* const av,
+                                            const encomendacol* const ev, const utilizadorcol* const uv);
+int                     persistencia_gravarFundo(const char* const caminho, const uint64_t geracao,
+                                                 const uint64_t diario, const int comprimir, const artigocol* const av,
+                                                 const encomendacol* const ev, const utilizadorcol* const uv);
+enum persistencia_fundo persistencia_estadoFundo(int* const progresso);
+enum persistencia_fundo persistencia_esperarFundo();
+int                     persistencia_carregar(const char* const caminho, uint64_t* const geracao,
+                                              uint64_t* const diario, artigocol* const av, encomendacol* const ev,
+                                              utilizadorcol* const uv);
+int                     persistencia_pendente(const enum persistencia_tipo t);
+int                     persistencia_percorrerEncomendas(encomendacol_pred_t predicate, void* const userData);
+uint32_t                persistencia_mes(const time_t tempo);
+uint32_t                persistencia_mesAberto();
+int                     persistencia_arquivar(const char* const caminho, const encomendacol* const ev,
+                                              const uint32_t fim, const int comprimir);
+void                    persistencia_retirarArquivadas(encomendacol* const ev, const uint32_t de, const uint32_t fim);
+int                     persistencia_percorrerArquivo(const char* const caminho, const uint32_t de, const uint32_t ate,
+                                                      encomendacol_pred_t predicate, void* const userData);
+int                     persistencia_carregarSeccao(const enum persistencia_tipo t);
+int                     persistencia_carregarSeccoes(unsigned seccoes);
+void                    persistencia_fechar();
+int                     persistencia_eEmprestado(const void* const p);
+void                    persistencia_comecarCarga();
+void                    persistencia_acabarCarga();
+void*                   persistencia_alocar(const size_t tam);
+void*                   persistencia_realocar(void* const p, const size_t antigo, const size_t tam);
+void                    persistencia_libertar(void* const p);
+char*                   persistencia_strdup(const char* const s);
+
+#endif
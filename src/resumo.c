@@ -0,0 +1,268 @@
+/**
+ * @file    resumo.c
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Resumos mensais do número de encomendas, compras e artigos e do
+ *          total gasto por cada cliente.
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "resumo.h"
+
+#ifndef _WIN32
+#    include <unistd.h>
+#endif
+
+#include "menu.h"
+#include "persistencia.h"
+#include "utilities.h"
+
+#define COL_IMPLEMENTACAO
+#define TAB_TIPO resumo_chave
+#define TAB_NOME resumotab
+#include "tabela.h"
+#undef COL_IMPLEMENTACAO
+
+static resumotab resumo_tabela;          ///< Index em 'resumo_dados' de cada chave
+static resumo*   resumo_dados    = NULL; ///< Resumos, pela ordem em que foram criados
+static size_t    resumo_n        = 0;    ///< Número de resumos em 'resumo_dados'
+static size_t    resumo_alocado  = 0;    ///< Resumos alocados em 'resumo_dados'
+static int       resumo_validos  = 0;    ///< Se os resumos correspondem às encomendas
+static uint64_t  resumo_semPreco = 0;    ///< Compras sem o preço registado incluídas nos resumos
+
+/**
+ * @brief   Procura o resumo de uma chave, criando-o vazio se ainda não
+ *          existir.
+ * @param k Chave.
+ * @returns O resumo, válido até ser criado outro resumo.
+ */
+static resumo* resumo_criar(const resumo_chave k) {
+    const colSize_t i = resumotab_obter(&resumo_tabela, &k);
+    if (i != COL_INVAL_INDEX) return &resumo_dados[i];
+    if (resumo_n == resumo_alocado) {
+        const size_t novo = resumo_alocado ? resumo_alocado * 2 : 64;
+        protectVarFcnCall(resumo_dados, realloc(resumo_dados, sizeof(resumo) * novo), "alocação de memória recusada");
+        resumo_alocado = novo;
+    }
+    protectFcnCall(resumotab_inserir(&resumo_tabela, &k, resumo_n), "resumotab_inserir falhou");
+    resumo_dados[resumo_n] = (resumo) {.chave = k, .encomendas = 0, .compras = 0, .artigos = 0, .total = 0};
+    return &resumo_dados[resumo_n++];
+}
+
+/**
+ * @brief       Soma (ou subtrai) uma encomenda aos resumos do seu cliente e
+ *              de todos os clientes, no mês da encomenda.
+ * @param e     Encomenda.
+ * @param total Preço da encomenda (ver encomenda_CalcPreco).
+ * @param sinal 1 para somar, -1 para subtrair.
+ */
+static void resumo_somar(const encomenda* const e, const int64_t total, const int64_t sinal) {
+    const compra* const compras  = compracol_data(&e->compras);
+    int64_t             artigos  = 0;
+    int64_t             semPreco = 0;
+    for (colSize_t i = 0; i < e->compras.size; i++) {
+        artigos += compras[i].qtd;
+        semPreco += !compra_temPreco(&compras[i]);
+    }
+    resumo_semPreco += (uint64_t) (sinal * semPreco);
+    const uint32_t     mes  = persistencia_mes(e->tempo);
+    const resumo_chave k[2] = {{.cliente = e->ID_cliente, .mes = mes}, {.cliente = RESUMO_TODOS, .mes = mes}};
+    for (int j = 0; j < 2; j++) {
+        resumo* const r = resumo_criar(k[j]);
+        r->encomendas += sinal;
+        r->compras += sinal * (int64_t) e->compras.size;
+        r->artigos += sinal * artigos;
+        r->total += sinal * total;
+    }
+}
+
+/**
+ * @brief    Acrescenta uma encomenda aos resumos, se estes forem válidos.
+ * @param e  Encomenda acabada de criar ou de editar.
+ * @param av Artigos.
+ */
+void resumo_acrescentar(const encomenda* const e, const artigocol* const av) {
+    if (resumo_validos) resumo_somar(e, (int64_t) encomenda_CalcPreco(e, av), 1);
+}
+
+/**
+ * @brief    Retira uma encomenda dos resumos, se estes forem válidos, antes de
+ *           esta ser editada ou removida.
+ * @param e  Encomenda tal como foi acrescentada.
+ * @param av Artigos.
+ */
+void resumo_retirar(const encomenda* const e, const artigocol* const av) {
+    if (resumo_validos) resumo_somar(e, (int64_t) encomenda_CalcPreco(e, av), -1);
+}
+
+/**
+ * @brief    Pode ser utilizado como um iterador, acrescenta uma encomenda aos
+ *           resumos mesmo que estes ainda não sejam válidos, para os
+ *           recalcular (ver resumo_validar).
+ * @param e  Encomenda.
+ * @param av Artigos.
+ * @returns  0
+ */
+int resumo_pred_acrescentar(encomenda* const e, const artigocol* const av) {
+    resumo_somar(e, (int64_t) encomenda_CalcPreco(e, av), 1);
+    return 0;
+}
+
+/**
+ * @brief    Acrescenta todas as encomendas de 'ev' aos resumos, mesmo que
+ *           estes ainda não sejam válidos, para os recalcular (ver
+ *           resumo_validar). Os preços das encomendas são calculados numa só
+ *           passagem, com encomenda_CalcPrecoBatch.
+ * @param ev Encomendas.
+ * @param av Artigos.
+ */
+void resumo_acrescentarColecao(const encomendacol* const ev, const artigocol* const av) {
+    if (!ev->size) return;
+    uint64_t* totais;
+    protectVarFcnCall(totais, malloc(sizeof(uint64_t) * ev->size), "alocação de memória recusada");
+    encomenda_CalcPrecoBatch(ev, av, totais);
+    COL_PARA_CADA(encomendacol, ev, e) resumo_somar(e, (int64_t) totais[e_i], 1);
+    free(totais);
+}
+
+/**
+ * @brief         Procura o resumo de um cliente num mês.
+ * @param cliente Handle do cliente, ou RESUMO_TODOS.
+ * @param mes     Mês (ver persistencia_mes).
+ * @returns       O resumo, válido até ser criado outro resumo.
+ * @returns       NULL se o cliente não tem encomendas nesse mês.
+ */
+const resumo* resumo_obter(const colSize_t cliente, const uint32_t mes) {
+    const resumo_chave k = {.cliente = cliente, .mes = mes};
+    const colSize_t    i = resumotab_obter(&resumo_tabela, &k);
+    return (i == COL_INVAL_INDEX) ? NULL : &resumo_dados[i];
+}
+
+/**
+ * @brief   Verifica se os resumos correspondem às encomendas.
+ * @returns 1 se são válidos, 0 se têm que ser recalculados.
+ */
+int resumo_valido() { return resumo_validos; }
+
+/**
+ * @brief Marca os resumos como válidos, depois de todas as encomendas terem
+ *        sido acrescentadas com resumo_pred_acrescentar.
+ */
+void resumo_validar() { resumo_validos = 1; }
+
+/**
+ * @brief Apaga os resumos, que ficam inválidos até serem recalculados.
+ */
+void resumo_invalidar() {
+    resumotab_limpar(&resumo_tabela);
+    resumo_n        = 0;
+    resumo_validos  = 0;
+    resumo_semPreco = 0;
+}
+
+/**
+ * @brief Deve ser chamada quando o preço, o IVA ou a existência de um artigo
+ *        muda. Os resumos que incluem compras sem o preço registado deixam de
+ *        estar de acordo com encomenda_CalcPreco e ficam inválidos.
+ */
+void resumo_mudouPreco() {
+    if (resumo_semPreco) resumo_invalidar();
+}
+
+/**
+ * @brief Liberta a memória dos resumos, que ficam inválidos.
+ */
+void resumo_libertar() {
+    resumotab_free(&resumo_tabela);
+    freeN(resumo_dados);
+    resumo_n        = 0;
+    resumo_alocado  = 0;
+    resumo_validos  = 0;
+    resumo_semPreco = 0;
+}
+
+/**
+ * @brief         Grava os resumos em 'caminho', substituindo o ficheiro só
+ *                depois de este estar completo.
+ * @param caminho Ficheiro de resumos.
+ * @param geracao Geração do ficheiro de dados a que os resumos correspondem.
+ * @returns       0 se falhou a gravar.
+ * @returns       1 caso contrário.
+ */
+int resumo_gravar(const char* const caminho, const uint64_t geracao) {
+    char* tmp;
+    protectVarFcnCall(tmp, malloc(strlen(caminho) + 5), "alocação de memória recusada");
+    strcpy(tmp, caminho);
+    strcat(tmp, ".tmp");
+
+    FILE* f = fopen(tmp, "wb");
+    if (!f) {
+        menu_printError("ao gravar - '%s' não pode ser aberto", tmp);
+        free(tmp);
+        return 0;
+    }
+    const resumo_cabecalho cab = {.magia    = RESUMO_MAGIA,
+                                  .versao   = RESUMO_VERSAO,
+                                  .endian   = RESUMO_ENDIAN,
+                                  .checksum = fnv1a(resumo_dados, sizeof(resumo) * resumo_n, FNV1A_INICIO),
+                                  .geracao  = geracao,
+                                  .n        = resumo_n,
+                                  .semPreco = resumo_semPreco};
+    int ok =
+        fwrite(&cab, sizeof(cab), 1, f) && (!resumo_n || fwrite(resumo_dados, sizeof(resumo), resumo_n, f) == resumo_n);
+    ok = ok && !fflush(f);
+#ifndef _WIN32
+    ok = ok && !fsync(fileno(f));
+#endif
+    ok = !fclose(f) && ok;
+#ifdef _WIN32
+    if (ok) remove(caminho);
+#endif
+    ok = ok && !rename(tmp, caminho);
+    if (!ok) remove(tmp);
+    free(tmp);
+    return ok;
+}
+
+/**
+ * @brief         Carrega os resumos de 'caminho', que ficam válidos se o
+ *                ficheiro for da geração 'geracao'.
+ * @param caminho Ficheiro de resumos.
+ * @param geracao Geração do ficheiro de dados carregado.
+ * @returns       0 se o ficheiro não existe, é de outra geração ou está
+ *                corrompido (os resumos ficam inválidos).
+ * @returns       1 caso contrário.
+ */
+int resumo_carregar(const char* const caminho, const uint64_t geracao) {
+    resumo_invalidar();
+    FILE* const f = fopen(caminho, "rb");
+    if (!f) return 0;
+    resumo_cabecalho cab;
+    int ok = fread(&cab, sizeof(cab), 1, f) && !memcmp(cab.magia, RESUMO_MAGIA, sizeof(cab.magia)) &&
+        cab.versao == RESUMO_VERSAO && cab.endian == RESUMO_ENDIAN && cab.geracao == geracao &&
+        cab.n < COL_INVAL_INDEX;
+    if (ok && cab.n > resumo_alocado) {
+        resumo* const dados = realloc(resumo_dados, sizeof(resumo) * cab.n);
+        ok                  = dados != NULL;
+        if (ok) {
+            resumo_dados   = dados;
+            resumo_alocado = cab.n;
+        }
+    }
+    ok = ok && (!cab.n || fread(resumo_dados, sizeof(resumo), cab.n, f) == cab.n) &&
+        fnv1a(resumo_dados, sizeof(resumo) * cab.n, FNV1A_INICIO) == cab.checksum &&
+        resumotab_reserve(&resumo_tabela, cab.n);
+    fclose(f);
+    for (size_t i = 0; ok && i < cab.n; i++) ok = resumotab_inserir(&resumo_tabela, &resumo_dados[i].chave, i);
+    if (!ok || resumo_tabela.size != cab.n) {
+        resumo_invalidar();
+        return 0;
+    }
+    resumo_n        = cab.n;
+    resumo_validos  = 1;
+    resumo_semPreco = cab.semPreco;
+    return 1;
+}
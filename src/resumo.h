@@ -0,0 +1,100 @@
+/**
+ * @file    resumo.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Resumos mensais: para cada cliente e cada mês, o número de
+ *          encomendas, de compras e de artigos vendidos e o total gasto, de
+ *          modo a que os totais de um recibo ou de uma listagem sejam lidos
+ *          sem percorrer as encomendas.
+ * @details Os resumos são mantidos à medida que as encomendas são criadas e
+ *          editadas (resumo_acrescentar e resumo_retirar), e incluem as
+ *          encomendas já arquivadas. Cada mês tem também um resumo de todos os
+ *          clientes, com o cliente RESUMO_TODOS.
+ *
+ *          São gravados num ficheiro ao lado do ficheiro de dados, com a
+ *          geração deste (resumo_gravar). Se o ficheiro não for da geração
+ *          carregada, ou se o diário alterou encomendas, os resumos ficam
+ *          inválidos até serem recalculados com resumo_pred_acrescentar.
+ *
+ *          As compras sem o preço de venda registado (ver compra_temPreco)
+ *          contam com o preço atual do artigo, tal como em
+ *          encomenda_CalcPreco. Enquanto os resumos incluírem compras dessas,
+ *          qualquer mudança aos artigos os torna inválidos (resumo_mudouPreco).
+ * @version 1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ */
+
+#ifndef RESUMO_H
+#define RESUMO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "encomenda.h"
+
+/**
+ * @def RESUMO_MAGIA
+ *          Primeiros 4 bytes do ficheiro de resumos.
+ * @def RESUMO_VERSAO
+ *          Versão do formato do ficheiro de resumos.
+ * @def RESUMO_ENDIAN
+ *          Escrito tal como está em memória, um ficheiro gravado numa máquina
+ *          com outra ordem de bytes é ignorado.
+ * @def RESUMO_TODOS
+ *          Cliente do resumo de todos os clientes de um mês.
+ */
+#define RESUMO_MAGIA "LP1R"
+#define RESUMO_VERSAO ((uint32_t) 2)
+#define RESUMO_ENDIAN ((uint32_t) 0x01020304)
+#define RESUMO_TODOS COL_INVAL_INDEX
+
+/**
+ * @brief   Chave de um resumo.
+ */
+typedef struct {
+    colSize_t cliente; ///< Handle do cliente, ou RESUMO_TODOS
+    uint32_t  mes;     ///< Mês (ver persistencia_mes)
+} resumo_chave;
+
+/**
+ * @brief   Totais das encomendas de um cliente num mês. A disposição em
+ *          memória é também a disposição em ficheiro.
+ */
+typedef struct {
+    resumo_chave chave;      ///< Cliente e mês
+    uint64_t     encomendas; ///< Número de encomendas
+    uint64_t     compras;    ///< Número de compras
+    uint64_t     artigos;    ///< Número de artigos vendidos
+    int64_t      total;      ///< Total gasto, em cêntimos
+} resumo;
+
+_Static_assert(sizeof(resumo) == 40, "resumo deve ter 40 bytes sem padding implícito");
+
+/**
+ * @brief   Cabeçalho do ficheiro de resumos, seguido de 'n' resumos.
+ */
+typedef struct {
+    char     magia[4]; ///< RESUMO_MAGIA
+    uint32_t versao;   ///< RESUMO_VERSAO
+    uint32_t endian;   ///< RESUMO_ENDIAN
+    uint32_t checksum; ///< fnv1a dos resumos
+    uint64_t geracao;  ///< Geração do ficheiro de dados a que os resumos correspondem
+    uint64_t n;        ///< Número de resumos
+    uint64_t semPreco; ///< Número de compras sem o preço registado incluídas nos resumos
+} resumo_cabecalho;
+
+void          resumo_acrescentar(const encomenda* const e, const artigocol* const av);
+void          resumo_retirar(const encomenda* const e, const artigocol* const av);
+int           resumo_pred_acrescentar(encomenda* const e, const artigocol* const av);
+void          resumo_acrescentarColecao(const encomendacol* const ev, const artigocol* const av);
+const resumo* resumo_obter(const colSize_t cliente, const uint32_t mes);
+int           resumo_valido();
+void          resumo_validar();
+void          resumo_invalidar();
+void          resumo_mudouPreco();
+void          resumo_libertar();
+int           resumo_gravar(const char* const caminho, const uint64_t geracao);
+int           resumo_carregar(const char* const caminho, const uint64_t geracao);
+
+#endif
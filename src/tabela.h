@@ -0,0 +1,284 @@
+/**
+ * @file    tabela.h
+ * @author  André Botelho (keyoted@gmail.com)
+ * @brief   Protótipo para uma tabela de dispersão (endereçamento aberto, com
+ *          sondagem linear) que associa chaves a indexes de uma coleção. Tal
+ *          como colecao.h, este ficheiro contém apenas um 'protótipo' que é
+ *          compilado para um objeto real quando os macros TAB_TIPO, TAB_NOME,
+ *          TAB_HASH(K) e TAB_IGUAL(A, B) são definidos antes de incluir o
+ *          ficheiro. A implementação e a declaração são ativadas pelos mesmos
+ *          macros que em colecao.h (COL_IMPLEMENTACAO e COL_DECLARACAO).
+ * @details Os hashes estão num array separado das entradas, por isso procurar
+ *          uma chave percorre apenas 4 bytes por cada posição e só compara a
+ *          chave (TAB_IGUAL) quando o hash é igual. As entradas removidas são
+ *          preenchidas puxando as entradas seguintes (sem lápides), por isso
+ *          a tabela não degrada com muitas remoções.
+ * @version 1
+ * @date    2026-10-17
+ *
+ * @copyright Copyright (c) 2020
+ * @section example_sec Exemplo
+ * @code{c}
+ * #ifndef  inttab_H
+ * #define  inttab_H
+ * #define  TAB_TIPO             int
+ * #define  TAB_NOME             inttab
+ * #define  TAB_HASH(K)          fnv1a(K, sizeof(int), FNV1A_INICIO)
+ * #define  TAB_IGUAL(A, B)      (*(A) == *(B))
+ * #include "tabela.h"
+ * #endif
+ * @endcode
+ */
+
+/**
+ * @def TAB_TIPO
+ *                  O tipo das chaves, que são copiadas para a tabela por
+ *                  atribuição.
+ * @def TAB_NOME
+ *                  Nome da nova struct, todas as funções têm este nome como
+ *                  prefixo.
+ * @def TAB_HASH(K)
+ *                  Hash de 32 bits da chave K, do tipo 'const TAB_TIPO*'.
+ * @def TAB_IGUAL(A, B)
+ *                  Verdade se as chaves A e B, do tipo 'const TAB_TIPO*', são
+ *                  iguais. Chaves iguais têm que ter o mesmo hash.
+ * @def TAB_FUN(X)
+ *                  Macro responsavél por adicionar TAB_NOME antes do nome de
+ *                  cada função como prefixo.
+ * @def TAB_VAZIO
+ *                  Hash guardado nas posições vazias, uma chave com este hash
+ *                  é guardada com o hash 1.
+ */
+
+#include "utilities.h"
+#ifndef COL_INVAL_INDEX
+#    define COL_PRE
+#    include "colecao.h"
+#endif
+
+#ifndef TAB_TIPO
+#    define TAB_TIPO int
+#endif
+#ifndef TAB_NOME
+#    define TAB_NOME inttab
+#endif
+#ifndef TAB_HASH
+#    define TAB_HASH(K) fnv1a(K, sizeof(TAB_TIPO), FNV1A_INICIO)
+#endif
+#ifndef TAB_IGUAL
+#    define TAB_IGUAL(A, B) (memcmp(A, B, sizeof(TAB_TIPO)) == 0)
+#endif
+
+#define TAB_FUN(X) COL_EVAL(TAB_NOME, X)
+#define TAB_VAZIO ((uint32_t) 0)
+
+#if !(defined(COL_IMPLEMENTACAO) || defined(COL_DECLARACAO))
+#    define COL_DECLARACAO
+#endif
+
+#if (defined(COL_IMPLEMENTACAO) || defined(COL_DECLARACAO))
+/**
+ * @brief           Uma chave e o index que lhe está associado.
+ */
+typedef struct {
+    TAB_TIPO  chave; ///< Chave
+    colSize_t valor; ///< Index associado à chave
+} TAB_FUN(_entrada);
+
+/**
+ * @struct          TAB_NOME
+ * @brief           Struct com o nome TAB_NOME que associa chaves do tipo
+ *                  TAB_TIPO a indexes. 'hashes' e 'entradas' têm 'capacidade'
+ *                  posições (0 ou uma potência de 2), uma posição está vazia se
+ *                  o seu hash for TAB_VAZIO.
+ */
+typedef struct {
+    colSize_t          capacidade; ///< Número de posições, 0 ou uma potência de 2.
+    colSize_t          size;       ///< Número de chaves na tabela.
+    uint32_t*          hashes;     ///< Hash da chave de cada posição.
+    TAB_FUN(_entrada)* entradas;   ///< Chave e index de cada posição.
+} TAB_NOME;
+#endif
+
+#ifdef COL_IMPLEMENTACAO
+/**
+ * @brief           Calcula o hash guardado para a chave 'k'.
+ * @param k         Chave.
+ * @returns         O hash, nunca TAB_VAZIO.
+ */
+static inline uint32_t TAB_FUN(_hash)(const TAB_TIPO* const k) {
+    const uint32_t h = TAB_HASH(k);
+    return (h == TAB_VAZIO) ? 1 : h;
+}
+
+/**
+ * @brief           Procura a posição da chave 'k'.
+ * @param t         Tabela, com 'capacidade' maior que 0.
+ * @param k         Chave.
+ * @param h         Hash de 'k' (ver _hash).
+ * @returns         A posição da chave, ou a posição vazia onde a sondagem
+ *                  parou se a chave não estiver na tabela.
+ */
+static colSize_t TAB_FUN(_posicao)(const TAB_NOME* const t, const TAB_TIPO* const k, const uint32_t h) {
+    const colSize_t mascara = t->capacidade - 1;
+    colSize_t       p       = h & mascara;
+    while (t->hashes[p] != TAB_VAZIO) {
+        if (t->hashes[p] == h && TAB_IGUAL(&t->entradas[p].chave, k)) return p;
+        p = (p + 1) & mascara;
+    }
+    return p;
+}
+
+/**
+ * @brief           Muda o número de posições da tabela, voltando a colocar
+ *                  todas as chaves.
+ * @param t         Tabela.
+ * @param capacidade
+ *                  Nova capacidade, uma potência de 2 maior que 'size'.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 se conseguiu.
+ */
+static int TAB_FUN(_redimensionar)(TAB_NOME* const t, const colSize_t capacidade) {
+    uint32_t* const          hashes   = calloc(capacidade, sizeof(uint32_t));
+    TAB_FUN(_entrada)* const entradas = malloc(sizeof(TAB_FUN(_entrada)) * capacidade);
+    if (hashes == NULL || entradas == NULL) {
+        free(hashes);
+        free(entradas);
+        return 0;
+    }
+    const TAB_NOME antiga = *t;
+    t->capacidade         = capacidade;
+    t->hashes             = hashes;
+    t->entradas           = entradas;
+    for (colSize_t i = 0; i < antiga.capacidade; ++i) {
+        if (antiga.hashes[i] == TAB_VAZIO) continue;
+        colSize_t p = antiga.hashes[i] & (capacidade - 1);
+        while (hashes[p] != TAB_VAZIO) p = (p + 1) & (capacidade - 1);
+        hashes[p]   = antiga.hashes[i];
+        entradas[p] = antiga.entradas[i];
+    }
+    free(antiga.hashes);
+    free(antiga.entradas);
+    return 1;
+}
+
+TAB_NOME TAB_FUN(_new)() { return (TAB_NOME) {.capacidade = 0, .size = 0}; }
+
+void TAB_FUN(_free)(TAB_NOME* const t) {
+    free(t->hashes);
+    free(t->entradas);
+    *t = TAB_FUN(_new)();
+}
+
+void TAB_FUN(_limpar)(TAB_NOME* const t) {
+    if (t->capacidade) memset(t->hashes, 0, sizeof(uint32_t) * t->capacidade);
+    t->size = 0;
+}
+
+int TAB_FUN(_reserve)(TAB_NOME* const t, const colSize_t n) {
+    // Manter a tabela no máximo 3/4 cheia
+    colSize_t capacidade = t->capacidade ? t->capacidade : 16;
+    while (capacidade - capacidade / 4 < n) {
+        if (capacidade > COL_INVAL_INDEX / 2) return 0;
+        capacidade *= 2;
+    }
+    return (capacidade == t->capacidade) || TAB_FUN(_redimensionar)(t, capacidade);
+}
+
+int TAB_FUN(_inserir)(TAB_NOME* const t, const TAB_TIPO* const k, const colSize_t valor) {
+    if (!TAB_FUN(_reserve)(t, t->size + 1)) return 0;
+    const uint32_t  h = TAB_FUN(_hash)(k);
+    const colSize_t p = TAB_FUN(_posicao)(t, k, h);
+    if (t->hashes[p] != TAB_VAZIO) return 1;
+    t->hashes[p]   = h;
+    t->entradas[p] = (TAB_FUN(_entrada)) {.chave = *k, .valor = valor};
+    t->size++;
+    return 1;
+}
+
+colSize_t TAB_FUN(_obter)(const TAB_NOME* const t, const TAB_TIPO* const k) {
+    if (t->size == 0) return COL_INVAL_INDEX;
+    const colSize_t p = TAB_FUN(_posicao)(t, k, TAB_FUN(_hash)(k));
+    return (t->hashes[p] == TAB_VAZIO) ? COL_INVAL_INDEX : t->entradas[p].valor;
+}
+
+int TAB_FUN(_remover)(TAB_NOME* const t, const TAB_TIPO* const k, const colSize_t valor) {
+    if (t->size == 0) return 0;
+    const colSize_t mascara = t->capacidade - 1;
+    colSize_t       p       = TAB_FUN(_posicao)(t, k, TAB_FUN(_hash)(k));
+    if (t->hashes[p] == TAB_VAZIO || t->entradas[p].valor != valor) return 0;
+
+    // Puxar para a posição libertada as entradas seguintes cuja posição ideal
+    // não está entre a posição libertada e a posição onde estão
+    for (colSize_t q = (p + 1) & mascara; t->hashes[q] != TAB_VAZIO; q = (q + 1) & mascara) {
+        const colSize_t ideal = t->hashes[q] & mascara;
+        if (((q - ideal) & mascara) >= ((q - p) & mascara)) {
+            t->hashes[p]   = t->hashes[q];
+            t->entradas[p] = t->entradas[q];
+            p              = q;
+        }
+    }
+    t->hashes[p] = TAB_VAZIO;
+    t->size--;
+    return 1;
+}
+#endif
+
+#ifdef COL_DECLARACAO
+/**
+ * @brief           Cria uma tabela vazia, que só aloca memória quando lhe é
+ *                  inserida a primeira chave.
+ * @returns         A tabela.
+ */
+TAB_NOME TAB_FUN(_new)();
+/**
+ * @brief           Liberta a memória da tabela, que fica vazia.
+ * @param t         Tabela.
+ */
+void TAB_FUN(_free)(TAB_NOME* const t);
+/**
+ * @brief           Remove todas as chaves sem libertar memória.
+ * @param t         Tabela.
+ */
+void TAB_FUN(_limpar)(TAB_NOME* const t);
+/**
+ * @brief           Garante que a tabela consegue guardar 'n' chaves sem voltar
+ *                  a alocar memória.
+ * @param t         Tabela.
+ * @param n         Número de chaves.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 se conseguiu.
+ */
+int TAB_FUN(_reserve)(TAB_NOME* const t, const colSize_t n);
+/**
+ * @brief           Associa a chave 'k' a 'valor', se a chave ainda não estiver
+ *                  na tabela (uma chave que já existe mantém o seu index).
+ * @param t         Tabela.
+ * @param k         Chave.
+ * @param valor     Index a associar à chave.
+ * @returns         0 se não conseguiu alocar memória.
+ * @returns         1 se conseguiu.
+ */
+int TAB_FUN(_inserir)(TAB_NOME* const t, const TAB_TIPO* const k, const colSize_t valor);
+/**
+ * @brief           Procura a chave 'k'.
+ * @param t         Tabela.
+ * @param k         Chave.
+ * @returns         O index associado à chave, ou COL_INVAL_INDEX se a chave
+ *                  não estiver na tabela.
+ */
+colSize_t TAB_FUN(_obter)(const TAB_NOME* const t, const TAB_TIPO* const k);
+/**
+ * @brief           Remove a chave 'k', se esta estiver associada a 'valor'.
+ * @param t         Tabela.
+ * @param k         Chave.
+ * @param valor     Index que a chave tem que ter para ser removida.
+ * @returns         1 se removeu a chave, 0 caso contrário.
+ */
+int TAB_FUN(_remover)(TAB_NOME* const t, const TAB_TIPO* const k, const colSize_t valor);
+#endif
+
+#undef TAB_TIPO
+#undef TAB_NOME
+#undef TAB_HASH
+#undef TAB_IGUAL
@@ -71,7 +71,24 @@ int load_str(FILE* const f, char** const data) {
         *data = NULL;
         return 1;
     }
-    protectVarFcnCall(*data, malloc(size), "load_str - alocação de memória recusada");
+    protectVarFcnCall(*data, malloc(size + 1), "load_str - alocação de memória recusada");
     written += fread(*data, sizeof(uint8_t), size, f);
+    (*data)[size] = '\0';
     return written == (size + 1);
-}
\ No newline at end of file
+}
+/**
+ * @brief       Calcula o hash FNV-1a de 32 bits de um bloco de memória.
+ * @param data  Bloco de memória.
+ * @param size  Tamanho do bloco.
+ * @param hash  FNV1A_INICIO, ou o resultado de uma chamada anterior para
+ *              continuar o hash de um bloco anterior.
+ * @returns     O hash do bloco.
+ */
+uint32_t fnv1a(const void* const data, const size_t size, uint32_t hash) {
+    const uint8_t* const bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
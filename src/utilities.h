@@ -21,6 +21,8 @@ int   pred_printItem(char** const item, int64_t* const userdata);
 int   save_str(FILE* const f, const char* const data);
 int   load_str(FILE* const f, char** const data);
 
+uint32_t fnv1a(const void* const data, const size_t size, uint32_t hash);
+
 /**
  * @def freeN(X)
  *          Liberta e anula X.
@@ -33,6 +35,8 @@ int   load_str(FILE* const f, char** const data);
  *          termina o programa.
  * @def protectFcnCall(FCN, ERRMSG)
  *          Se FCN() retornar falso, imprime o erro ERRMSG e termina o programa.
+ * @def FNV1A_INICIO
+ *          Valor inicial de 'hash' para fnv1a.
  */
 #define freeN(X)                                                                                                       \
     if (X) {                                                                                                           \
@@ -40,6 +44,7 @@ int   load_str(FILE* const f, char** const data);
         X = NULL;                                                                                                      \
     }
 #define protectStr(X) ((X) ? (X) : ("N/A"))
+#define FNV1A_INICIO ((uint32_t) 2166136261u)
 
 #define MACRO_QUOTE(X) __MACRO_QUOTE_INTERNAL(X)
 #define __MACRO_QUOTE_INTERNAL(X) #X
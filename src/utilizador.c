@@ -11,6 +11,7 @@
 #include "utilizador.h"
 
 #include "menu.h"
+#include "persistencia.h"
 #include "utilities.h"
 
 /**
@@ -44,7 +45,7 @@ int utilizador_eCCValido(const char* const cc) {
  */
 utilizador newUtilizador() {
     return (utilizador) {
-        .nome = strdup("Nome do cliente"),                                   //
+        .nome = nomes_inserir("Nome do cliente"),                            //
         .NIF  = {'0', '0', '0', '0', '0', '0', '0', '0', '0'},               //
         .CC   = {'0', '0', '0', '0', '0', '0', '0', '0', '0', 'X', 'Y', '0'} //
     };
@@ -54,7 +55,7 @@ utilizador newUtilizador() {
  * @brief   Responsavél por libertar a memória utilizada por um utilizador.
  * @param u O utilizador por libertar.
  */
-void freeUtilizador(utilizador* const u) { freeN(u->nome); }
+void freeUtilizador(utilizador* const u) { u->nome = NOMES_NENHUM; }
 
 /**
  * @brief       Responsável por salvar um utilizador num ficheiro.
@@ -65,8 +66,8 @@ void freeUtilizador(utilizador* const u) { freeN(u->nome); }
  */
 int save_utilizador(FILE* const f, const utilizador* const data) {
     int written = 0;
-    written += save_str(f, data->nome);
-    if (!data->nome) { menu_printInfo("ao gravar utilizador - nome inválido"); }
+    written += save_str(f, nomes_str(data->nome));
+    if (!nomes_str(data->nome)) { menu_printInfo("ao gravar utilizador - nome inválido"); }
     written += fwrite(&data->NIF, sizeof(uint8_t), 9, f);
     written += fwrite(&data->CC, sizeof(uint8_t), 12, f);
     return written == (1 + 9 + 12);
@@ -80,9 +81,12 @@ int save_utilizador(FILE* const f, const utilizador* const data) {
  * @returns     1 se carregou o utilizador com sucesso.
  */
 int load_utilizador(FILE* const f, utilizador* const data) {
-    int written = 0;
-    written += load_str(f, &data->nome);
-    if (!data->nome) { menu_printInfo("ao carregar utilizador - nome inválido"); }
+    int   written = 0;
+    char* nome;
+    written += load_str(f, &nome);
+    data->nome = nomes_inserir(nome);
+    free(nome);
+    if (data->nome == NOMES_NENHUM) { menu_printInfo("ao carregar utilizador - nome inválido"); }
     written += fread(&data->NIF, sizeof(uint8_t), 9, f);
     written += fread(&data->CC, sizeof(uint8_t), 12, f);
     return written == (1 + 9 + 12);
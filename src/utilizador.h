@@ -15,15 +15,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "nomes.h"
+
 /**
  * @brief   Capaz de gravar todas as informações sobre um utilizador.
  */
 typedef struct {
-    char* nome;   ///< Nome do cliente.
-    char  NIF[9]; ///< NIF do cliente.
-    char  CC[12]; ///< Número de cartão de cidadão do cliente.
+    nomes_id nome;   ///< Nome do cliente (ver nomes.h).
+    char     NIF[9]; ///< NIF do cliente.
+    char     CC[12]; ///< Número de cartão de cidadão do cliente.
 } utilizador;
 
+/**
+ * @brief   Chave para procurar um cliente pelo NIF (ver tabela.h).
+ */
+typedef struct {
+    char NIF[9]; ///< NIF do cliente.
+} utilizador_chaveNIF;
+
+/**
+ * @brief   Chave para procurar um cliente pelo número de cartão de cidadão
+ *          (ver tabela.h).
+ */
+typedef struct {
+    char CC[12]; ///< Número de cartão de cidadão do cliente.
+} utilizador_chaveCC;
+
 int        utilizador_eCCValido(const char* const CC);
 utilizador newUtilizador();
 void       freeUtilizador(utilizador* const u);